@@ -0,0 +1,307 @@
+#include "ActionBytecode.h"
+#include "HidReport.h"
+#include "ConfigLoad.h"
+#include "System.h"
+#include "Trace.h"
+namespace FreeTouchDeck
+{
+    static const char *module = "ActionBytecode";
+    // largest number of keys of a single instruction
+    #define ACTION_OP_MAX_KEYS 255
+
+    const char *enum_to_string(ActionOp op)
+    {
+        switch (op)
+        {
+            ENUM_TO_STRING_HELPER(ActionOp, END);
+            ENUM_TO_STRING_HELPER(ActionOp, TYPE);
+            ENUM_TO_STRING_HELPER(ActionOp, KEYS);
+            ENUM_TO_STRING_HELPER(ActionOp, PRESS);
+            ENUM_TO_STRING_HELPER(ActionOp, MEDIA);
+            ENUM_TO_STRING_HELPER(ActionOp, CALL);
+        default:
+            return "Unknown";
+        }
+    }
+    static inline void AddWord(std::vector<uint8_t> &code, uint16_t value)
+    {
+        code.push_back(value & 0xFF);
+        code.push_back(value >> 8);
+    }
+    static inline uint16_t GetWord(const uint8_t *p)
+    {
+        return p[0] | (p[1] << 8);
+    }
+    static inline uint16_t GetDelay(const uint8_t *op)
+    {
+        uint16_t keyDelay = GetWord(op + 1);
+        return keyDelay == ACTION_OP_DEFAULT_DELAY ? generalconfig.keyDelay : keyDelay;
+    }
+    void CompileKeyboardAction(FTAction *action, std::vector<uint8_t> &code)
+    {
+        uint16_t keyDelay = action->KeyDelay >= 0 ? min(action->KeyDelay, (int32_t)ACTION_OP_DEFAULT_DELAY - 1) : ACTION_OP_DEFAULT_DELAY;
+        if (action->NeedsDoubleBytes)
+        {
+            code.push_back((uint8_t)ActionOp::MEDIA);
+            AddWord(code, keyDelay);
+            code.push_back(action->NeedsRelease);
+            code.push_back(action->Values.size() > 0 ? action->Values[0] : 0);
+            code.push_back(action->Values.size() > 1 ? action->Values[1] : 0);
+            return;
+        }
+        ActionOp op = ActionOp::KEYS;
+        if (action->NeedsRelease)
+        {
+            op = ActionOp::PRESS;
+        }
+        else if (action->Batched && action->HoldTime == 0)
+        {
+            op = ActionOp::TYPE;
+        }
+        // long texts are split in several instructions
+        for (size_t start = 0; start < action->Values.size(); start += ACTION_OP_MAX_KEYS)
+        {
+            size_t count = min(action->Values.size() - start, (size_t)ACTION_OP_MAX_KEYS);
+            code.push_back((uint8_t)op);
+            AddWord(code, keyDelay);
+            if (op == ActionOp::KEYS)
+            {
+                AddWord(code, action->HoldTime);
+            }
+            code.push_back(count);
+            code.insert(code.end(), action->Values.begin() + start, action->Values.begin() + start + count);
+        }
+    }
+    size_t ActionOpSize(const uint8_t *op)
+    {
+        switch ((ActionOp)op[0])
+        {
+        case ActionOp::TYPE:
+        case ActionOp::PRESS:
+            return 4 + op[3];
+        case ActionOp::KEYS:
+            return 6 + op[5];
+        case ActionOp::MEDIA:
+            return 6;
+        case ActionOp::CALL:
+            return 2;
+        default:
+            return 1;
+        }
+    }
+    // Keys pressed by PRESS instructions stay down until a later instruction
+    // releases them, or until the sequence that pressed them is cancelled
+    static bool KeysHeld = false;
+    static CancelToken_t HeldBy;
+    // Waits for the previous report to leave, at most one report is sent per connection interval
+    static void PaceReport()
+    {
+        static uint32_t lastReport = 0;
+        uint32_t elapsed = millis() - lastReport;
+        if (elapsed < HID_REPORT_INTERVAL_MS)
+        {
+            delay(HID_REPORT_INTERVAL_MS - elapsed);
+        }
+        lastReport = millis();
+    }
+    static bool ShouldStop(const CancelToken_t &token)
+    {
+#ifndef ACTIONS_IN_TASKS
+        // keys are sent from the loop reading the touch screen, which can't report a touch meanwhile
+        if (isTouched())
+        {
+            CancelLane(ActionLane::HID);
+        }
+#endif
+        return IsCancelled(token);
+    }
+    void ReleaseCancelledKeys()
+    {
+        if (KeysHeld && IsCancelled(HeldBy))
+        {
+            LOC_LOGI(module, "Releasing keys held by a cancelled sequence");
+            bleKeyboard.releaseAll();
+            KeysHeld = false;
+        }
+    }
+    static bool TypeKeys(const uint8_t *op, uint16_t keyDelay, const CancelToken_t &token)
+    {
+        const uint8_t *keys = op + 4;
+        size_t count = op[3];
+        KeyReport report;
+        KeyReport previous;
+        KeyReport released;
+        size_t pos = 0;
+        memset(&previous, 0x00, sizeof(previous));
+        memset(&released, 0x00, sizeof(released));
+        while (pos < count)
+        {
+            pos += PackKeys(keys, count, pos, report, HID_KEYS_PER_REPORT);
+            if (report.keys[0] == 0 && report.modifiers == 0)
+            {
+                continue;
+            }
+            if (report.modifiers != released.modifiers)
+            {
+                // the host needs to see the new modifiers before the keys
+                released.modifiers = report.modifiers;
+                PaceReport();
+                TRACE_REPORT(op, bleKeyboard.sendReport(&released));
+                delay(keyDelay);
+            }
+            else if (SharesKeys(report, previous))
+            {
+                // give the host time to see the key released before it's pressed again
+                delay(keyDelay);
+            }
+            PaceReport();
+            TRACE_REPORT(op, bleKeyboard.sendReport(&report));
+            PaceReport();
+            TRACE_REPORT(op, bleKeyboard.sendReport(&released));
+            previous = report;
+            if (ShouldStop(token))
+            {
+                TRACE_REPORT(op, bleKeyboard.releaseAll());
+                KeysHeld = false;
+                return false;
+            }
+        }
+        if (released.modifiers != 0)
+        {
+            released.modifiers = 0;
+            PaceReport();
+            TRACE_REPORT(op, bleKeyboard.sendReport(&released));
+        }
+        return true;
+    }
+    bool RunKeyboardOp(const uint8_t *op, const CancelToken_t &token)
+    {
+        MediaKeyReport MediaKey;
+        uint16_t keyDelay = 0;
+        if (!IsKeyboardOp(op))
+        {
+            return true;
+        }
+        if (ShouldStop(token))
+        {
+            ReleaseCancelledKeys();
+            return false;
+        }
+        if (!bleKeyboard.isConnected())
+        {
+            LOC_LOGW(module, "Skipping %s instruction. Bluetooth Keyboard not connected", enum_to_string((ActionOp)op[0]));
+            return true;
+        }
+        keyDelay = GetDelay(op);
+        switch ((ActionOp)op[0])
+        {
+        case ActionOp::TYPE:
+            return TypeKeys(op, keyDelay, token);
+        case ActionOp::PRESS:
+            for (uint8_t i = 0; i < op[3]; i++)
+            {
+                // Use keyboard press for each character
+                // as this method does not release each key
+                // individually
+                TRACE_REPORT(op, bleKeyboard.press(op[4 + i]));
+                KeysHeld = true;
+                HeldBy = token;
+                delay(keyDelay);
+                if (ShouldStop(token))
+                {
+                    LOC_LOGI(module, "Releasing all keys");
+                    TRACE_REPORT(op, bleKeyboard.releaseAll());
+                    KeysHeld = false;
+                    return false;
+                }
+            }
+            break;
+        case ActionOp::KEYS:
+        {
+            uint16_t holdTime = GetWord(op + 3);
+            if (holdTime > 0)
+            {
+                LOC_LOGI(module, "Pressing keys with hold of %d ms", holdTime);
+            }
+            for (uint8_t i = 0; i < op[5]; i++)
+            {
+                TRACE_REPORT(op, bleKeyboard.press(op[6 + i]));
+                delay(holdTime);
+                TRACE_REPORT(op, bleKeyboard.release(op[6 + i]));
+                delay(keyDelay);
+                if (ShouldStop(token))
+                {
+                    ReleaseCancelledKeys();
+                    return false;
+                }
+            }
+        }
+        break;
+        case ActionOp::MEDIA:
+            MediaKey[0] = op[4];
+            MediaKey[1] = op[5];
+            if (op[3])
+            {
+                TRACE_REPORT(op, bleKeyboard.press(MediaKey));
+                KeysHeld = true;
+                HeldBy = token;
+            }
+            else
+            {
+                TRACE_REPORT(op, bleKeyboard.write(MediaKey));
+            }
+            delay(keyDelay);
+            break;
+        default:
+            break;
+        }
+        return true;
+    }
+    static void FormatKeys(const uint8_t *keys, uint8_t count, char *buffer, size_t size)
+    {
+        size_t len = 0;
+        for (uint8_t i = 0; i < count && len + 5 < size; i++)
+        {
+            if (keys[i] >= 0x20 && keys[i] < 0x7F)
+            {
+                buffer[len++] = keys[i];
+            }
+            else
+            {
+                len += snprintf(buffer + len, size - len, "\\x%02X", keys[i]);
+            }
+        }
+        buffer[min(len, size - 1)] = '\0';
+    }
+    void DisassembleOp(const uint8_t *op, char *buffer, size_t size)
+    {
+        char keys[61] = {0};
+        const char *name = enum_to_string((ActionOp)op[0]);
+        char delayText[11] = "default";
+        if (IsKeyboardOp(op) && GetWord(op + 1) != ACTION_OP_DEFAULT_DELAY)
+        {
+            snprintf(delayText, sizeof(delayText), "%dms", GetWord(op + 1));
+        }
+        switch ((ActionOp)op[0])
+        {
+        case ActionOp::TYPE:
+        case ActionOp::PRESS:
+            FormatKeys(op + 4, op[3], keys, sizeof(keys));
+            snprintf(buffer, size, "%-6s delay=%s count=%d \"%s\"", name, delayText, op[3], keys);
+            break;
+        case ActionOp::KEYS:
+            FormatKeys(op + 6, op[5], keys, sizeof(keys));
+            snprintf(buffer, size, "%-6s delay=%s hold=%dms count=%d \"%s\"", name, delayText, GetWord(op + 3), op[5], keys);
+            break;
+        case ActionOp::MEDIA:
+            snprintf(buffer, size, "%-6s delay=%s hold=%d key=%02X%02X", name, delayText, op[3], op[4], op[5]);
+            break;
+        case ActionOp::CALL:
+            snprintf(buffer, size, "%-6s #%d", name, op[1]);
+            break;
+        default:
+            snprintf(buffer, size, "%s", name);
+            break;
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "globals.hpp"
+#include "FTAction.h"
+namespace FreeTouchDeck
+{
+    // Instructions of compiled action sequences. Keyboard instructions
+    // start with the delay between keys, in ms, on 2 bytes.
+    //   END
+    //   TYPE   delay, count, characters[count]   typed with packed reports
+    //   KEYS   delay, hold[2], count, keys[count] each key pressed for hold ms
+    //   PRESS  delay, count, keys[count]          keys held until released by a later action
+    //   MEDIA  delay, hold, key[2]                media key, kept pressed when hold is set
+    //   CALL   index                              local action, from the sequence actions
+    enum class ActionOp : uint8_t
+    {
+        END = 0,
+        TYPE,
+        KEYS,
+        PRESS,
+        MEDIA,
+        CALL
+    };
+    const char *enum_to_string(ActionOp op);
+    // Delay value of keyboard instructions using generalconfig.keyDelay
+    #define ACTION_OP_DEFAULT_DELAY 0xFFFF
+
+    /**
+* @brief Appends the instructions running a keyboard action.
+*
+* @param action FTAction * keyboard action
+* @param code std::vector<uint8_t> & receives the instructions
+*/
+    void CompileKeyboardAction(FTAction *action, std::vector<uint8_t> &code);
+    // Size in bytes of the instruction at op, including its operands
+    size_t ActionOpSize(const uint8_t *op);
+    inline bool IsKeyboardOp(const uint8_t *op)
+    {
+        return op[0] >= (uint8_t)ActionOp::TYPE && op[0] <= (uint8_t)ActionOp::MEDIA;
+    }
+    /**
+* @brief Sends the keys of a keyboard instruction.
+*
+* @param op const uint8_t * instruction to run
+* @param token const CancelToken_t & token of the sequence the instruction is part of
+*
+* @return bool false when the sequence was cancelled, keys it held are then released
+*/
+    bool RunKeyboardOp(const uint8_t *op, const CancelToken_t &token);
+    // Releases the keys held by PRESS instructions of a cancelled sequence
+    void ReleaseCancelledKeys();
+    // Formats the instruction at op in a readable form
+    void DisassembleOp(const uint8_t *op, char *buffer, size_t size);
+}
@@ -1,9 +1,10 @@
 #include "ActionsSequence.h"
 namespace FreeTouchDeck
 {
+    static const char *module = "ActionsSequence";
     bool ActionsSequences::HasKeyboardAction()
     {
-        return HasAction(ActionTypes::KEYBOARD);
+        return HasKeys || HasAction(ActionTypes::KEYBOARD);
     }
     bool ActionsSequences::HasMenuAction()
     {
@@ -22,12 +23,113 @@ namespace FreeTouchDeck
     }
     bool ActionsSequences::Execute()
     {
-        for (FTAction * action : Actions)
+        bool result = true;
+        if (!Code)
+        {
+            LOC_LOGW(module, "Action sequence %s was not compiled", STRING_OR_DEFAULT(ConfigSequence, ""));
+            return false;
+        }
+        if (HasMenuAction())
+        {
+            // changing menu preempts the keys other sequences are still sending
+            CancelLane(ActionLane::HID);
+        }
+        // one token for the whole sequence, a cancel drops all of its keyboard
+        // instructions, even one arriving while they are queued
+        CancelToken_t token = GetCancelToken(ActionLane::HID);
+        for (const uint8_t *op = Code; *op != (uint8_t)ActionOp::END; op += ActionOpSize(op))
+        {
+            if ((ActionOp)*op == ActionOp::CALL)
+            {
+                FTAction *action = Actions[op[1]];
+                LOC_LOGD(module, "Queuing action %s", action->toString());
+                if (!QueueAction(action, &token))
+                {
+                    LOC_LOGW(module, "Button action %s could not be queued for execution.", action->toString());
+                    result = false;
+                }
+            }
+            else if (!QueueKeyboardOp(op, token))
+            {
+                LOC_LOGW(module, "Keyboard instruction %s could not be queued for execution.", enum_to_string((ActionOp)*op));
+                result = false;
+            }
+        }
+        return result;
+    }
+    bool ActionsSequences::Compile()
+    {
+        std::vector<uint8_t> code;
+        std::vector<FTAction *> calls;
+        for (FTAction *action : Actions)
+        {
+            if (action->Type == ActionTypes::KEYBOARD)
+            {
+                CompileKeyboardAction(action, code);
+                HasKeys = true;
+                delete (action);
+            }
+            else if (calls.size() > UINT8_MAX)
+            {
+                LOC_LOGE(module, "Too many local actions in sequence %s. Dropping %s", STRING_OR_DEFAULT(ConfigSequence, ""), action->toString());
+            }
+            else
+            {
+                code.push_back((uint8_t)ActionOp::CALL);
+                code.push_back(calls.size());
+                calls.push_back(action);
+            }
+        }
+        code.push_back((uint8_t)ActionOp::END);
+        Actions = calls;
+        // Like the actions it replaces, the code lives as long as the menus
+        uint8_t *compiled = (uint8_t *)malloc_fn(code.size());
+        if (!compiled)
         {
-            LOC_LOGD(module, "Queuing action %s", action->toString());
-            if (!QueueAction(action))
+            LOC_LOGE(module, "Unable to allocate %d bytes for action sequence %s", code.size(), STRING_OR_DEFAULT(ConfigSequence, ""));
+            return false;
+        }
+        memcpy(compiled, code.data(), code.size());
+        Code = compiled;
+        CodeSize = code.size();
+        LOC_LOGD(module, "Compiled action sequence to %d bytes, with %d local actions", CodeSize, Actions.size());
+        return true;
+    }
+    bool ActionsSequences::Load(const char *configSequence, const uint8_t *code, size_t codeSize, const std::vector<FTAction *> &actions)
+    {
+        ConfigSequence = configSequence;
+        Code = code;
+        CodeSize = codeSize;
+        Actions = actions;
+        for (const uint8_t *op = Code; *op != (uint8_t)ActionOp::END; op += ActionOpSize(op))
+        {
+            HasKeys = HasKeys || IsKeyboardOp(op);
+        }
+        LOC_LOGD(module, "Loaded compiled action sequence of %d bytes, with %d local actions", CodeSize, Actions.size());
+        return true;
+    }
+    void ActionsSequences::Disassemble()
+    {
+        char buffer[121] = {0};
+        if (!Code)
+        {
+            LOC_LOGI(module, "    (not compiled)");
+            return;
+        }
+        for (const uint8_t *op = Code;; op += ActionOpSize(op))
+        {
+            DisassembleOp(op, buffer, sizeof(buffer));
+            if ((ActionOp)*op == ActionOp::CALL)
             {
-                LOC_LOGW(module, "Button action %s could not be queued for execution.", action->toString());
+                LOC_LOGI(module, "    %04X %s %s", op - Code, buffer, Actions[op[1]]->toString());
+            }
+            else
+            {
+                LOC_LOGI(module, "    %04X %s", op - Code, buffer);
+            }
+            if ((ActionOp)*op == ActionOp::END)
+            {
+                break;
             }
         }
     }
@@ -50,6 +152,7 @@ namespace FreeTouchDeck
         FTAction *releaseAction = NULL;
         ParametersList_t releaseParameters;
         bool success = true;
+        int32_t keyDelay = -1;
 
         LOC_LOGD(module, "Parsing free form text %s", ConfigSequence);
         do
@@ -67,6 +170,8 @@ namespace FreeTouchDeck
                     char *buf = (char *)malloc_fn(values.size() + 1);
                     memcpy(buf, values.data(), values.size());
                     Actions.push_back(new FTAction(buf, values));
+                    // keys held by an earlier token are only known to the keyboard library
+                    Actions.back()->Batched = releaseKeyList.empty();
                     LOC_LOGD(module, "Character Sequence found with len %d: %s", values.size(), STRING_OR_DEFAULT(buf, ""));
                     FREE_AND_NULL(buf);
                     values.clear();
@@ -80,7 +185,15 @@ namespace FreeTouchDeck
                 strncpy(token, tokenStart + 1, len);
 
                 LOC_LOGD(module, "Found token %s", token);
-                if (!FTAction::ParseToken(token, Actions))
+                ParameterSlice_t name;
+                ParameterSlice_t value;
+                const char *next = FTAction::NextParameter(token, name);
+                if (next && name.Length == strlen("KEYDELAY") && strncmp(name.Start, "KEYDELAY", name.Length) == 0 && FTAction::NextParameter(next, value))
+                {
+                    keyDelay = atol(value.Start);
+                    LOC_LOGD(module, "Sequence key delay set to %d ms", keyDelay);
+                }
+                else if (!FTAction::ParseToken(token, Actions))
                 {
                     LOC_LOGE(module, "Invalid token %s found", token);
                     success = false;
@@ -110,8 +223,18 @@ namespace FreeTouchDeck
         {
             Actions.push_back(new FTAction("Release Keys", releaseKeyList));
         }
+        if (keyDelay >= 0)
+        {
+            for (FTAction *action : Actions)
+            {
+                if (action->Type == ActionTypes::KEYBOARD)
+                {
+                    action->KeyDelay = keyDelay;
+                }
+            }
+        }
 
-        return success;
+        return Compile() && success;
     }
     bool ActionsSequences::Parse(cJSON *actionJson)
     {
@@ -1,21 +1,32 @@
 #pragma once
 
 #include "FTAction.h"
+#include "ActionBytecode.h"
 namespace FreeTouchDeck {
 
 class ActionsSequences
 {
     public:
-    char *ConfigSequence;
+    const char *ConfigSequence = NULL;
    // bool NeedsReleaseAll;
+    // local actions, called by the CALL instructions of Code
     std::vector<FTAction *> Actions;
+    // compiled sequence, terminated by END. Shared by the copies of the sequence
+    const uint8_t *Code = NULL;
+    size_t CodeSize = 0;
     bool Execute();
+    bool Compile();
+    void Disassemble();
     bool HasKeyboardAction();
     bool HasMenuAction();
     bool Parse(cJSON * actionJson);
     bool Parse(const char * actionString);
+    // Uses a text and code compiled ahead of time, which aren't copied and must outlive the sequence
+    bool Load(const char *configSequence, const uint8_t *code, size_t codeSize, const std::vector<FTAction *> &actions);
     bool HasAction(ActionTypes actionType, const char * name = NULL);
     ActionsSequences();
+private:
+    bool HasKeys = false;
 };
 
 typedef std::vector<ActionsSequences > ActionSequencesList;
@@ -0,0 +1,699 @@
+#include "CompiledMenus.h"
+#include "ActionBytecode.h"
+#include "Storage.h"
+#include "ConfigStore.h"
+#include "System.h"
+#include <map>
+#include "esp_partition.h"
+namespace FreeTouchDeck
+{
+    static const char *module = "CompiledMenus";
+#define COMPILED_MENUS_MAGIC 0x43445446 // "FTDC"
+#define COMPILED_MENUS_VERSION 2
+// three strings, the type, sizes and text size, then three colors
+#define COMPILED_MENU_HEAD_SIZE 22
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+    // The image is the header, the offsets of the menus, the menus, then the table of the
+    // strings they reference. A menu is its head with its strings, type, sizes and colors,
+    // which is all that is read at boot, then its sequences and its buttons,
+    // a button is its strings, type, colors and repeat settings then its sequences,
+    // and a sequence is its text, its code, then the parameters of its local actions.
+    typedef struct
+    {
+        uint32_t Magic;
+        uint16_t Version;
+        uint16_t MenusCount;
+        // size of the image, header included
+        uint32_t Size;
+        // the partition holds two images, the valid one with the highest generation is loaded
+        uint32_t Generation;
+        // hash of the image after the header
+        uint32_t ImageHash;
+        // hashes of the files the menus were built from
+        uint32_t MenusHash;
+        uint32_t GeneralHash;
+        uint32_t StringsOffset;
+        uint32_t StringsSize;
+    } CompiledHeader_t;
+    static_assert(sizeof(CompiledHeader_t) == 36, "Unexpected padding in the compiled menus header");
+
+    // The defaults of general.json are resolved in the menus, so the image
+    // is only valid for the general.json the menus in memory were built with
+    static uint32_t BuiltGeneralHash = FNV_OFFSET_BASIS;
+#ifdef COMPILED_MENUS_PARTITION
+    // slot holding the image the menus were loaded from, which stays mapped
+    static int LoadedSlot = -1;
+#endif
+    // image the menus are loaded from, when they are shown
+    static const uint8_t *Image = NULL;
+    static CompiledHeader_t ImageHeader;
+    // Local actions of the image, by the bytes of their parameters. Since the strings
+    // are interned, reloading a menu reuses its actions, which can stay queued.
+    static std::map<std::string, FTAction *> LocalActions;
+
+    static uint32_t Hash(const uint8_t *data, size_t size, uint32_t hash = FNV_OFFSET_BASIS)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ data[i]) * FNV_PRIME;
+        }
+        return hash;
+    }
+    // Hashes the content of a file, a missing file hashes like an empty one
+    static uint32_t HashFile(const char *fileName)
+    {
+        uint8_t chunk[MENU_LOAD_CHUNK_SIZE];
+        uint32_t hash = FNV_OFFSET_BASIS;
+        if (!ftdfs->exists(fileName))
+        {
+            return hash;
+        }
+        File file = ftdfs->open(fileName, FILE_READ);
+        size_t len = 0;
+        while (file && (len = file.read(chunk, sizeof(chunk))) > 0)
+        {
+            hash = Hash(chunk, len, hash);
+        }
+        file.close();
+        return hash;
+    }
+
+    class ImageWriter
+    {
+    public:
+        std::vector<uint8_t> Data;
+        std::vector<uint8_t> Strings;
+        bool Failed = false;
+        ImageWriter()
+        {
+            Data.resize(sizeof(CompiledHeader_t));
+            String("");
+        }
+        inline void Byte(uint8_t value)
+        {
+            Data.push_back(value);
+        }
+        inline void Count(size_t value)
+        {
+            Failed = Failed || value > UINT8_MAX;
+            Byte(value);
+        }
+        inline void Word(uint16_t value)
+        {
+            Data.push_back(value & 0xFF);
+            Data.push_back(value >> 8);
+        }
+        inline void Long(uint32_t value)
+        {
+            Word(value & 0xFFFF);
+            Word(value >> 16);
+        }
+        // Strings are stored once, and referenced by their offset in the table
+        void String(const std::string &value)
+        {
+            auto interned = Interned.find(value);
+            if (interned != Interned.end())
+            {
+                Word(interned->second);
+                return;
+            }
+            if (Strings.size() + value.size() + 1 > UINT16_MAX)
+            {
+                Failed = true;
+                Word(0);
+                return;
+            }
+            uint16_t offset = Strings.size();
+            Strings.insert(Strings.end(), value.begin(), value.end());
+            Strings.push_back('\0');
+            Interned[value] = offset;
+            Word(offset);
+        }
+
+    private:
+        std::map<std::string, uint16_t> Interned;
+    };
+
+    class ImageReader
+    {
+    public:
+        const uint8_t *Pos;
+        const uint8_t *End;
+        const char *Strings;
+        size_t StringsSize;
+        bool Failed = false;
+        ImageReader(const uint8_t *image, const CompiledHeader_t &header, uint32_t offset)
+        {
+            Pos = image + offset;
+            End = image + header.StringsOffset;
+            Strings = (const char *)End;
+            StringsSize = header.StringsSize;
+            Failed = offset < sizeof(CompiledHeader_t) || Pos > End;
+        }
+        inline uint8_t Byte()
+        {
+            if (Pos >= End)
+            {
+                Failed = true;
+                return 0;
+            }
+            return *Pos++;
+        }
+        inline uint16_t Word()
+        {
+            uint16_t low = Byte();
+            return low | (Byte() << 8);
+        }
+        inline uint32_t Long()
+        {
+            uint32_t low = Word();
+            return low | ((uint32_t)Word() << 16);
+        }
+        const uint8_t *Bytes(size_t size)
+        {
+            if (size > (size_t)(End - Pos))
+            {
+                Failed = true;
+                return NULL;
+            }
+            const uint8_t *bytes = Pos;
+            Pos += size;
+            return bytes;
+        }
+        const char *String()
+        {
+            uint16_t offset = Word();
+            if (offset >= StringsSize)
+            {
+                Failed = true;
+                return "";
+            }
+            return Strings + offset;
+        }
+    };
+
+    static void WriteSequences(ImageWriter &writer, const ActionSequencesList &sequences)
+    {
+        writer.Count(sequences.size());
+        for (const ActionsSequences &sequence : sequences)
+        {
+            writer.String(STRING_OR_DEFAULT(sequence.ConfigSequence, ""));
+            writer.Failed = writer.Failed || !sequence.Code || sequence.CodeSize > UINT16_MAX;
+            if (writer.Failed)
+            {
+                return;
+            }
+            writer.Word(sequence.CodeSize);
+            writer.Data.insert(writer.Data.end(), sequence.Code, sequence.Code + sequence.CodeSize);
+            writer.Count(sequence.Actions.size());
+            for (FTAction *action : sequence.Actions)
+            {
+                writer.Count(action->Parameters.size());
+                for (const std::string &parameter : action->Parameters)
+                {
+                    writer.String(parameter);
+                }
+            }
+        }
+    }
+    static void WriteMenu(ImageWriter &writer, Menu *menu)
+    {
+        writer.String(menu->Name);
+        writer.String(menu->Label);
+        writer.String(menu->Icon);
+        writer.Byte((uint8_t)menu->Type);
+        writer.Byte(menu->RowsCount);
+        writer.Byte(menu->ColsCount);
+        writer.Byte(menu->GetTextSize());
+        writer.Long(menu->BackgroundColor);
+        writer.Long(menu->GetOutline());
+        writer.Long(menu->GetTextColor());
+        WriteSequences(writer, menu->Actions);
+        writer.Word(menu->buttons.size());
+        for (FTButton &button : menu->buttons)
+        {
+            writer.String(button.Label);
+            writer.String(button.LogoName());
+            writer.String(button.LatchedLogoName());
+            writer.Byte((uint8_t)button.ButtonType);
+            writer.Byte(button.TextSize);
+            writer.Long(button.BackgroundColor);
+            writer.Long(button.Outline);
+            writer.Long(button.TextColor);
+            writer.Word(button.RepeatDelay);
+            writer.Word(button.RepeatInterval);
+            writer.Byte(button.RepeatAcceleration);
+            WriteSequences(writer, button.Sequences);
+        }
+    }
+    static bool ReadSequences(ImageReader &reader, ActionSequencesList &sequences)
+    {
+        uint8_t count = reader.Byte();
+        for (uint8_t i = 0; i < count && !reader.Failed; i++)
+        {
+            ActionsSequences sequence;
+            std::vector<FTAction *> actions;
+            const char *configSequence = reader.String();
+            uint16_t codeSize = reader.Word();
+            const uint8_t *code = reader.Bytes(codeSize);
+            uint8_t actionsCount = reader.Byte();
+            for (uint8_t a = 0; a < actionsCount && !reader.Failed; a++)
+            {
+                ParametersList_t parameters;
+                const uint8_t *record = reader.Pos;
+                uint8_t parametersCount = reader.Byte();
+                for (uint8_t p = 0; p < parametersCount && !reader.Failed; p++)
+                {
+                    parameters.push_back(reader.String());
+                }
+                if (reader.Failed)
+                {
+                    break;
+                }
+                FTAction *&action = LocalActions[std::string((const char *)record, reader.Pos - record)];
+                if (!action)
+                {
+                    action = new FTAction(parameters);
+                }
+                actions.push_back(action);
+            }
+            if (!reader.Failed && codeSize > 0)
+            {
+                sequence.Load(configSequence, code, codeSize, actions);
+                sequences.push_back(sequence);
+            }
+        }
+        return !reader.Failed;
+    }
+    // Reads the head of a menu, to build a menu which isn't loaded yet
+    static Menu *ReadMenuHead(ImageReader &reader)
+    {
+        const char *name = reader.String();
+        const char *label = reader.String();
+        const char *icon = reader.String();
+        MenuTypes type = (MenuTypes)reader.Byte();
+        uint8_t rowsCount = reader.Byte();
+        uint8_t colsCount = reader.Byte();
+        uint8_t textSize = reader.Byte();
+        uint32_t backgroundColor = reader.Long();
+        uint32_t outline = reader.Long();
+        uint32_t textColor = reader.Long();
+        if (reader.Failed || rowsCount == 0 || colsCount == 0 || type >= MenuTypes::ENDLIST)
+        {
+            reader.Failed = true;
+            return NULL;
+        }
+        Menu *menu = new Menu(type, name, label, icon, rowsCount, colsCount, backgroundColor, outline, textColor, textSize);
+        menu->Loaded = false;
+        return menu;
+    }
+    static bool ReadMenuBody(ImageReader &reader, Menu *menu)
+    {
+        ReadSequences(reader, menu->Actions);
+        uint16_t buttonsCount = reader.Word();
+        for (uint16_t i = 0; i < buttonsCount && !reader.Failed; i++)
+        {
+            const char *buttonLabel = reader.String();
+            const char *logo = reader.String();
+            const char *latchedLogo = reader.String();
+            ButtonTypes buttonType = (ButtonTypes)reader.Byte();
+            uint8_t buttonTextSize = reader.Byte();
+            uint32_t buttonBackgroundColor = reader.Long();
+            uint32_t buttonOutline = reader.Long();
+            uint32_t buttonTextColor = reader.Long();
+            if (reader.Failed || buttonType >= ButtonTypes::ENDLIST)
+            {
+                reader.Failed = true;
+                break;
+            }
+            FTButton button(buttonType, buttonLabel, logo, latchedLogo, buttonOutline, buttonTextSize, buttonTextColor);
+            button.BackgroundColor = buttonBackgroundColor;
+            button.MenuBackgroundColor = menu->BackgroundColor;
+            button.RepeatDelay = reader.Word();
+            button.RepeatInterval = reader.Word();
+            button.RepeatAcceleration = reader.Byte();
+            if (ReadSequences(reader, button.Sequences))
+            {
+                menu->AddButton(button);
+            }
+        }
+        return !reader.Failed;
+    }
+    // Skips action sequences, without building their actions
+    static void SkipSequences(ImageReader &reader)
+    {
+        uint8_t count = reader.Byte();
+        for (uint8_t i = 0; i < count && !reader.Failed; i++)
+        {
+            reader.String();
+            reader.Bytes(reader.Word());
+            uint8_t actionsCount = reader.Byte();
+            for (uint8_t a = 0; a < actionsCount && !reader.Failed; a++)
+            {
+                uint8_t parametersCount = reader.Byte();
+                for (uint8_t p = 0; p < parametersCount && !reader.Failed; p++)
+                {
+                    reader.String();
+                }
+            }
+        }
+    }
+    static bool IsValidHeader(const CompiledHeader_t &header, size_t maxSize, uint32_t menusHash, uint32_t generalHash)
+    {
+        return header.Magic == COMPILED_MENUS_MAGIC && header.Version == COMPILED_MENUS_VERSION &&
+               header.Size > sizeof(CompiledHeader_t) && header.Size <= maxSize &&
+               header.StringsOffset >= sizeof(CompiledHeader_t) + header.MenusCount * sizeof(uint32_t) && header.StringsSize > 0 && header.StringsOffset + header.StringsSize == header.Size &&
+               header.MenusHash == menusHash && header.GeneralHash == generalHash;
+    }
+    static bool IsValidImage(const uint8_t *image, const CompiledHeader_t &header)
+    {
+        // a string table ending with a terminator can't be read past its end
+        return Hash(image + sizeof(CompiledHeader_t), header.Size - sizeof(CompiledHeader_t)) == header.ImageHash &&
+               image[header.Size - 1] == '\0';
+    }
+
+#ifdef COMPILED_MENUS_PARTITION
+    static const esp_partition_t *FindPartition()
+    {
+        return esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, COMPILED_MENUS_PARTITION);
+    }
+    static inline size_t SlotSize(const esp_partition_t *partition)
+    {
+        return (partition->size / 2) & ~(SPI_FLASH_SEC_SIZE - 1);
+    }
+    static bool ReadSlotHeader(const esp_partition_t *partition, int slot, CompiledHeader_t &header)
+    {
+        return esp_partition_read(partition, slot * SlotSize(partition), &header, sizeof(header)) == ESP_OK && header.Magic == COMPILED_MENUS_MAGIC;
+    }
+    // Maps the most recent image compiled from the current files, or returns NULL
+    static const uint8_t *MapPartitionImage(const esp_partition_t *partition, uint32_t menusHash, CompiledHeader_t &header, int &slot, spi_flash_mmap_handle_t &handle)
+    {
+        CompiledHeader_t slotHeader;
+        const void *image = NULL;
+        slot = -1;
+        for (int i = 0; i < 2; i++)
+        {
+            if (ReadSlotHeader(partition, i, slotHeader) && IsValidHeader(slotHeader, SlotSize(partition), menusHash, BuiltGeneralHash) &&
+                (slot < 0 || slotHeader.Generation > header.Generation))
+            {
+                header = slotHeader;
+                slot = i;
+            }
+        }
+        if (slot < 0)
+        {
+            return NULL;
+        }
+        esp_err_t err = esp_partition_mmap(partition, slot * SlotSize(partition), header.Size, SPI_FLASH_MMAP_DATA, &image, &handle);
+        if (err != ESP_OK)
+        {
+            LOC_LOGE(module, "Unable to map the compiled menus: %s", esp_err_to_name(err));
+            return NULL;
+        }
+        if (!IsValidImage((const uint8_t *)image, header))
+        {
+            LOC_LOGW(module, "Compiled menus image of slot %d is corrupted", slot);
+            spi_flash_munmap(handle);
+            return NULL;
+        }
+        return (const uint8_t *)image;
+    }
+    static bool WritePartitionImage(const esp_partition_t *partition, std::vector<uint8_t> &image)
+    {
+        CompiledHeader_t header;
+        uint32_t generation = 0;
+        size_t slotSize = SlotSize(partition);
+        if (image.size() > slotSize)
+        {
+            LOC_LOGW(module, "Compiled menus need %d bytes, but partition %s slots only have %d bytes", image.size(), COMPILED_MENUS_PARTITION, slotSize);
+            return false;
+        }
+        for (int i = 0; i < 2; i++)
+        {
+            if (ReadSlotHeader(partition, i, header))
+            {
+                generation = max(generation, header.Generation);
+            }
+        }
+        // the menus may run code mapped from the loaded slot, the other one is written
+        int slot = LoadedSlot == 0 ? 1 : 0;
+        size_t offset = slot * slotSize;
+        memcpy(&header, image.data(), sizeof(header));
+        header.Generation = generation + 1;
+        memcpy(image.data(), &header, sizeof(header));
+        esp_err_t err = esp_partition_erase_range(partition, offset, (image.size() + SPI_FLASH_SEC_SIZE - 1) & ~(SPI_FLASH_SEC_SIZE - 1));
+        // the header is written last, so an interrupted write leaves an invalid slot
+        if (err == ESP_OK)
+        {
+            err = esp_partition_write(partition, offset + sizeof(header), image.data() + sizeof(header), image.size() - sizeof(header));
+        }
+        if (err == ESP_OK)
+        {
+            err = esp_partition_write(partition, offset, image.data(), sizeof(header));
+        }
+        if (err != ESP_OK)
+        {
+            LOC_LOGE(module, "Unable to write the compiled menus to partition %s: %s", COMPILED_MENUS_PARTITION, esp_err_to_name(err));
+            return false;
+        }
+        LOC_LOGD(module, "Compiled menus written to slot %d, generation %d", slot, header.Generation);
+        return true;
+    }
+#endif
+    // Reads the image from the file system, or returns NULL
+    static const uint8_t *ReadFileImage(uint32_t menusHash, CompiledHeader_t &header)
+    {
+        uint8_t *image = NULL;
+        if (!ftdfs->exists(COMPILED_MENUS_FILE))
+        {
+            return NULL;
+        }
+        File file = ftdfs->open(COMPILED_MENUS_FILE, FILE_READ);
+        if (!file || file.read((uint8_t *)&header, sizeof(header)) != sizeof(header) || !IsValidHeader(header, file.size(), menusHash, BuiltGeneralHash))
+        {
+            LOC_LOGD(module, "%s was not compiled from the current configuration", COMPILED_MENUS_FILE);
+            file.close();
+            return NULL;
+        }
+        image = (uint8_t *)malloc_fn(header.Size);
+        if (!image)
+        {
+            LOC_LOGE(module, "Unable to allocate %d bytes for the compiled menus", header.Size);
+        }
+        else
+        {
+            memcpy(image, &header, sizeof(header));
+            if (file.read(image + sizeof(header), header.Size - sizeof(header)) != header.Size - sizeof(header) || !IsValidImage(image, header))
+            {
+                LOC_LOGW(module, "%s is corrupted", COMPILED_MENUS_FILE);
+                FREE_AND_NULL(image);
+            }
+        }
+        file.close();
+        return image;
+    }
+    static bool WriteFileImage(const std::vector<uint8_t> &image)
+    {
+        return WriteConfigFile(COMPILED_MENUS_FILE, image.data(), image.size());
+    }
+
+    bool LoadCompiledMenus(std::vector<Menu *> &menus)
+    {
+        CompiledHeader_t header;
+        const uint8_t *image = NULL;
+        uint32_t start = millis();
+        uint32_t menusHash = HashFile("/config/menus.json");
+        // the menus are about to be built with the current general configuration
+        BuiltGeneralHash = HashFile("/config/general.json");
+#ifdef COMPILED_MENUS_PARTITION
+        int slot = -1;
+        spi_flash_mmap_handle_t handle = 0;
+        const esp_partition_t *partition = FindPartition();
+        if (partition)
+        {
+            image = MapPartitionImage(partition, menusHash, header, slot, handle);
+        }
+        else
+#endif
+        {
+            image = ReadFileImage(menusHash, header);
+        }
+        if (!image)
+        {
+            LOC_LOGI(module, "No compiled menus for the current configuration");
+            return false;
+        }
+        // only the heads of the menus are read, the rest is loaded when a menu is shown
+        ImageReader offsets(image, header, sizeof(CompiledHeader_t));
+        std::vector<Menu *> loaded;
+        for (uint16_t i = 0; i < header.MenusCount && !offsets.Failed; i++)
+        {
+            uint32_t offset = offsets.Long();
+            ImageReader reader(image, header, offset);
+            Menu *menu = reader.Failed ? NULL : ReadMenuHead(reader);
+            if (!menu)
+            {
+                offsets.Failed = true;
+                break;
+            }
+            menu->ImageOffset = offset;
+            loaded.push_back(menu);
+        }
+        if (offsets.Failed)
+        {
+            // no menu refers to the image, which is released before menus.json is parsed
+            LOC_LOGE(module, "Invalid compiled menus image");
+            for (Menu *menu : loaded)
+            {
+                delete (menu);
+            }
+#ifdef COMPILED_MENUS_PARTITION
+            if (partition)
+            {
+                spi_flash_munmap(handle);
+            }
+            else
+#endif
+            {
+                free((void *)image);
+            }
+            return false;
+        }
+#ifdef COMPILED_MENUS_PARTITION
+        LoadedSlot = slot;
+#endif
+        Image = image;
+        ImageHeader = header;
+        menus.insert(menus.end(), loaded.begin(), loaded.end());
+        LOC_LOGI(module, "Indexed %d compiled menus of %d bytes in %d ms", loaded.size(), header.Size, millis() - start);
+        return true;
+    }
+    bool LoadCompiledMenu(Menu *menu)
+    {
+        if (!Image || menu->ImageOffset == 0)
+        {
+            LOC_LOGE(module, "Menu %s isn't in the compiled menus", menu->Name.c_str());
+            return false;
+        }
+        uint32_t start = micros();
+        ImageReader reader(Image, ImageHeader, menu->ImageOffset);
+        reader.Bytes(COMPILED_MENU_HEAD_SIZE);
+        if (!ReadMenuBody(reader, menu))
+        {
+            LOC_LOGE(module, "Invalid compiled menu %s", menu->Name.c_str());
+            menu->buttons.clear();
+            menu->Actions.clear();
+            return false;
+        }
+        LOC_LOGD(module, "Loaded menu %s with %d buttons in %d us", menu->Name.c_str(), menu->buttons.size(), micros() - start);
+        return true;
+    }
+    bool GetCompiledMenuImages(const Menu *menu, std::vector<std::string> &images)
+    {
+        if (!Image || menu->ImageOffset == 0)
+        {
+            return false;
+        }
+        ImageReader reader(Image, ImageHeader, menu->ImageOffset);
+        reader.Bytes(COMPILED_MENU_HEAD_SIZE);
+        SkipSequences(reader);
+        uint16_t buttonsCount = reader.Word();
+        for (uint16_t i = 0; i < buttonsCount && !reader.Failed; i++)
+        {
+            reader.String();
+            const char *logo = reader.String();
+            const char *latchedLogo = reader.String();
+            ButtonTypes buttonType = (ButtonTypes)reader.Byte();
+            // text size, the three colors, then the repeat delay, interval and acceleration
+            reader.Bytes(1 + 3 * 4 + 2 + 2 + 1);
+            SkipSequences(reader);
+            if (reader.Failed)
+            {
+                break;
+            }
+            // same names as FTButton::GetImageNames
+            if (*logo)
+            {
+                images.push_back(logo);
+            }
+            if (buttonType == ButtonTypes::LATCH && *latchedLogo)
+            {
+                images.push_back(latchedLogo);
+            }
+        }
+        return !reader.Failed;
+    }
+    static inline void SetLong(std::vector<uint8_t> &data, size_t pos, uint32_t value)
+    {
+        for (size_t i = 0; i < sizeof(value); i++)
+        {
+            data[pos + i] = (value >> (i * 8)) & 0xFF;
+        }
+    }
+    bool SaveCompiledMenus(const std::vector<Menu *> &menus)
+    {
+        ImageWriter writer;
+        CompiledHeader_t header;
+        std::vector<Menu *> compiled;
+        uint32_t start = millis();
+        memset(&header, 0x00, sizeof(header));
+        for (Menu *menu : menus)
+        {
+            if (menu->Type == MenuTypes::SYSTEM || menu->Type == MenuTypes::HOMESYSTEM)
+                continue; // built-in, like in menus.json
+            compiled.push_back(menu);
+        }
+        header.MenusCount = compiled.size();
+        writer.Data.resize(writer.Data.size() + compiled.size() * sizeof(uint32_t));
+        for (size_t i = 0; i < compiled.size() && !writer.Failed; i++)
+        {
+            Menu *menu = compiled[i];
+            // menus that aren't loaded are loaded one at a time
+            bool wasLoaded = menu->Loaded;
+            if (!menu->Load())
+            {
+                writer.Failed = true;
+                break;
+            }
+            SetLong(writer.Data, sizeof(CompiledHeader_t) + i * sizeof(uint32_t), writer.Data.size());
+            WriteMenu(writer, menu);
+            if (!wasLoaded)
+            {
+                menu->Unload();
+            }
+        }
+        if (writer.Failed)
+        {
+            LOC_LOGW(module, "Menus could not be compiled, menus.json will be parsed at boot");
+            return false;
+        }
+        header.Magic = COMPILED_MENUS_MAGIC;
+        header.Version = COMPILED_MENUS_VERSION;
+        header.StringsOffset = writer.Data.size();
+        header.StringsSize = writer.Strings.size();
+        writer.Data.insert(writer.Data.end(), writer.Strings.begin(), writer.Strings.end());
+        header.Size = writer.Data.size();
+        header.ImageHash = Hash(writer.Data.data() + sizeof(header), header.Size - sizeof(header));
+        header.MenusHash = HashFile("/config/menus.json");
+        header.GeneralHash = BuiltGeneralHash;
+        memcpy(writer.Data.data(), &header, sizeof(header));
+        bool result = false;
+#ifdef COMPILED_MENUS_PARTITION
+        const esp_partition_t *partition = FindPartition();
+        if (partition)
+        {
+            result = WritePartitionImage(partition, writer.Data);
+        }
+        else
+#endif
+        {
+            result = WriteFileImage(writer.Data);
+        }
+        if (result)
+        {
+            LOC_LOGI(module, "Compiled %d menus to %d bytes in %d ms", header.MenusCount, header.Size, millis() - start);
+        }
+        return result;
+    }
+}
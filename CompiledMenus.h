@@ -0,0 +1,44 @@
+#pragma once
+#include "globals.hpp"
+#include "UserConfig.h"
+#include "Menu.h"
+namespace FreeTouchDeck
+{
+    /**
+* @brief Loads the menus from the compiled image, when it was compiled
+*        from the current menus.json and general.json.
+*
+* @param menus std::vector<Menu *> & receives the menus of the image
+*
+* @return bool true if the image was valid and its menus were indexed,
+*         false when menus.json has to be parsed
+*
+* @note Only the name, type, sizes and colors of the menus are read, their
+*       buttons and actions are loaded by Menu::Load. The compiled action
+*       code stays in the image, which is never unmapped
+*/
+    bool LoadCompiledMenus(std::vector<Menu *> &menus);
+    // Loads the buttons and actions of a menu indexed by LoadCompiledMenus
+    bool LoadCompiledMenu(Menu *menu);
+    /**
+* @brief Lists the logos of the buttons of a compiled menu, read from the
+*        image without loading the menu.
+*
+* @param menu const Menu * menu indexed by LoadCompiledMenus
+* @param images std::vector<std::string> & receives the logo names
+*
+* @return bool false if the menu isn't in the compiled image
+*/
+    bool GetCompiledMenuImages(const Menu *menu, std::vector<std::string> &images);
+    /**
+* @brief Compiles the menus saved in menus.json to a binary image, with
+*        their buttons, compiled action sequences and interned strings.
+*
+* @param menus const std::vector<Menu *> & menus, system menus are skipped
+*
+* @return bool true if the image was written
+*
+* @note The caller holds the screen lock
+*/
+    bool SaveCompiledMenus(const std::vector<Menu *> &menus);
+}
@@ -4,6 +4,9 @@
 #include "Storage.h"
 #include "ConfigHelper.h"
 #include "FTAction.h"
+#include "ConfigStore.h"
+#include "esp_timer.h"
+#include <atomic>
 namespace FreeTouchDeck
 {
   FTAction *saveConfigAction = new FTAction(ParametersList_t({"SAVECONFIG"}));
@@ -278,7 +281,9 @@ namespace FreeTouchDeck
     if (!GetValueOrDefault(cJSON_GetObjectItem(doc, name), valuePointer, defaultValue))
     {
       DumpCJson(doc);
+      return false;
     }
+    return true;
   }
   bool GetValueOrDefault(cJSON *doc, const char *name, std::string &valuePointer, const char *defaultValue)
   {
@@ -287,7 +292,9 @@ namespace FreeTouchDeck
     if (!GetValueOrDefault(cJSON_GetObjectItem(doc, name), valuePointer, defaultValue))
     {
       DumpCJson(doc);
+      return false;
     }
+    return true;
   }
 
   bool GetValueOrDefault(cJSON *doc, const char *name, uint16_t *valuePointer, uint16_t defaultValue)
@@ -297,7 +304,9 @@ namespace FreeTouchDeck
     if (!GetValueOrDefault(cJSON_GetObjectItem(doc, name), valuePointer, defaultValue))
     {
       DumpCJson(doc);
+      return false;
     }
+    return true;
   }
 
   bool GetValueOrDefault(cJSON *doc, const char *name, uint8_t *valuePointer, uint8_t defaultValue)
@@ -307,7 +316,9 @@ namespace FreeTouchDeck
     if (!GetValueOrDefault(cJSON_GetObjectItem(doc, name), valuePointer, defaultValue))
     {
       DumpCJson(doc);
+      return false;
     }
+    return true;
   }
   void GetValueOrDefault(cJSON *doc, const char *name, bool *valuePointer, bool defaultValue)
   {
@@ -365,6 +376,11 @@ namespace FreeTouchDeck
   {
     Config currentConfig;
     memcpy(&currentConfig, &generalconfig, sizeof(currentConfig));
+    // the names are freed when loaded again, so compare with copies
+    std::string currentDeviceName = STRING_OR_DEFAULT(generalconfig.deviceName, "");
+    std::string currentManufacturer = STRING_OR_DEFAULT(generalconfig.manufacturer, "");
+    currentConfig.deviceName = &currentDeviceName[0];
+    currentConfig.manufacturer = &currentManufacturer[0];
 
     if (ISNULLSTRING(name))
     {
@@ -487,10 +503,50 @@ namespace FreeTouchDeck
 
     return true;
   }
-  void QueueSaving()
+  // Saves queued within CONFIG_SAVE_DELAY_MS of each other are written once
+  static esp_timer_handle_t SaveTimer = NULL;
+  static std::atomic<bool> SavePending{false};
+  static void SaveTimerExpired(void *arg)
   {
+    // saved by the screen task, like the SAVECONFIG action
     QueueAction(saveConfigAction);
   }
+  void InitConfigSaving()
+  {
+    esp_timer_create_args_t args = {};
+    args.callback = &SaveTimerExpired;
+    args.name = "ConfigSave";
+    if (esp_timer_create(&args, &SaveTimer) != ESP_OK)
+    {
+      SaveTimer = NULL;
+      LOC_LOGE(module, "Unable to create the configuration save timer");
+    }
+  }
+  void QueueSaving()
+  {
+    if (!SaveTimer)
+    {
+      // saves aren't coalesced without the timer
+      QueueAction(saveConfigAction);
+      return;
+    }
+    CountSaveRequest(SavePending.exchange(true));
+    esp_timer_stop(SaveTimer);
+    esp_timer_start_once(SaveTimer, CONFIG_SAVE_DELAY_MS * 1000);
+  }
+  bool FlushConfigSaving()
+  {
+    if (!SavePending)
+    {
+      return true;
+    }
+    if (SaveTimer)
+    {
+      esp_timer_stop(SaveTimer);
+    }
+    LOC_LOGI(module, "Saving the pending configuration changes");
+    return saveConfig(false);
+  }
 
   bool loadGeneralConfig()
   {
@@ -571,6 +627,8 @@ namespace FreeTouchDeck
   }
   bool saveConfig(bool serial)
   {
+    // a save queued until now is included
+    SavePending = false;
     cJSON *doc = GetConfigJson();
     SaveJsonToFile("/config/general.json", doc);
     if (serial)
@@ -55,7 +55,16 @@ namespace FreeTouchDeck
     bool GetColorOrDefault(cJSON *doc, const char *name, uint32_t *valuePointer, uint32_t defaultValue);
     char *GetModifierFromNumber(int modifier);
     void SetGeneralConfigDefaults();
+    /**
+* @brief Saves the general configuration once no other save was queued
+*        for CONFIG_SAVE_DELAY_MS, so repeated changes are written once.
+*/
     void QueueSaving();
+    // Creates the timer QueueSaving uses, once at startup
+    void InitConfigSaving();
+    // Saves the configuration now when a save is queued. Called before
+    // sleeping or restarting, as nothing saves it during esp_restart
+    bool FlushConfigSaving();
     /**
 * @brief This function loads the menu configuration.
 *
@@ -0,0 +1,190 @@
+#include "ConfigStore.h"
+#include "Storage.h"
+namespace FreeTouchDeck
+{
+    static const char *module = "ConfigStore";
+#define CONFIG_JOURNAL_FILE "/config/journal"
+#define CONFIG_TEMP_SUFFIX ".tmp"
+#define CONFIG_COMPARE_CHUNK_SIZE 256
+    // one file is replaced at a time, the journal has room for a single entry
+    static SemaphoreHandle_t xWriteSemaphore = xSemaphoreCreateMutex();
+    static portMUX_TYPE StatsMux = portMUX_INITIALIZER_UNLOCKED;
+    static ConfigWriteStats_t Stats = {0};
+
+    static inline void AddBytesWritten(size_t bytes)
+    {
+        portENTER_CRITICAL(&StatsMux);
+        Stats.BytesWritten += bytes;
+        portEXIT_CRITICAL(&StatsMux);
+    }
+    static bool WriteFile(const char *fileName, const uint8_t *data, size_t size)
+    {
+        File file = ftdfs->open(fileName, FILE_WRITE);
+        if (!file)
+        {
+            LOC_LOGE(module, "Error opening %s", fileName);
+            return false;
+        }
+        size_t written = file.write(data, size);
+        file.flush();
+        file.close();
+        AddBytesWritten(written);
+        if (written != size)
+        {
+            LOC_LOGE(module, "File %s could not be fully written to. Wrote %d bytes of %d bytes", fileName, written, size);
+            return false;
+        }
+        return true;
+    }
+    static bool HasContent(const char *fileName, const uint8_t *data, size_t size)
+    {
+        uint8_t chunk[CONFIG_COMPARE_CHUNK_SIZE];
+        bool result = false;
+        if (!ftdfs->exists(fileName))
+        {
+            return false;
+        }
+        File file = ftdfs->open(fileName, FILE_READ);
+        if (file && file.size() == size)
+        {
+            size_t pos = 0;
+            size_t len = 0;
+            while (pos < size && (len = file.read(chunk, sizeof(chunk))) > 0 && memcmp(chunk, data + pos, len) == 0)
+            {
+                pos += len;
+            }
+            result = pos == size;
+        }
+        file.close();
+        return result;
+    }
+    // Neither file system renames over an existing file
+    static bool ReplaceFile(const char *tempName, const char *fileName)
+    {
+        if (ftdfs->exists(fileName) && !ftdfs->remove(fileName))
+        {
+            LOC_LOGE(module, "Unable to remove %s", fileName);
+            return false;
+        }
+        if (!ftdfs->rename(tempName, fileName))
+        {
+            LOC_LOGE(module, "Unable to rename %s to %s", tempName, fileName);
+            return false;
+        }
+        return true;
+    }
+    bool WriteConfigFile(const char *fileName, const uint8_t *data, size_t size)
+    {
+        bool result = false;
+        std::string tempName = std::string(fileName) + CONFIG_TEMP_SUFFIX;
+        portENTER_CRITICAL(&StatsMux);
+        Stats.FileRequests++;
+        Stats.BytesRequested += size;
+        portEXIT_CRITICAL(&StatsMux);
+        if (xSemaphoreTake(xWriteSemaphore, portMAX_DELAY) != pdTRUE)
+        {
+            LOC_LOGE(module, "Unable to lock the configuration files");
+            return false;
+        }
+        if (HasContent(fileName, data, size))
+        {
+            LOC_LOGD(module, "%s is unchanged", fileName);
+            portENTER_CRITICAL(&StatsMux);
+            Stats.Unchanged++;
+            portEXIT_CRITICAL(&StatsMux);
+            xSemaphoreGive(xWriteSemaphore);
+            return true;
+        }
+        if (!WriteFile(tempName.c_str(), data, size))
+        {
+            ftdfs->remove(tempName.c_str());
+        }
+        // once the journal names the file, the copy is complete and a boot after a power loss finishes the replace
+        else if (WriteFile(CONFIG_JOURNAL_FILE, (const uint8_t *)fileName, strlen(fileName)))
+        {
+            result = ReplaceFile(tempName.c_str(), fileName);
+            ftdfs->remove(CONFIG_JOURNAL_FILE);
+        }
+        portENTER_CRITICAL(&StatsMux);
+        if (result)
+        {
+            Stats.Writes++;
+        }
+        else
+        {
+            Stats.Failures++;
+        }
+        portEXIT_CRITICAL(&StatsMux);
+        xSemaphoreGive(xWriteSemaphore);
+        LOC_LOGD(module, "%s %s, %d bytes", fileName, result ? "written" : "not written", size);
+        return result;
+    }
+    void RecoverConfigWrites()
+    {
+        char fileName[65] = {0};
+        std::vector<std::string> incomplete;
+        if (ftdfs->exists(CONFIG_JOURNAL_FILE))
+        {
+            File journal = ftdfs->open(CONFIG_JOURNAL_FILE, FILE_READ);
+            journal.read((uint8_t *)fileName, sizeof(fileName) - 1);
+            journal.close();
+            std::string tempName = std::string(fileName) + CONFIG_TEMP_SUFFIX;
+            if (fileName[0] == '/' && ftdfs->exists(tempName.c_str()))
+            {
+                LOC_LOGW(module, "Completing the interrupted write of %s", fileName);
+                ReplaceFile(tempName.c_str(), fileName);
+                Stats.Recovered++;
+            }
+            ftdfs->remove(CONFIG_JOURNAL_FILE);
+        }
+        // copies without a journal entry were interrupted before they were complete
+        File dir = ftdfs->open("/config", FILE_READ);
+        File file = dir ? dir.openNextFile() : File();
+        while (file)
+        {
+            std::string name = file.name();
+            if (name[0] != '/')
+            {
+                name = "/config/" + name;
+            }
+            if (name.size() > strlen(CONFIG_TEMP_SUFFIX) && name.compare(name.size() - strlen(CONFIG_TEMP_SUFFIX), std::string::npos, CONFIG_TEMP_SUFFIX) == 0)
+            {
+                incomplete.push_back(name);
+            }
+            file.close();
+            file = dir.openNextFile();
+        }
+        dir.close();
+        for (auto &name : incomplete)
+        {
+            LOC_LOGW(module, "Removing incomplete copy %s", name.c_str());
+            ftdfs->remove(name.c_str());
+            Stats.Recovered++;
+        }
+    }
+    void CountSaveRequest(bool coalesced)
+    {
+        portENTER_CRITICAL(&StatsMux);
+        Stats.SaveRequests++;
+        if (coalesced)
+        {
+            Stats.Coalesced++;
+        }
+        portEXIT_CRITICAL(&StatsMux);
+    }
+    ConfigWriteStats_t GetConfigWriteStats()
+    {
+        portENTER_CRITICAL(&StatsMux);
+        ConfigWriteStats_t stats = Stats;
+        portEXIT_CRITICAL(&StatsMux);
+        return stats;
+    }
+    void ConfigWriteStatsLog()
+    {
+        ConfigWriteStats_t stats = GetConfigWriteStats();
+        LOC_LOGI(module, "Save requests: %d, coalesced: %d", stats.SaveRequests, stats.Coalesced);
+        LOC_LOGI(module, "File writes requested: %d, unchanged: %d, written: %d, failed: %d, recovered at boot: %d", stats.FileRequests, stats.Unchanged, stats.Writes, stats.Failures, stats.Recovered);
+        LOC_LOGI(module, "Bytes requested: %d, written: %d, write amplification: %.2f", stats.BytesRequested, stats.BytesWritten,
+                 stats.BytesRequested > 0 ? (float)stats.BytesWritten / stats.BytesRequested : 0.0);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "globals.hpp"
+#include "UserConfig.h"
+namespace FreeTouchDeck
+{
+    typedef struct
+    {
+        // saves asked by QueueSaving, and how many were merged in a later save
+        uint32_t SaveRequests;
+        uint32_t Coalesced;
+        // files to write, and how many were skipped because they already had the content
+        uint32_t FileRequests;
+        uint32_t Unchanged;
+        uint32_t Writes;
+        uint32_t Failures;
+        // bytes of the files to write, and bytes written with the temporary copies and the journal
+        uint32_t BytesRequested;
+        uint32_t BytesWritten;
+        // interrupted writes completed or discarded at boot
+        uint32_t Recovered;
+    } ConfigWriteStats_t;
+    /**
+* @brief Replaces a configuration file. The content is written to a temporary
+*        copy, which replaces the file once a journal entry records that it
+*        is complete, so a power loss leaves the old or the new content.
+*
+* @param fileName const char * file to replace
+* @param data const uint8_t * new content
+* @param size size_t size of the new content
+*
+* @return bool true if the file has the new content
+*
+* @note Nothing is written when the file already has the content
+*/
+    bool WriteConfigFile(const char *fileName, const uint8_t *data, size_t size);
+    // Completes the replace journaled before a power loss, and removes incomplete copies
+    void RecoverConfigWrites();
+    // Counts a save asked by QueueSaving, merged with a pending one when coalesced is true
+    void CountSaveRequest(bool coalesced);
+    ConfigWriteStats_t GetConfigWriteStats();
+    void ConfigWriteStatsLog();
+}
@@ -4,6 +4,9 @@
 #include "MenuNavigation.h"
 #include "ConfigHelper.h"
 #include "ConfigLoad.h"
+#include "ImageCache.h"
+#include "Trace.h"
+#include "ConfigStore.h"
 namespace FreeTouchDeck
 {
     static const char *module = "Console";
@@ -85,8 +88,74 @@ namespace FreeTouchDeck
             {
                 LOC_LOGI(module, "free_iram: %d", heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
                 LOC_LOGI(module, "min_free_iram: %d", heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+                const PixelCacheStats_t &stats = ImageCache::GetPixelCacheStats();
+                LOC_LOGI(module, "image_cache: %d/%d bytes, %d images, hits: %d, misses: %d, evictions: %d", stats.BytesUsed, stats.Budget, stats.Entries, stats.Hits, stats.Misses, stats.Evictions);
+                for (ActionLane lane = ActionLane::NAVIGATION; lane < ActionLane::ENDLIST; lane = (ActionLane)((int)lane + 1))
+                {
+                    ActionQueueStats_t queueStats = GetActionQueueStats(lane);
+                    LOC_LOGI(module, "%s_queue: %d/%d actions, high water: %d, overflows: %d, cancelled: %d", enum_to_string(lane), queueStats.Depth, queueStats.Capacity, queueStats.HighWater, queueStats.Overflows, queueStats.Cancelled);
+                }
             }
 
+            else if (command == "benchrgb")
+            {
+                BenchmarkColorConversion(480, 100);
+            }
+            else if (command.startsWith("bench"))
+            {
+                String value = command.substring(5);
+                value.trim();
+                uint8_t rounds = value.length() > 0 ? value.toInt() : 5;
+                BenchmarkMenus(rounds);
+            }
+            else if (command == "actions")
+            {
+                HistogramLog("action_latency_us", ActionLatency);
+                HistogramLog("action_queue_depth", ActionQueueDepth);
+            }
+            else if (command == "actions reset")
+            {
+                HistogramReset(ActionLatency);
+                HistogramReset(ActionQueueDepth);
+            }
+            else if (command == "trace")
+            {
+                TraceLog();
+            }
+            else if (command == "trace clear")
+            {
+                TraceClear();
+            }
+            else if (command == "writes")
+            {
+                ConfigWriteStatsLog();
+            }
+            else if (command.startsWith("disasm"))
+            {
+                String value = command.substring(command.lastIndexOf(" "));
+                value.trim();
+                Menu *menu = GetScreen(value.c_str());
+                if (!menu)
+                {
+                    LOC_LOGE(module, "Unknown screen %s", value.c_str());
+                }
+                else
+                {
+                    for (FTButton &button : menu->buttons)
+                    {
+                        for (ActionsSequences &sequence : button.Sequences)
+                        {
+                            LOC_LOGI(module, "Button %s: %s", button.Label.c_str(), STRING_OR_DEFAULT(sequence.ConfigSequence, ""));
+                            sequence.Disassemble();
+                        }
+                    }
+                    for (ActionsSequences &sequence : menu->Actions)
+                    {
+                        LOC_LOGI(module, "Menu %s: %s", menu->Name.c_str(), STRING_OR_DEFAULT(sequence.ConfigSequence, ""));
+                        sequence.Disassemble();
+                    }
+                }
+            }
             else if (command.startsWith("activate"))
             {
                 String value = command.substring(command.lastIndexOf(" "));
@@ -179,6 +248,7 @@ namespace FreeTouchDeck
             else if (command == "restart")
             {
                 LOC_LOGD(module, "Restarting");
+                FlushConfigSaving();
                 ESP.restart();
             }
             else if (command == "convertmenus")
@@ -328,6 +398,12 @@ configmode : change the system mode to configuration
 loglevel (0-5) : increase log details for some activities - warning: more logs will slow down the system
 dir : show the content of the file system
 memory : show memory usage
+bench (rounds) : time drawing each menu, and count the image transfers
+benchrgb : check and time the RGB565 row conversion against the per pixel version
+actions (reset) : show, or clear, the histograms of keyboard action latency and queue depth
+disasm (menu) : list the compiled actions of the menu buttons
+trace (clear) : show, or clear, the recent action queue, execution and keyboard report times. Also at /trace.json
+writes : count the configuration saves and file writes, and the bytes written
 )");
             }
             else
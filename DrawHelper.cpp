@@ -12,6 +12,7 @@ namespace FreeTouchDeck
 {
   using namespace fs;
   TFT_eSPI tft = TFT_eSPI();
+  RenderStats_t RenderStats = {0, 0};
   /* ------------- Print an error message the TFT screen  ---------------- 
 Purpose: This function prints an message to the TFT screen on a black 
          background. 
@@ -128,10 +129,11 @@ Note   : none
   {
     CurrentFont = newFont;
     tft.setFreeFont(newFont);
+    return true;
   }
   bool SetDefaultFont()
   {
-    SetFont(DefaultFont);
+    return SetFont(DefaultFont);
   }
   void InitFontsTable()
   {
@@ -154,12 +156,13 @@ Note   : none
     std::advance(it, whichOne);
     if (it != FontsList.end())
     {
-      SetFont(*it);
+      return SetFont(*it);
     }
+    return false;
   }
   bool SetLargestFont()
   {
-    SetFont(FontsList.back());
+    return SetFont(FontsList.back());
   }
   template <typename iter, typename t>
   iter iterator_from_ptr(iter first, iter last, t ptr)
@@ -168,10 +171,10 @@ Note   : none
     {
       if (*first == ptr)
       {
-        LOC_LOGV(module, "%d == %d. Returning iterator at this position", (uint32_t)*first, (uint32_t)ptr);
+        LOC_LOGV(module, "%d == %d. Returning iterator at this position", (uint32_t)(uintptr_t)*first, (uint32_t)(uintptr_t)ptr);
         return first;
       }
-      LOC_LOGV(module, "%d != %d. Getting next", (uint32_t)*first, (uint32_t)ptr);
+      LOC_LOGV(module, "%d != %d. Getting next", (uint32_t)(uintptr_t)*first, (uint32_t)(uintptr_t)ptr);
       ++first;
     }
     LOC_LOGV(module, "Returning last pointer ");
@@ -292,6 +295,96 @@ Note   : none
     }
   }
 
+  static inline uint16_t pack565(uint32_t b, uint32_t g, uint32_t r, bool swapBytes)
+  {
+    uint16_t color = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | ((b & 0xFF) >> 3);
+    return swapBytes ? (color >> 8) | (color << 8) : color;
+  }
+  void convertRGB888RowToRGB565(const uint8_t *src, uint16_t *dst, size_t count, uint8_t depth, bool swapBytes)
+  {
+    size_t i = 0;
+    // word accesses need 4 bytes alignment on the ESP32
+    bool aligned = (((uintptr_t)src | (uintptr_t)dst) & 0x03) == 0;
+    if (aligned && depth == 24)
+    {
+      const uint32_t *in = (const uint32_t *)src;
+      uint32_t *out = (uint32_t *)dst;
+      // 4 pixels are 12 bytes, or 3 words: BGRB GRBG RBGR
+      for (; i + 4 <= count; i += 4)
+      {
+        uint32_t w0 = *in++;
+        uint32_t w1 = *in++;
+        uint32_t w2 = *in++;
+        uint32_t p0 = pack565(w0, w0 >> 8, w0 >> 16, swapBytes);
+        uint32_t p1 = pack565(w0 >> 24, w1, w1 >> 8, swapBytes);
+        uint32_t p2 = pack565(w1 >> 16, w1 >> 24, w2, swapBytes);
+        uint32_t p3 = pack565(w2 >> 8, w2 >> 16, w2 >> 24, swapBytes);
+        *out++ = p0 | (p1 << 16);
+        *out++ = p2 | (p3 << 16);
+      }
+    }
+    else if (aligned && depth == 32)
+    {
+      const uint32_t *in = (const uint32_t *)src;
+      uint32_t *out = (uint32_t *)dst;
+      for (; i + 2 <= count; i += 2)
+      {
+        uint32_t w0 = *in++;
+        uint32_t w1 = *in++;
+        *out++ = pack565(w0, w0 >> 8, w0 >> 16, swapBytes) | (pack565(w1, w1 >> 8, w1 >> 16, swapBytes) << 16);
+      }
+    }
+    // unaligned buffers and remaining pixels
+    for (; i < count; i++)
+    {
+      const uint8_t *pixel = src + i * (depth / 8);
+      dst[i] = pack565(pixel[0], pixel[1], pixel[2], swapBytes);
+    }
+  }
+  void BenchmarkColorConversion(size_t count, uint16_t rounds)
+  {
+    // +4 leaves room to test unaligned rows
+    uint8_t *src = (uint8_t *)malloc_fn(count * 4 + 4);
+    uint16_t *reference = (uint16_t *)malloc_fn(count * sizeof(uint16_t));
+    uint16_t *dst = (uint16_t *)malloc_fn(count * sizeof(uint16_t));
+    for (size_t i = 0; i < count * 4 + 4; i++)
+    {
+      src[i] = esp_random();
+    }
+    for (uint8_t depth = 24; depth <= 32; depth += 8)
+    {
+      for (uint8_t offset = 0; offset < 2; offset++)
+      {
+        bool match = true;
+        const uint8_t *row = src + offset;
+        uint32_t start = micros();
+        for (uint16_t r = 0; r < rounds; r++)
+        {
+          for (size_t i = 0; i < count; i++)
+          {
+            uint16_t color = convertRGB888ToRGB565((uint8_t *)row + i * (depth / 8), depth);
+            reference[i] = (color >> 8) | (color << 8);
+          }
+        }
+        uint32_t referenceTime = micros() - start;
+        start = micros();
+        for (uint16_t r = 0; r < rounds; r++)
+        {
+          convertRGB888RowToRGB565(row, dst, count, depth, true);
+        }
+        uint32_t rowTime = micros() - start;
+        for (size_t i = 0; i < count && match; i++)
+        {
+          match = dst[i] == reference[i];
+        }
+        LOC_LOGI(module, "%dbpp %s: per pixel %u us, row %u us for %d rounds of %d pixels. Results %s", depth, offset ? "unaligned" : "aligned", referenceTime, rowTime, rounds, count, match ? "match" : "DIFFER");
+      }
+    }
+    FREE_AND_NULL(src);
+    FREE_AND_NULL(reference);
+    FREE_AND_NULL(dst);
+  }
+
   void DrawSplash()
   {
     LOC_LOGD(module, "Loading splash screen bitmap.");
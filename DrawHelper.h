@@ -45,7 +45,8 @@ inline unsigned int convertRGB888ToRGB565(uint8_t * rgb, uint8_t depth)
       switch (depth)
       {
       case 24:
-        // colors are stored as BGR
+      case 32:
+        // colors are stored as BGR, followed by alpha for 32 bits
         //*tptr++ = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
           return (pV[0] >>3) |  ((pV[1] & 0xfc)<<3)| ((pV[2] & 0xF8)<< 8);
           break;
@@ -54,5 +55,49 @@ inline unsigned int convertRGB888ToRGB565(uint8_t * rgb, uint8_t depth)
       }
       return 0;
   }
+    /**
+* @brief Converts a row of 24 or 32 bits BGR pixels to RGB565, four pixels
+*        per iteration using word loads when the buffers are aligned.
+*
+* @param src const uint8_t * row of pixels, as stored in a bitmap
+* @param dst uint16_t * converted pixels
+* @param count size_t number of pixels
+* @param depth uint8_t bits per pixel of the source (24 or 32)
+* @param swapBytes bool true to produce pixels in the screen's byte order
+*
+* @note convertRGB888ToRGB565 is the reference for the conversion
+*/
+    void convertRGB888RowToRGB565(const uint8_t *src, uint16_t *dst, size_t count, uint8_t depth, bool swapBytes);
+    void BenchmarkColorConversion(size_t count, uint16_t rounds);
     extern std::vector<std::string> Messages;
+    typedef struct
+    {
+        uint32_t PushCalls;
+        uint32_t PushPixels;
+    } RenderStats_t;
+    extern RenderStats_t RenderStats;
+    /**
+* @brief Pushes an image to the screen, counting calls and pixels for the
+*        render statistics.
+*
+* @note Use instead of tft.pushImage so benchmarks see every transfer
+*/
+    inline void PushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data)
+    {
+        RenderStats.PushCalls++;
+        RenderStats.PushPixels += w * h;
+        tft.pushImage(x, y, w, h, data);
+    }
+    inline void PushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data, uint16_t transparent)
+    {
+        RenderStats.PushCalls++;
+        RenderStats.PushPixels += w * h;
+        tft.pushImage(x, y, w, h, data, transparent);
+    }
+    inline void PushSprite(TFT_eSprite &sprite, int32_t x, int32_t y)
+    {
+        RenderStats.PushCalls++;
+        RenderStats.PushPixels += sprite.width() * sprite.height();
+        sprite.pushSprite(x, y);
+    }
 }
\ No newline at end of file
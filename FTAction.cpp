@@ -7,6 +7,11 @@
 #include <cstdio>
 #include "ConfigLoad.h"
 #include "System.h"
+#include "RingQueue.h"
+#include "Input.h"
+#include "ActionBytecode.h"
+#include "KeyTable.h"
+#include "Trace.h"
 static const char *module = "FTAction";
 
 using namespace std;
@@ -15,11 +20,13 @@ static char printBuffer[201] = {0};
 
 namespace FreeTouchDeck
 {
-    const char *splitterFormat = "%[^.:,]%*s";
-    const char *separatorFormat = "%[ .:,]";
-    SemaphoreHandle_t xQueueSemaphore = xSemaphoreCreateMutex();
-    std::queue<FTAction *> Queue;
-    std::queue<FTAction *> ScreenQueue;
+    // Each queue is emptied by one task. Producers in other tasks are
+    // serialized by a short critical section, so each ring has one writer.
+    static portMUX_TYPE ActionQueueMux = portMUX_INITIALIZER_UNLOCKED;
+    static RingQueue<QueuedAction_t, ACTION_QUEUE_SIZE> Queues[(int)ActionLane::ENDLIST];
+    // Incremented when a lane is cancelled, tokens issued before are stale
+    static std::atomic<uint32_t> LaneEpochs[(int)ActionLane::ENDLIST];
+    static std::atomic<uint32_t> LaneCancelled[(int)ActionLane::ENDLIST];
     std::string emptyString;
     const char *unknown = "Unknown";
     const char *FTAction::JsonLabelType = "type";
@@ -31,6 +38,17 @@ namespace FreeTouchDeck
     {
         Type = ActionTypes::NONE;
     }
+    const char *enum_to_string(ActionLane lane)
+    {
+        switch (lane)
+        {
+            ENUM_TO_STRING_HELPER(ActionLane, NAVIGATION);
+            ENUM_TO_STRING_HELPER(ActionLane, SYSTEM);
+            ENUM_TO_STRING_HELPER(ActionLane, HID);
+        default:
+            return unknown;
+        }
+    }
     const char *enum_to_string(ActionTypes type)
     {
         switch (type)
@@ -43,43 +61,6 @@ namespace FreeTouchDeck
         }
     }
 
-#define KEY_TO_MAP(k)         \
-    {                         \
-        QUOTE(k), { KEY_##k } \
-    }
-#define MEDIAKEY_TO_MAP(k)                               \
-    {                                                    \
-        QUOTE(k), { KEY_MEDIA_##k[0], KEY_MEDIA_##k[1] } \
-    }
-#define START_END_KEY \
-    {                 \
-        "", { 0 }     \
-    }
-    const KeyMap_t NeedReleaseKeys{
-        {KEY_TO_MAP(LEFT_CTRL), KEY_TO_MAP(LEFT_SHIFT), KEY_TO_MAP(LEFT_ALT), KEY_TO_MAP(LEFT_GUI), KEY_TO_MAP(RIGHT_CTRL), KEY_TO_MAP(RIGHT_SHIFT), KEY_TO_MAP(RIGHT_ALT), KEY_TO_MAP(RIGHT_GUI)}};
-    const KeyMap_t NeedDoubleBytes{
-        {MEDIAKEY_TO_MAP(MUTE),
-         MEDIAKEY_TO_MAP(VOLUME_DOWN),
-         MEDIAKEY_TO_MAP(VOLUME_UP),
-         MEDIAKEY_TO_MAP(PLAY_PAUSE),
-         MEDIAKEY_TO_MAP(STOP),
-         MEDIAKEY_TO_MAP(NEXT_TRACK),
-         MEDIAKEY_TO_MAP(PREVIOUS_TRACK),
-         MEDIAKEY_TO_MAP(WWW_HOME),
-         MEDIAKEY_TO_MAP(LOCAL_MACHINE_BROWSER),
-         MEDIAKEY_TO_MAP(CALCULATOR),
-         MEDIAKEY_TO_MAP(WWW_BOOKMARKS),
-         MEDIAKEY_TO_MAP(WWW_SEARCH),
-         MEDIAKEY_TO_MAP(WWW_STOP),
-         MEDIAKEY_TO_MAP(WWW_BACK),
-         MEDIAKEY_TO_MAP(CONSUMER_CONTROL_CONFIGURATION),
-         MEDIAKEY_TO_MAP(EMAIL_READER)}};
-    const KeyMap_t KeyMap = {
-        {MEDIAKEY_TO_MAP(MUTE), MEDIAKEY_TO_MAP(VOLUME_DOWN), MEDIAKEY_TO_MAP(VOLUME_UP), MEDIAKEY_TO_MAP(PLAY_PAUSE), MEDIAKEY_TO_MAP(STOP), MEDIAKEY_TO_MAP(NEXT_TRACK), MEDIAKEY_TO_MAP(PREVIOUS_TRACK), MEDIAKEY_TO_MAP(WWW_HOME), MEDIAKEY_TO_MAP(LOCAL_MACHINE_BROWSER), MEDIAKEY_TO_MAP(CALCULATOR), MEDIAKEY_TO_MAP(WWW_BOOKMARKS), MEDIAKEY_TO_MAP(WWW_SEARCH), MEDIAKEY_TO_MAP(WWW_STOP), MEDIAKEY_TO_MAP(WWW_BACK), MEDIAKEY_TO_MAP(CONSUMER_CONTROL_CONFIGURATION), MEDIAKEY_TO_MAP(EMAIL_READER),
-         KEY_TO_MAP(F1), KEY_TO_MAP(F2), KEY_TO_MAP(F3), KEY_TO_MAP(F4), KEY_TO_MAP(F5), KEY_TO_MAP(F6), KEY_TO_MAP(F7), KEY_TO_MAP(F8), KEY_TO_MAP(F9), KEY_TO_MAP(F10), KEY_TO_MAP(F11), KEY_TO_MAP(F12), KEY_TO_MAP(F13), KEY_TO_MAP(F14), KEY_TO_MAP(F15), KEY_TO_MAP(F16), KEY_TO_MAP(F17), KEY_TO_MAP(F18), KEY_TO_MAP(F19), KEY_TO_MAP(F20), KEY_TO_MAP(F21), KEY_TO_MAP(F22), KEY_TO_MAP(F23), KEY_TO_MAP(F24),
-         KEY_TO_MAP(UP_ARROW), KEY_TO_MAP(DOWN_ARROW), KEY_TO_MAP(LEFT_ARROW), KEY_TO_MAP(RIGHT_ARROW), KEY_TO_MAP(BACKSPACE), KEY_TO_MAP(TAB), KEY_TO_MAP(RETURN), KEY_TO_MAP(PAGE_UP), KEY_TO_MAP(PAGE_DOWN), KEY_TO_MAP(DELETE),
-         KEY_TO_MAP(LEFT_CTRL), KEY_TO_MAP(LEFT_SHIFT), KEY_TO_MAP(LEFT_ALT), KEY_TO_MAP(LEFT_GUI), KEY_TO_MAP(RIGHT_CTRL), KEY_TO_MAP(RIGHT_SHIFT), KEY_TO_MAP(RIGHT_ALT), KEY_TO_MAP(RIGHT_GUI)}};
-
     FTAction::~FTAction()
     {
 
@@ -94,9 +75,9 @@ namespace FreeTouchDeck
     cJSON *KeyNamesJson()
     {
         cJSON *doc = cJSON_CreateArray();
-        for (auto k : KeyMap)
+        for (size_t i = 0; i < KeyTableSize; i++)
         {
-            cJSON_AddItemToArray(doc, cJSON_CreateString(k.first));
+            cJSON_AddItemToArray(doc, cJSON_CreateString(KeyTable[i].Name));
         }
         return doc;
     }
@@ -111,29 +92,10 @@ namespace FreeTouchDeck
         }
         else
         {
-            char *foundKey = NULL;
-            for (auto k : KeyMap)
+            found = FindKey(name) != NULL;
+            if (found && foundValue)
             {
-                if (strcmp(k.first, name) == 0)
-                {
-                    found = true;
-                    break;
-                }
-            }
-            if (found)
-            {
-                LOC_LOGD(module, "Found Key %s", foundKey);
-                if (foundValue)
-                {
-                    *foundValue = ps_strdup(name);
-                }
-                else
-                {
-                    // Caller did not request the resulting key
-                    // so free up memory
-                    LOC_LOGD(module, "Result key was not requested. Freeing up memory");
-                    FREE_AND_NULL(foundKey);
-                }
+                *foundValue = ps_strdup(name);
             }
         }
         LOC_LOGD(module, "Key %s was %s parsed.", STRING_OR_DEFAULT(name, ""), found ? "successfully" : "not");
@@ -154,18 +116,15 @@ namespace FreeTouchDeck
             delay = atol(GetParameter(1, parameters).c_str());
         }
 
-        for (auto k : KeyMap)
+        const KeyEntry_t *key = FindKey(tokenName);
+        if (key)
         {
-            if (strcmp(k.first, tokenName) == 0)
-            {
-                PrintMemInfo(__FUNCTION__, __LINE__);
-                LOC_LOGD(module, "Found Keyboard symbol %s, press delay %d ", tokenName, delay);
-                actions.push_back(new FTAction(k.first, k.second));
-                actions.back()->HoldTime = delay;
-                PrintMemInfo(__FUNCTION__, __LINE__);
-                success = true;
-                break;
-            }
+            PrintMemInfo(__FUNCTION__, __LINE__);
+            LOC_LOGD(module, "Found Keyboard symbol %s, press delay %d ", tokenName, delay);
+            actions.push_back(new FTAction(key->Name, KeyValue_t(key->Value, key->Value + key->Size)));
+            actions.back()->HoldTime = delay;
+            PrintMemInfo(__FUNCTION__, __LINE__);
+            success = true;
         }
         if (!success && delay > 0)
         {
@@ -258,76 +217,49 @@ namespace FreeTouchDeck
         return GetParameter(index, Parameters);
     }
 
+    const char *FTAction::NextParameter(const char *parmString, ParameterSlice_t &slice)
+    {
+        const char *p = parmString;
+        // a parameter runs up to the next separator, and the separators
+        // or spaces that follow it are skipped
+        if (!p || *p == '\0' || strchr(".:,", *p))
+        {
+            return NULL;
+        }
+        slice.Start = p;
+        while (*p != '\0' && !strchr(".:,", *p))
+        {
+            p++;
+        }
+        slice.Length = p - slice.Start;
+        while (*p != '\0' && strchr(" .:,", *p))
+        {
+            p++;
+        }
+        return p;
+    }
     bool FTAction::SplitParameters(const char *parmString, ParametersList_t &parameters)
     {
-        PrintMemInfo(__FUNCTION__, __LINE__);
-        char *token = ps_strdup(parmString);
-        char *separators = ps_strdup(parmString);
+        ParameterSlice_t slice;
         const char *p = parmString;
-        const char *s = parmString;
-        int res = 0;
-        int resSeparators = 0;
-        do
+        while ((p = NextParameter(p, slice)) != NULL)
         {
-            res = sscanf(p, splitterFormat, token);
-            if (res > 0)
-            {
-                p += strlen(token);
-                resSeparators = sscanf(p, separatorFormat, separators);
-                if (resSeparators > 0)
-                {
-                    p += strlen(separators);
-                }
-                else
-                {
-                    strcpy(separators, "");
-                }
-                LOC_LOGD(module, "Found parameter : %s", STRING_OR_DEFAULT(token, ""));
-                parameters.push_back(token);
-            }
-            else
-            {
-                break;
-            }
-        } while (p && *p);
-
-        FREE_AND_NULL(token);
-        FREE_AND_NULL(separators);
-        PrintMemInfo(__FUNCTION__, __LINE__);
+            LOC_LOGD(module, "Found parameter : %.*s", (int)slice.Length, slice.Start);
+            parameters.emplace_back(slice.Start, slice.Length);
+        }
         LOC_LOGV(module, "End of parameters list");
         return true;
     }
 
     bool FTAction::KeyNeedsRelease(const char *keyName)
     {
-        for (auto k : NeedReleaseKeys)
-        {
-            if (strcmp(k.first, keyName) == 0)
-            {
-                return true;
-            }
-        }
-        return false;
+        const KeyEntry_t *key = FindKey(keyName);
+        return key && key->NeedsRelease;
     }
     bool FTAction::KeyIsDoubleBytes(const char *keyName)
     {
-        for (auto k : NeedDoubleBytes)
-        {
-            if (strcmp(k.first, keyName) == 0)
-            {
-                return true;
-            }
-        }
-        return false;
-    }
-    bool checkForStop()
-    {
-        if (isTouched())
-        {
-            EmptyQueue();
-            return true;
-        }
-        return false;
+        const KeyEntry_t *key = FindKey(keyName);
+        return key && key->DoubleBytes;
     }
     FTAction::FTAction(const char *keyName, const KeyValue_t &values)
     {
@@ -342,8 +274,9 @@ namespace FreeTouchDeck
             LOC_LOGD(module, "New action with key names %s, length of %d", keyName, Values.size());
             Parameters.push_back(keyName);
             PrintMemInfo(__FUNCTION__, __LINE__);
-            NeedsRelease = KeyNeedsRelease(keyName);
-            NeedsDoubleBytes = KeyIsDoubleBytes(keyName);
+            const KeyEntry_t *key = FindKey(keyName);
+            NeedsRelease = key && key->NeedsRelease;
+            NeedsDoubleBytes = key && key->DoubleBytes;
         }
         PrintMemInfo(__FUNCTION__, __LINE__);
         Values = values;
@@ -360,68 +293,20 @@ namespace FreeTouchDeck
     }
     void FTAction::Execute()
     {
-        bool wasStopped = false;
-        MediaKeyReport MediaKey;
+        std::vector<uint8_t> code;
         LOC_LOGI(module, "Executing Action %s", toString());
-        if (checkForStop())
-        {
-            return;
-        }
         switch (Type)
         {
         case ActionTypes::NONE:
             break;
         case ActionTypes::KEYBOARD:
-            if (!bleKeyboard.isConnected())
-            {
-                LOC_LOGW(module, "Skipping action %s. Bluetooth Keyboard not connected", toString());
-                return;
-            }
-            if (NeedsDoubleBytes)
-            {
-                MediaKey[0] = Values[0];
-                MediaKey[1] = Values[1];
-                if (NeedsRelease)
-                {
-                    bleKeyboard.press(MediaKey);
-                }
-                else
-                {
-                    bleKeyboard.write(MediaKey);
-                }
-                delay(generalconfig.keyDelay);
-            }
-            else
+            // keyboard actions of sequences are compiled when parsed, others on the fly
+            CompileKeyboardAction(this, code);
+            for (size_t pos = 0; pos < code.size(); pos += ActionOpSize(code.data() + pos))
             {
-                if (NeedsRelease)
-                {
-                    for (auto ks : Values)
-                    {
-                        // Use keyboard press for each character
-                        // as this method does not release each key
-                        // individually
-                        bleKeyboard.press(ks);
-                        delay(generalconfig.keyDelay);
-                        wasStopped=checkForStop();
-                        if(wasStopped) break;
-                        
-                    }
-                }
-                else
+                if (!RunKeyboardOp(code.data() + pos, GetCancelToken(ActionLane::HID)))
                 {
-                    for (auto ks : Values)
-                    {
-                        if (HoldTime > 0)
-                        {
-                            LOC_LOGI(module, "Pressing key with hold of %d ms", HoldTime);
-                        }
-                        bleKeyboard.press(ks);
-                        delay(HoldTime);
-                        bleKeyboard.release(ks);
-                        delay(generalconfig.keyDelay);
-                        wasStopped=checkForStop();
-                        if(wasStopped) break;
-                    }
+                    break;
                 }
             }
             break;
@@ -430,11 +315,6 @@ namespace FreeTouchDeck
         default:
             break;
         }
-        if (wasStopped && NeedsRelease)
-        {
-            LOC_LOGI(module,"Releasing all keys");
-            bleKeyboard.releaseAll();
-        }
     }
 
     const char *FTAction::toString()
@@ -458,156 +338,159 @@ namespace FreeTouchDeck
         return printBuffer;
     }
 
-    FTAction *PopScreenQueue()
+    CancelToken_t GetCancelToken(ActionLane lane)
+    {
+        return {lane, LaneEpochs[(int)lane].load()};
+    }
+    bool IsCancelled(const CancelToken_t &token)
+    {
+        return LaneEpochs[(int)token.Lane].load() != token.Epoch;
+    }
+    void CancelLane(ActionLane lane)
     {
-        FTAction *Action = NULL;
-        if (QueueLock(portMAX_DELAY / portTICK_PERIOD_MS))
+        LaneEpochs[(int)lane]++;
+        LOC_LOGD(module, "Cancelled actions of the %s lane", enum_to_string(lane));
+        // lets the keyboard task release the keys held by the cancelled sequences
+        Queues[(int)lane].Wake();
+    }
+    // Pops the next entry that wasn't cancelled
+    static bool PopLane(ActionLane lane, QueuedAction_t &queued, TickType_t xTicksToWait)
+    {
+        RingQueue<QueuedAction_t, ACTION_QUEUE_SIZE> &queue = Queues[(int)lane];
+        while (queue.Pop(queued, xTicksToWait))
         {
-            if (!ScreenQueue.empty())
+            TraceAction(TraceEvent::DEQUEUE, queued.Action, queued.Op, micros());
+            if (!IsCancelled(queued.Token))
             {
-                LOC_LOGV(module, "Screen Action Queue Length : %d", ScreenQueue.size());
-                Action = ScreenQueue.front();
-                ScreenQueue.pop();
-                LOC_LOGV(module, "Screen Action Queue Length : %d", ScreenQueue.size());
+                LOC_LOGV(module, "%s Action Queue Length : %d", enum_to_string(lane), queue.Count());
+                return true;
             }
-            QueueUnlock();
+            LaneCancelled[(int)lane]++;
+            xTicksToWait = 0;
         }
-        else
+        return false;
+    }
+    FTAction *PopScreenQueue()
+    {
+        QueuedAction_t queued = {NULL, NULL, 0};
+        if (PopLane(ActionLane::NAVIGATION, queued, 0) || PopLane(ActionLane::SYSTEM, queued, 0))
         {
-            LOC_LOGE(module, "Unable to screen lock Action queue");
+            return queued.Action;
         }
-        return Action;
+        return NULL;
     }
-    void EmptyQueue()
+    bool ScreenQueuePending()
     {
-        if (QueueLock(portMAX_DELAY / portTICK_PERIOD_MS))
+        return !Queues[(int)ActionLane::NAVIGATION].Empty() || !Queues[(int)ActionLane::SYSTEM].Empty();
+    }
+    size_t QueueSize()
+    {
+        size_t size = 0;
+        for (auto &queue : Queues)
         {
-            while (!Queue.empty())
-            {
-                Queue.pop();
-            }
-            QueueUnlock();
+            size += queue.Count();
         }
+        return size;
     }
-    size_t QueueSize()
+    bool PopQueue(QueuedAction_t &queued, TickType_t xTicksToWait)
     {
-        return Queue.size() + ScreenQueue.size();
+        return PopLane(ActionLane::HID, queued, xTicksToWait);
     }
-    FTAction *PopQueue()
+    ActionQueueStats_t GetActionQueueStats(ActionLane lane)
     {
-        FTAction *Action = NULL;
-
-        if (QueueLock(portMAX_DELAY / portTICK_PERIOD_MS))
+        RingQueue<QueuedAction_t, ACTION_QUEUE_SIZE> &queue = Queues[(int)lane];
+        ActionQueueStats_t stats;
+        stats.Depth = queue.Count();
+        stats.HighWater = queue.HighWaterMark();
+        stats.Overflows = queue.OverflowCount();
+        stats.Cancelled = LaneCancelled[(int)lane].load();
+        stats.Capacity = queue.Capacity();
+        return stats;
+    }
+    static bool PushLane(ActionLane lane, QueuedAction_t &queued)
+    {
+        bool result = false;
+        portENTER_CRITICAL(&ActionQueueMux);
+        result = Queues[(int)lane].TryPush(queued);
+        portEXIT_CRITICAL(&ActionQueueMux);
+        if (result)
         {
-            if (!Queue.empty())
+            TraceAction(TraceEvent::ENQUEUE, queued.Action, queued.Op, queued.QueuedTime);
+            // waking the consumer may switch tasks, which isn't allowed in the critical section.
+            // The screen task waits for touch events and both of its lanes at once
+            if (lane == ActionLane::HID)
             {
-                LOC_LOGV(module, "Action Queue Length : %d", Queue.size());
-                Action = Queue.front();
-                Queue.pop();
-                LOC_LOGV(module, "Action Queue Length : %d", Queue.size());
+                Queues[(int)lane].Wake();
+            }
+            else
+            {
+                InputWake();
             }
-            QueueUnlock();
-        }
-        else
-        {
-            LOC_LOGE(module, "Unable to lock Action queue");
         }
-        return Action;
+        return result;
     }
-    bool QueueLock(TickType_t xTicksToWait)
+    bool QueueAction(FTAction *action, const CancelToken_t *token)
     {
-        LOC_LOGV(module, "Locking Action Queue object");
-        if (xSemaphoreTake(xQueueSemaphore, xTicksToWait) == pdTRUE)
+        ActionLane lane = action->GetLane();
+        QueuedAction_t queued = {action, NULL, (uint32_t)micros(), token && token->Lane == lane ? *token : GetCancelToken(lane)};
+        if (!PushLane(lane, queued))
         {
-            LOC_LOGV(module, "Action Queue object  locked!");
-            return true;
-        }
-        else
-        {
-            LOC_LOGE(module, "Unable to lock the Action queue object");
+            LOC_LOGE(module, "%s queue is full. Dropping action %s", enum_to_string(lane), action->toString());
             return false;
         }
+        LOC_LOGD(module, "Pushed action %s to %s queue", action->toString(), enum_to_string(lane));
+        return true;
     }
 
-    void QueueUnlock()
+    bool QueueKeyboardOp(const uint8_t *op, const CancelToken_t &token)
     {
-        LOC_LOGV(module, "Unlocking the Action queue object");
-        xSemaphoreGive(xQueueSemaphore);
-    }
-    bool QueueAction(FTAction *action)
-    {
-        if (!QueueLock(100 / portTICK_PERIOD_MS))
+        QueuedAction_t queued = {NULL, op, (uint32_t)micros(), token};
+        if (!PushLane(ActionLane::HID, queued))
         {
-            LOC_LOGE(module, "Unable to queue new action ");
+            LOC_LOGE(module, "Keyboard queue is full. Dropping %s instruction", enum_to_string((ActionOp)op[0]));
             return false;
         }
-        if (action->IsScreen())
-        {
-            LOC_LOGD(module, "Pushing action %s to screen queue", action->toString());
-            ScreenQueue.push(action);
-        }
-        else
-        {
-            LOC_LOGD(module, "Pushing action %s to keyboard queue", action->toString());
-            Queue.push(action);
-        }
-
-        QueueUnlock();
         return true;
     }
-
-    bool FTAction::CallActionCallback(ParametersList_t &parameters, FTAction *action, bool checkOnly)
+    bool QueueButtonRepeat()
     {
-        ActionCallbackFn_t callbackFn = NULL;
-        PrintMemInfo(__FUNCTION__, __LINE__);
-        std::string name = GetParameter(0, parameters);
-        auto callback = FreeTouchDeck::UserActions.find(name.c_str());
+        QueuedAction_t queued = {NULL, NULL, (uint32_t)micros(), GetCancelToken(ActionLane::HID)};
+        return PushLane(ActionLane::HID, queued);
+    }
+    const ActionCallbackFn_t *FTAction::FindCallback(const std::string &name)
+    {
+        auto callback = FreeTouchDeck::UserActions.find(name);
         if (callback == FreeTouchDeck::UserActions.end())
         {
-            LOC_LOGW(module, "Find failed. Trying to iterate entries");
+            LOC_LOGE(module, "Invalid callback name %s. Valid callbacks are: ", name.c_str());
             for (auto c : FreeTouchDeck::UserActions)
             {
-                if (c.first == name)
-                {
-                    callbackFn = c.second;
-                    LOC_LOGD(module, "Found the callback with a loop in the map values");
-                    break;
-                }
+                LOC_LOGE(module, "    %s", c.first.c_str());
             }
+            return NULL;
         }
-        else
+        LOC_LOGD(module, "Found the callback in the map");
+        return &callback->second;
+    }
+    bool FTAction::CallActionCallback(ParametersList_t &parameters, FTAction *action, bool checkOnly)
+    {
+        PrintMemInfo(__FUNCTION__, __LINE__);
+        const ActionCallbackFn_t *callbackFn = FindCallback(GetParameter(0, parameters));
+        if (!callbackFn)
         {
-            LOC_LOGD(module, "Found the callback in the map");
-            callbackFn = callback->second;
+            return false;
         }
-        if (callbackFn)
+        if (checkOnly)
         {
-            if (checkOnly)
-            {
-                LOC_LOGD(module, "Check only, returning success");
-                return true;
-            }
-            else if (!action)
-            {
-                LOC_LOGE(module, "Action pointer is null. Unable to invoke callback!");
-            }
-            else
-            {
-                LOC_LOGD(module, "Calling function %s", name.c_str());
-                bool res = callbackFn(action);
-                PrintMemInfo(__FUNCTION__, __LINE__);
-                return res;
-            }
+            LOC_LOGD(module, "Check only, returning success");
+            return true;
         }
-        else
+        if (!action)
         {
-            LOC_LOGE(module, "Invalid callback name %s. Valid callbacks are: ", name.c_str());
-            for (auto c : FreeTouchDeck::UserActions)
-            {
-                LOC_LOGE(module, "    %s", c.first.c_str());
-            }
+            LOC_LOGE(module, "Action pointer is null. Unable to invoke callback!");
+            return false;
         }
-        return false;
+        return (*callbackFn)(action);
     }
     bool FTAction::IsActionCallback(ParametersList_t &parameters)
     {
@@ -615,7 +498,23 @@ namespace FreeTouchDeck
     }
     bool FTAction::CallActionCallback(bool checkOnly)
     {
-        return CallActionCallback(Parameters, this, checkOnly);
+        // the map lookup is only done once per action
+        if (!Callback)
+        {
+            Callback = FindCallback(ActionNameStr());
+        }
+        if (!Callback)
+        {
+            return false;
+        }
+        if (checkOnly)
+        {
+            return true;
+        }
+        LOC_LOGD(module, "Calling function %s", ActionName());
+        bool res = (*Callback)(this);
+        PrintMemInfo(__FUNCTION__, __LINE__);
+        return res;
     }
     cJSON *UserActionsJson()
     {
@@ -6,6 +6,23 @@ namespace FreeTouchDeck
     class FTAction;
     class ActionsSequences;
 
+    // Queues actions are run from. Keyboard instructions and the local actions that
+    // must run between them use the HID lane, others run from the screen task, where
+    // menu changes go before other actions.
+    enum class ActionLane : uint8_t
+    {
+        NAVIGATION = 0,
+        SYSTEM,
+        HID,
+        ENDLIST
+    };
+    const char *enum_to_string(ActionLane lane);
+    // Issued when a sequence is queued, its entries are skipped once the lane is cancelled
+    typedef struct
+    {
+        ActionLane Lane;
+        uint32_t Epoch;
+    } CancelToken_t;
     enum class ActionTypes
     {
         NONE = 0,
@@ -22,11 +39,17 @@ namespace FreeTouchDeck
     }
     const char *enum_to_string(ActionTypes type);
     typedef std::vector<uint8_t> KeyValue_t;
-    typedef std::map<const char *, KeyValue_t> KeyMap_t;
     typedef std::vector<FTAction *> ActionsList;
     typedef std::vector<std::string> ParametersList_t;
     typedef std::vector<std::string> ActionQueueType_t;
     extern ActionQueueType_t UserActionsKeyboardQueue;
+    typedef std::function<bool(FTAction *)> ActionCallbackFn_t;
+    // Parameter found in a token, pointing into the token text
+    typedef struct
+    {
+        const char *Start;
+        size_t Length;
+    } ParameterSlice_t;
     class FTAction
     {
     public:
@@ -34,6 +57,10 @@ namespace FreeTouchDeck
         bool NeedsRelease;
         bool NeedsDoubleBytes;
         uint16_t HoldTime=0;
+        // delay between keys for this action, generalconfig.keyDelay when negative
+        int32_t KeyDelay=-1;
+        // characters are packed in as few HID reports as possible
+        bool Batched=false;
         KeyValue_t Values;
         ParametersList_t Parameters;
         static const char *JsonLabelType;
@@ -45,6 +72,15 @@ namespace FreeTouchDeck
         FTAction(const char *keyName, const KeyValue_t &values);
         FTAction(const KeyValue_t &values);
         static bool SplitParameters(const char *parmString, ParametersList_t &parameters);
+        /**
+* @brief Finds the next parameter of a token, without copying it.
+*
+* @param parmString const char * position in the token, e.g. "MENU:home"
+* @param slice ParameterSlice_t & receives the parameter
+*
+* @return const char * position of the following parameter, NULL when no parameter was found
+*/
+        static const char *NextParameter(const char *parmString, ParameterSlice_t &slice);
         static void InitConstants();
         void ParseModifierKey(char *modifier);
         ~FTAction();
@@ -71,37 +107,103 @@ namespace FreeTouchDeck
         static bool SplitActionParameter(const char *value, char *name, size_t nameSize, char *parameter, size_t parameterSize);
         inline bool IsScreen()
         {
-            bool KeyboardLocalAction=false;
-            for(const std::string &e : UserActionsKeyboardQueue)
+            if (Screen < 0)
             {
-                if(e==ActionNameStr())
+                bool KeyboardLocalAction=false;
+                for(const std::string &e : UserActionsKeyboardQueue)
                 {
-                    KeyboardLocalAction=true;
-                    break;
+                    if(e==ActionNameStr())
+                    {
+                        KeyboardLocalAction=true;
+                        break;
+                    }
                 }
+                // Screen queue if not Keyboard event and acction name not in the Keyboard queue list
+                Screen = Type != ActionTypes::KEYBOARD && !KeyboardLocalAction;
             }
-
-            // Screen queue if not Keyboard event and acction name not in the Keyboard queue list
-            return  Type != ActionTypes::KEYBOARD && !KeyboardLocalAction;
+            return Screen;
+        }
+        inline ActionLane GetLane()
+        {
+            if (!IsScreen())
+            {
+                return ActionLane::HID;
+            }
+            return ActionNameStr() == "MENU" ? ActionLane::NAVIGATION : ActionLane::SYSTEM;
         }
         static FTAction rebootSystem;
         bool CallActionCallback(bool checkOnly = false);
         static bool CallActionCallback(ParametersList_t &parameters, FTAction *action, bool checkOnly);
         static bool IsActionCallback(ParametersList_t &parameters);
         static bool Stopped;
+    private:
+        // resolved on first use, the user actions may not be initialized when actions are constructed
+        int8_t Screen = -1;
+        const ActionCallbackFn_t *Callback = NULL;
+        static const ActionCallbackFn_t *FindCallback(const std::string &name);
     };
 
-    typedef std::function<bool(FTAction *)> ActionCallbackFn_t;
     typedef std::map<std::string, ActionCallbackFn_t> ActionCallbackMap_t;
     extern const ActionCallbackMap_t UserActions;
-    extern bool QueueAction(FTAction *action);
-    extern FTAction *PopQueue();
-    void EmptyQueue();
+    typedef struct
+    {
+        size_t Depth;
+        size_t HighWater;
+        uint32_t Overflows;
+        uint32_t Cancelled;
+        size_t Capacity;
+    } ActionQueueStats_t;
+    // Entry of the action queues: an action, a compiled keyboard instruction,
+    // or neither, to repeat the actions of the held button
+    typedef struct
+    {
+        FTAction *Action;
+        const uint8_t *Op;
+        uint32_t QueuedTime;
+        CancelToken_t Token;
+    } QueuedAction_t;
+    /**
+* @brief Queues an action in the queue of its lane.
+*
+* @param action FTAction * action to run
+* @param token const CancelToken_t * token of the sequence the action is part of,
+*        a new token is issued when NULL or for another lane
+*
+* @return bool false when the queue is full
+*/
+    extern bool QueueAction(FTAction *action, const CancelToken_t *token = NULL);
+    extern bool QueueKeyboardOp(const uint8_t *op, const CancelToken_t &token);
+    // Asks the keyboard queue's task to repeat the actions of the held button
+    extern bool QueueButtonRepeat();
+    CancelToken_t GetCancelToken(ActionLane lane);
+    // true once the lane was cancelled after the token was issued
+    bool IsCancelled(const CancelToken_t &token);
+    /**
+* @brief Cancels what was queued in a lane. Queued entries are dropped and
+*        a running keyboard instruction stops after its current key. Held
+*        keys are released.
+*/
+    void CancelLane(ActionLane lane);
+    /**
+* @brief Removes the next entry from the keyboard queue.
+*
+* @param queued QueuedAction_t & receives the entry, with the time it was queued at in microseconds
+* @param xTicksToWait TickType_t time to wait for an entry when the queue is empty
+*
+* @return bool true when an entry was removed
+*
+* @note Must always be called from the same task
+*/
+    extern bool PopQueue(QueuedAction_t &queued, TickType_t xTicksToWait = 0);
     cJSON * UserActionsJson();
     cJSON *KeyNamesJson();
     size_t QueueSize();
-    extern bool QueueLock(TickType_t xTicksToWait);
-    extern void QueueUnlock();
+    ActionQueueStats_t GetActionQueueStats(ActionLane lane);
+    // Same as PopQueue, for actions run by the screen handling task. Menu changes
+    // are returned first, and cancelled actions are skipped. Doesn't wait: the
+    // screen task waits in InputWait, which returns when an action is queued
     extern FTAction *PopScreenQueue();
+    // true when actions wait in the lanes of the screen handling task
+    bool ScreenQueuePending();
 
 }
\ No newline at end of file
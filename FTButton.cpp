@@ -4,6 +4,9 @@
 #include "WString.h"
 #include "ImageCache.h"
 #include "System.h"
+#include "esp_timer.h"
+#include "MenuNavigation.h"
+#include <atomic>
 static const char *module = "FTButton";
 
 namespace FreeTouchDeck
@@ -30,11 +33,25 @@ namespace FreeTouchDeck
     const char *FTButton::JsonLabelBackground = "backgroundcolor";
     const char *FTButton::JsonLabelTextColor = "textcolor";
     const char *FTButton::JsonLabelTextSize = "textsize";
+    const char *FTButton::JsonLabelRepeatDelay = "repeatdelay";
+    const char *FTButton::JsonLabelRepeatInterval = "repeatinterval";
+    const char *FTButton::JsonLabelRepeatAcceleration = "repeatacceleration";
     const char *FTButton::homeButtonTemplate = R"({ "label":"Home",  "logo":"home.jpg","actions": ["{MENU:home}"] })";
     const char *FTButton::backButtonTemplate = R"({"label": "Back","logo": "arrow_back.jpg","actions": ["{MENU:~BACK}"]})";
     FTButton FTButton::EmptyButton;
     FTButton *FTButton::BackButton = NULL;
     FTButton *FTButton::HomeButton = NULL;
+    // A single button can be held at a time. It is repeated by a high
+    // resolution timer, whose callback only asks the action task to run
+    // the button's actions.
+    static esp_timer_handle_t RepeatTimer = NULL;
+    static std::atomic<FTButton *> RepeatButton{NULL};
+    // keeps a tick from restarting the timer once the repeat was stopped
+    static portMUX_TYPE RepeatMux = portMUX_INITIALIZER_UNLOCKED;
+    // next repeat and current interval, in microseconds
+    static int64_t RepeatDeadline = 0;
+    static int64_t RepeatPeriod = 0;
+    static uint8_t RepeatAccelerationPct = 0;
     void FTButton::InitConstants()
     {
         LOC_LOGD(module, "Initializing buttons constants");
@@ -115,6 +132,30 @@ namespace FreeTouchDeck
         }
         return image;
     }
+    void FTButton::GetImageNames(std::vector<std::string> &names)
+    {
+        if (!_jsonLogo.empty())
+        {
+            names.push_back(_jsonLogo);
+        }
+        if (ButtonType == ButtonTypes::LATCH && !_jsonLatchedLogo.empty())
+        {
+            names.push_back(_jsonLatchedLogo);
+        }
+    }
+    void FTButton::GetMenuTargets(std::vector<std::string> &names)
+    {
+        for (auto &sequence : Sequences)
+        {
+            for (FTAction *action : sequence.Actions)
+            {
+                if (action->Type == ActionTypes::LOCAL && strcmp(action->ActionName(), "MENU") == 0)
+                {
+                    names.push_back(action->FirstParameterStr());
+                }
+            }
+        }
+    }
     bool FTButton::Latch(FTAction *action)
     {
         LOC_LOGV(module, "Button is Executing Action %s", action->toString());
@@ -192,6 +233,35 @@ namespace FreeTouchDeck
         NeedsDraw = true;
         NeedsDrawImage = !IsLabel;
     }
+    bool FTButton::IsDirty()
+    {
+        return NeedsDraw || NeedsDrawImage || NeedsDrawOutline;
+    }
+    uint16_t FTButton::GetBackgroundColor(ImageWrapper *image)
+    {
+        uint16_t BGColor = TFT_BLACK;
+        if (IsLabel || image->GetPixelColor() == TFT_BLACK)
+        {
+            // transparent images are drawn over the default background color
+            BGColor = convertRGB888ToRGB565(IsMenu() ? generalconfig.functionButtonColour : BackgroundColor);
+        }
+        else
+        {
+            // Draw the button with found image's background color
+            BGColor = convertRGB888ToRGB565(image->GetPixelColor());
+        }
+        if (!bleKeyboard.isConnected() && HasKeyboardActions())
+        {
+            BGColor = TFT_DARKGREY;
+        }
+        return BGColor;
+    }
+    void FTButton::DrawOutline(TFT_eSPI &canvas, int16_t x, int16_t y, uint16_t BGColor)
+    {
+        uint8_t r = min(ButtonWidth, ButtonHeight) / 4; // Corner radius
+        NeedsDrawOutline = false;
+        canvas.drawRoundRect(x + 2, y + 2, ButtonWidth - 4, ButtonHeight - 4, r, IsPressed ? Outline : BGColor);
+    }
     ImageWrapper *FTButton::GetActiveImage()
     {
         if (Latched && LatchedLogo()->valid)
@@ -202,14 +272,19 @@ namespace FreeTouchDeck
     }
     void FTButton::DrawShape(bool force)
     {
-        bool transparent = false;
-        int32_t radius = 4;
-        uint8_t textSize = TextSize;
-        uint16_t BGColor = TFT_BLACK;
         if (!NeedsDraw && !force)
             return;
 
         NeedsDraw = false;
+        DrawShape(tft, X, Y);
+    }
+    void FTButton::DrawShape(TFT_eSPI &canvas, int16_t x, int16_t y)
+    {
+        int32_t radius = 4;
+        uint8_t textSize = TextSize;
+        uint16_t BGColor = TFT_BLACK;
+        int16_t centerX = x + (CenterX - X);
+        int16_t centerY = y + (CenterY - Y);
         const char *buttonLabel = "";
         LOC_LOGV(module, "Getting active image for button");
         auto image = GetActiveImage();
@@ -239,84 +314,119 @@ namespace FreeTouchDeck
                 }
             }
             LOC_LOGD(module, "Label draw of button [%s] [%d pixels]", buttonLabel, ButtonWidth);
-            BGColor = convertRGB888ToRGB565(IsMenu()?generalconfig.functionButtonColour:BackgroundColor);
         }
         else
         {
             LOC_LOGD(module, "Image draw of button %s", image->LogoName.c_str());
-            uint16_t ImagePixelColor = image->GetPixelColor();
-            if (ImagePixelColor == TFT_BLACK)
-            {
-                LOC_LOGV(module, "Corner pixel is black, drawing transparent with default background color");
-                transparent = true;
-                BGColor = convertRGB888ToRGB565(IsMenu()?generalconfig.functionButtonColour:BackgroundColor);
-            }
-            else
-            {
-                // Draw the button with found image's background color
-                BGColor = convertRGB888ToRGB565(ImagePixelColor);
-            }
         }
+        BGColor = GetBackgroundColor(image);
 
         LOC_LOGD(module, "Drawing button at [%d,%d] size: %dx%d,  outline : 0x%04X, BG Color: 0x%04X, Text color: 0x%04X, Text size: %d, logo: %s", CenterX, CenterY, AdjustedWidth, AdjustedHeight, Outline, BGColor, TextColor, TextSize, _jsonLogo.c_str());
         PrintMemInfo(__FUNCTION__, __LINE__);
 
         uint8_t r = min(ButtonWidth, ButtonHeight) / 4; // Corner radius
 
-        if (!bleKeyboard.isConnected() && HasKeyboardActions())
-        {
-            BGColor = TFT_DARKGREY;
-        }
         if (BGColor != MenuBackgroundColor)
         {
-            tft.fillRoundRect(X, Y, ButtonWidth, ButtonHeight, r, BGColor);
-        }
-        tft.drawRoundRect(X, Y, ButtonWidth, ButtonHeight, r, Outline);
-        if (IsPressed)
-        {
-            tft.drawRoundRect(X + 2, Y + 2, ButtonWidth - 4, ButtonHeight - 4, r, Outline);
-        }
-        else
-        {
-            tft.drawRoundRect(X + 2, Y + 2, ButtonWidth - 4, ButtonHeight - 4, r, BGColor);
+            canvas.fillRoundRect(x, y, ButtonWidth, ButtonHeight, r, BGColor);
         }
+        canvas.drawRoundRect(x, y, ButtonWidth, ButtonHeight, r, Outline);
+        DrawOutline(canvas, x, y, BGColor);
 
         if (ButtonType == ButtonTypes::LATCH && !LatchedLogo()->valid)
         {
             // Draw a rounded rectangle in the button corner
             uint32_t roundRectWidth = ButtonWidth / 4;
             uint32_t roundRectHeight = ButtonHeight / 4;
-            uint32_t cornerX = CenterX - (AdjustedWidth / 2) + roundRectWidth / 2;
-            uint32_t cornerY = CenterY - (AdjustedHeight / 2) + roundRectHeight / 2;
+            uint32_t cornerX = centerX - (AdjustedWidth / 2) + roundRectWidth / 2;
+            uint32_t cornerY = centerY - (AdjustedHeight / 2) + roundRectHeight / 2;
             if (Latched)
             {
                 LOC_LOGD(module, "LATCH Marker for %s",buttonLabel);
-                tft.fillRoundRect(cornerX, cornerY, roundRectWidth, roundRectHeight, radius, generalconfig.latchedColour);
+                canvas.fillRoundRect(cornerX, cornerY, roundRectWidth, roundRectHeight, radius, generalconfig.latchedColour);
             }
             else
             {
                 LOC_LOGD(module, "UNLATCH Marker for %s",buttonLabel);
-                tft.fillRoundRect(cornerX, cornerY, roundRectWidth, roundRectHeight, radius, BGColor);
+                canvas.fillRoundRect(cornerX, cornerY, roundRectWidth, roundRectHeight, radius, BGColor);
             }
         }
 
         if (IsLabel)
         {
-            tft.setTextColor(convertRGB888ToRGB565(TextColor), BGColor);
-            tft.setTextSize(TextSize);
-            uint8_t tempdatum = tft.getTextDatum();
-            tft.setTextDatum(MC_DATUM);
-            uint16_t tempPadding = tft.getTextPadding();
-            tft.setTextPadding(0);
-            tft.drawString(buttonLabel, CenterX, CenterY);
-            tft.setTextDatum(tempdatum);
-            tft.setTextPadding(tempPadding);
+            if (&canvas != &tft)
+            {
+                // the font was selected on the screen while measuring the label
+                canvas.setFreeFont(GetCurrentFont());
+            }
+            canvas.setTextColor(convertRGB888ToRGB565(TextColor), BGColor);
+            canvas.setTextSize(TextSize);
+            uint8_t tempdatum = canvas.getTextDatum();
+            canvas.setTextDatum(MC_DATUM);
+            uint16_t tempPadding = canvas.getTextPadding();
+            canvas.setTextPadding(0);
+            canvas.drawString(buttonLabel, centerX, centerY);
+            canvas.setTextDatum(tempdatum);
+            canvas.setTextPadding(tempPadding);
+        }
+    }
+#ifdef BUTTON_SPRITE_DRAW
+    TFT_eSprite *FTButton::Canvas = NULL;
+    TFT_eSprite *FTButton::GetCanvas()
+    {
+        size_t canvasSize = (size_t)ButtonWidth * ButtonHeight * sizeof(uint16_t);
+        if (!Canvas)
+        {
+            Canvas = new TFT_eSprite(&tft);
+            Canvas->setColorDepth(16);
+        }
+        if (Canvas->created() && Canvas->width() == ButtonWidth && Canvas->height() == ButtonHeight)
+        {
+            return Canvas;
+        }
+        Canvas->deleteSprite();
+#if defined(ESP32) && defined(CONFIG_SPIRAM_SUPPORT)
+        bool psramSupported = psramFound();
+#else
+        bool psramSupported = false;
+#endif
+        if (!psramSupported && heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) < canvasSize + BUTTON_SPRITE_MIN_FREE_RAM)
+        {
+            LOC_LOGD(module, "Not enough memory for a %dx%d button buffer. Drawing directly on screen", ButtonWidth, ButtonHeight);
+            return NULL;
+        }
+        // the sprite is placed in PSRAM when available
+        if (!Canvas->createSprite(ButtonWidth, ButtonHeight))
+        {
+            LOC_LOGW(module, "Unable to allocate a %dx%d button buffer. Drawing directly on screen", ButtonWidth, ButtonHeight);
+            return NULL;
+        }
+        return Canvas;
+    }
+    bool FTButton::DrawCanvas()
+    {
+        TFT_eSprite *canvas = GetCanvas();
+        if (!canvas)
+        {
+            return false;
+        }
+        auto image = GetActiveImage();
+        canvas->fillSprite(MenuBackgroundColor);
+        DrawShape(*canvas, 0, 0);
+        if (!IsLabel && image->valid && !image->DrawTo(*canvas, ButtonWidth / 2, ButtonHeight / 2, image->GetPixelColor() == TFT_BLACK))
+        {
+            LOC_LOGD(module, "Image %s isn't in memory. Drawing directly on screen", image->LogoName.c_str());
+            return false;
         }
+        PushSprite(*canvas, X, Y);
+        NeedsDraw = false;
+        NeedsDrawImage = false;
+        NeedsDrawOutline = false;
+        return true;
     }
+#endif
     void FTButton::DrawImage(bool force)
     {
-        bool transparent = false;
-        uint16_t BGColor = TFT_BLACK;
         if (!NeedsDrawImage && !force)
             return;
         NeedsDrawImage = false;
@@ -333,22 +443,73 @@ namespace FreeTouchDeck
             return;
         }
         LOC_LOGV(module, "Image draw of button %s", image->LogoName.c_str());
-        uint16_t ImagePixelColor = image->GetPixelColor();
-        if (ImagePixelColor == TFT_BLACK)
+        // a black corner pixel lets the button's background show through,
+        // DrawShape already filled it with the matching color
+        bool transparent = image->GetPixelColor() == TFT_BLACK;
+        uint8_t scale = ImageWrapper::ScaleToFit(image->w, image->h, ButtonWidth, ButtonHeight);
+        if (scale > 1 && DrawScaledImage(image, scale, transparent))
+        {
+            return;
+        }
+        image->Draw(CenterX, CenterY, transparent);
+    }
+    bool FTButton::DrawScaledImage(ImageWrapper *image, uint8_t scale, bool transparent)
+    {
+        uint16_t width = 0;
+        uint16_t height = 0;
+        bool kept = true;
+        // large images are decoded at the button's resolution, once while the
+        // pixel cache holds them. The lock keeps them from being evicted
+        if (!ImageCache::Lock())
+        {
+            return false;
+        }
+        LOC_LOGD(module, "Drawing image %s at 1/%d scale", image->LogoName.c_str(), scale);
+        uint16_t *pixels = ImageCache::GetScaledPixels(image, scale, &width, &height);
+        if (!pixels)
+        {
+            // decoding may wait for the jpg decoder, other tasks use the cache meanwhile
+            ImageCache::Unlock();
+            pixels = image->DecodeToBuffer(scale, &width, &height);
+            if (!pixels || !ImageCache::Lock())
+            {
+                FREE_AND_NULL(pixels);
+                return false;
+            }
+            kept = ImageCache::KeepScaledPixels(image, scale, pixels, width, height);
+        }
+        bool oldSwapBytes = tft.getSwapBytes();
+        tft.setSwapBytes(true);
+        if (transparent)
         {
-            LOC_LOGV(module, "Corner pixel is black, drawing transparent with default background color");
-            transparent = true;
-            BGColor = convertRGB888ToRGB565(BackgroundColor);
+            PushImage(CenterX - width / 2, CenterY - height / 2, width, height, pixels, image->GetPixelColor());
         }
         else
         {
-            // Draw the button with found image's background color
-            BGColor = convertRGB888ToRGB565(ImagePixelColor);
+            PushImage(CenterX - width / 2, CenterY - height / 2, width, height, pixels);
         }
-        image->Draw(CenterX, CenterY, transparent);
+        tft.setSwapBytes(oldSwapBytes);
+        if (!kept)
+        {
+            FREE_AND_NULL(pixels);
+        }
+        ImageCache::Unlock();
+        return true;
     }
     void FTButton::Draw(bool force)
     {
+        if (!force && !NeedsDraw && !NeedsDrawImage && NeedsDrawOutline)
+        {
+            // press and release only change the highlight
+            DrawOutline(tft, X, Y, GetBackgroundColor(GetActiveImage()));
+            return;
+        }
+#ifdef BUTTON_SPRITE_DRAW
+        if ((force || NeedsDraw) && DrawCanvas())
+        {
+            return;
+        }
+#endif
         DrawShape(force);
         DrawImage(force);
     }
@@ -386,13 +547,90 @@ namespace FreeTouchDeck
             sequence.Execute();
         }
     }
+    bool FTButton::StartRepeat()
+    {
+        if (!RepeatTimer)
+        {
+            esp_timer_create_args_t args = {};
+            args.callback = RepeatTick;
+            args.name = "repeat";
+            if (esp_timer_create(&args, &RepeatTimer) != ESP_OK)
+            {
+                RepeatTimer = NULL;
+                LOC_LOGE(module, "Unable to create the button repeat timer");
+                return false;
+            }
+        }
+        StopRepeat();
+        LOC_LOGD(module, "Repeating button %s after %dms, every %dms", Label.c_str(), RepeatDelay, RepeatInterval);
+        portENTER_CRITICAL(&RepeatMux);
+        RepeatPeriod = max(RepeatInterval, (uint16_t)BUTTON_REPEAT_MIN_INTERVAL_MS) * 1000LL;
+        RepeatDeadline = esp_timer_get_time() + RepeatDelay * 1000LL;
+        RepeatAccelerationPct = RepeatAcceleration;
+        RepeatButton = this;
+        esp_timer_start_once(RepeatTimer, RepeatDelay * 1000LL);
+        portEXIT_CRITICAL(&RepeatMux);
+        return true;
+    }
+    void FTButton::StopRepeat()
+    {
+        portENTER_CRITICAL(&RepeatMux);
+        RepeatButton = NULL;
+        if (RepeatTimer)
+        {
+            esp_timer_stop(RepeatTimer);
+        }
+        portEXIT_CRITICAL(&RepeatMux);
+    }
+    void FTButton::RepeatTick(void *arg)
+    {
+        // runs in the esp_timer task: the actions are run by the action task
+        if (!RepeatButton)
+        {
+            return;
+        }
+        // a slow host would make the keys pile up, the tick is skipped while the last repeat is queued
+        if (GetActionQueueStats(ActionLane::HID).Depth == 0)
+        {
+            QueueButtonRepeat();
+        }
+        portENTER_CRITICAL(&RepeatMux);
+        if (RepeatButton)
+        {
+            RepeatPeriod = max<int64_t>(RepeatPeriod * (100 - RepeatAccelerationPct) / 100, BUTTON_REPEAT_MIN_INTERVAL_MS * 1000);
+            // scheduled from the previous deadline, so the callback latency doesn't accumulate
+            RepeatDeadline += RepeatPeriod;
+            esp_timer_start_once(RepeatTimer, max<int64_t>(RepeatDeadline - esp_timer_get_time(), 0));
+        }
+        portEXIT_CRITICAL(&RepeatMux);
+    }
+    void FTButton::RunRepeat()
+    {
+        // the screen task releases the button before its menu is unloaded or
+        // deleted, both under the screen lock
+        if (!ScreenLock(portMAX_DELAY / portTICK_PERIOD_MS))
+        {
+            return;
+        }
+        FTButton *button = RepeatButton;
+        // the button may have been released since the repeat was queued
+        if (button)
+        {
+            button->ExecuteActions();
+        }
+        ScreenUnlock();
+    }
     void FTButton::UnPress()
     {
+        if (RepeatButton == this)
+        {
+            StopRepeat();
+        }
         if (!IsPressed)
             return;
         LOC_LOGD(module, "Cancelling press for button %s", Label.c_str());
         IsPressed = false;
-        FTButton::Invalidate();
+        NeedsDrawOutline = true;
         return;
     }
     void FTButton::Press()
@@ -405,11 +643,27 @@ namespace FreeTouchDeck
         LOC_LOGD(module, "Button %s is pressed", Label.c_str());
         HandleAudio(Sounds::BEEP);
         IsPressed = true;
-        FTButton::Invalidate();
+        NeedsDrawOutline = true;
+        if (ButtonType == ButtonTypes::STANDARD && RepeatDelay > 0 && (bleKeyboard.isConnected() || !HasKeyboardActions()))
+        {
+            // repeated buttons act when pressed, and not again when released.
+            // Without the timer, the button acts when released like others
+            if (StartRepeat())
+            {
+                ExecuteActions();
+            }
+        }
     }
     void FTButton::Release()
     {
-        if (IsPressed)
+        if (IsPressed && RepeatButton == this)
+        {
+            LOC_LOGD(module, "Releasing repeated button %s", Label.c_str());
+            StopRepeat();
+            IsPressed = false;
+            NeedsDrawOutline = true;
+        }
+        else if (IsPressed)
         {
             LOC_LOGD(module, "Releasing button %s", Label.c_str());
             // Beep
@@ -429,7 +683,15 @@ namespace FreeTouchDeck
                 }
                 ExecuteActions();
             }
-            FTButton::Invalidate();
+            if (ButtonType == ButtonTypes::LATCH)
+            {
+                // latch marker or latched logo may have changed
+                FTButton::Invalidate();
+            }
+            else
+            {
+                NeedsDrawOutline = true;
+            }
         }
     }
     cJSON *FTButton::ToJSON()
@@ -475,6 +737,15 @@ namespace FreeTouchDeck
         {
             cJSON_AddNumberToObject(button, FTButton::JsonLabelTextSize, TextSize);
         }
+        if (RepeatDelay > 0)
+        {
+            cJSON_AddNumberToObject(button, FTButton::JsonLabelRepeatDelay, RepeatDelay);
+            cJSON_AddNumberToObject(button, FTButton::JsonLabelRepeatInterval, RepeatInterval);
+            if (RepeatAcceleration > 0)
+            {
+                cJSON_AddNumberToObject(button, FTButton::JsonLabelRepeatAcceleration, RepeatAcceleration);
+            }
+        }
         LOC_LOGD(module, "Adding actions to Json");
         if (Sequences.size() > 0)
         {
@@ -531,6 +802,10 @@ namespace FreeTouchDeck
         GetColorOrDefault(button, FTButton::JsonLabelOutline, &Outline, generalconfig.DefaultOutline);
         GetColorOrDefault(button, FTButton::JsonLabelTextColor, &TextColor, generalconfig.DefaultTextColor);
         GetValueOrDefault(button, FTButton::JsonLabelTextSize, &TextSize, generalconfig.DefaultTextSize);
+        GetValueOrDefault(button, FTButton::JsonLabelRepeatDelay, &RepeatDelay, (uint16_t)0);
+        GetValueOrDefault(button, FTButton::JsonLabelRepeatInterval, &RepeatInterval, (uint16_t)BUTTON_REPEAT_INTERVAL_MS);
+        GetValueOrDefault(button, FTButton::JsonLabelRepeatAcceleration, &RepeatAcceleration, (uint8_t)0);
+        RepeatAcceleration = min(RepeatAcceleration, (uint8_t)99);
 
         cJSON *jsonActions = cJSON_GetObjectItem(button, FTButton::JsonLabelActions);
         if (!jsonActions)
@@ -555,6 +830,11 @@ namespace FreeTouchDeck
         }
         // re-determine color at the end, since we need to know if there are menu actions 
         ButtonType=IsMenu()?ButtonTypes::MENU:ButtonType;
+        if (RepeatDelay > 0 && ButtonType != ButtonTypes::STANDARD)
+        {
+            LOC_LOGW(module, "Only standard buttons can repeat. Ignoring the repeat of %s button %s", enum_to_string(ButtonType), Label.c_str());
+            RepeatDelay = 0;
+        }
         GetColorOrDefault(button, FTButton::JsonLabelBackground, &BackgroundColor, IsMenu()?generalconfig.functionButtonColour:MenuBackgroundColor);
 
         PrintMemInfo(__FUNCTION__, __LINE__);
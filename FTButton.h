@@ -23,6 +23,8 @@ namespace FreeTouchDeck
         bool Latched = false;
         bool NeedsDraw = true;
         bool NeedsDrawImage = true;
+        // only the pressed highlight changed
+        bool NeedsDrawOutline = false;
         bool IsPressed = false;
 
     private:
@@ -41,6 +43,18 @@ namespace FreeTouchDeck
         std::string _jsonLogo;
         std::string _jsonLatchedLogo;
         void ExecuteActions();
+        bool StartRepeat();
+        static void StopRepeat();
+        static void RepeatTick(void *arg);
+        uint16_t GetBackgroundColor(ImageWrapper *image);
+        void DrawOutline(TFT_eSPI &canvas, int16_t x, int16_t y, uint16_t BGColor);
+        bool DrawScaledImage(ImageWrapper *image, uint8_t scale, bool transparent);
+        void DrawShape(TFT_eSPI &canvas, int16_t x, int16_t y);
+#ifdef BUTTON_SPRITE_DRAW
+        static TFT_eSprite *Canvas;
+        TFT_eSprite *GetCanvas();
+        bool DrawCanvas();
+#endif
 
     public:
         static FTButton EmptyButton;
@@ -52,6 +66,13 @@ namespace FreeTouchDeck
         uint8_t TextSize = 0;
         uint32_t TextColor = 0;
         std::string Label;
+        // Standard buttons held for RepeatDelay ms run their actions again every
+        // RepeatInterval ms, shortened by RepeatAcceleration percent at each repeat
+        uint16_t RepeatDelay = 0;
+        uint16_t RepeatInterval = BUTTON_REPEAT_INTERVAL_MS;
+        uint8_t RepeatAcceleration = 0;
+        // Runs the actions of the held button, from the task of the keyboard queue
+        static void RunRepeat();
         static void InitConstants();
 
         static const char *JsonLabelLogo;
@@ -63,10 +84,14 @@ namespace FreeTouchDeck
         static const char *JsonLabelBackground;
         static const char *JsonLabelTextColor;
         static const char *JsonLabelTextSize;
+        static const char *JsonLabelRepeatDelay;
+        static const char *JsonLabelRepeatInterval;
+        static const char *JsonLabelRepeatAcceleration;
         static const char *backButtonTemplate;
         static const char *homeButtonTemplate;
         bool IsShared = false;
         bool IsMenu();
+        inline bool IsLatched() { return Latched; }
         std::vector<ActionsSequences> Sequences;
         FTButton(cJSON *button);
         FTButton();
@@ -82,12 +107,18 @@ namespace FreeTouchDeck
         ImageWrapper *LatchedLogo();
         ImageWrapper *GetActiveImage();
         ImageWrapper *Logo();
+        inline const std::string &LogoName() { return _jsonLogo; }
+        inline const std::string &LatchedLogoName() { return _jsonLatchedLogo; }
+        void GetImageNames(std::vector<std::string> &names);
+        void GetMenuTargets(std::vector<std::string> &names);
         bool HasKeyboardActions();
         uint16_t Width();
         uint16_t Height();
         void DrawShape(bool force);
         void DrawImage(bool force);
         void Draw(bool force);
+        // true when the button changed since it was last drawn
+        bool IsDirty();
         void Invalidate();
         void Press();
         void UnPress();
@@ -50,7 +50,6 @@
 // PAY ATTENTION! Even if resistive touch is not used, the TOUCH pin has to be defined!
 // It can be a random unused pin.
 // TODO: Find a way around this!
-#define ACTIONS_IN_TASKS
 #include "UserConfig.h"
 
 #ifdef ARDUINO_TWATCH_BASE
@@ -171,6 +170,7 @@ void setup()
 
   // ---------------- Start the first keypad -------------
 
+  StartPrefetchTask();
   // Draw background
   if (RunMode== SystemMode::STANDARD && !GetActiveScreen())
   {
@@ -185,9 +185,9 @@ void setup()
   // xTaskCreate(ScreenHandleTask, "Screen", 1024 * 3, NULL, tskIDLE_PRIORITY + 8, &xScreenTask);
   // PrintMemInfo(__FUNCTION__, __LINE__);
   // LOC_LOGD(module, "Screen task created");
-//  xTaskCreate(ActionTask, "Action", 1024 * 4, NULL, tskIDLE_PRIORITY + 5, &xActionTask);
-  //PrintMemInfo(__FUNCTION__, __LINE__);
-//  LOC_LOGD(module, "Action task created");
+  xTaskCreate(ActionTask, "Action", 1024 * 4, NULL, tskIDLE_PRIORITY + 5, &xActionTask);
+  PrintMemInfo(__FUNCTION__, __LINE__);
+  LOC_LOGD(module, "Action task created");
 #endif
 PrintBasicMemInfo();
   PrintMemInfo(__FUNCTION__, __LINE__);
@@ -211,16 +211,15 @@ void loop(void)
 #ifndef ACTIONS_IN_TASKS
   HandleActions();
 #endif
-  HandleActions();
 
-  // screen debounce
+  // screen debounce. Touch events wake the loop right away
   if(QueueSize()==0)
   {
-    delay(50);
+    InputWait(50 / portTICK_PERIOD_MS);
   }
   else 
   {
-    delay(10);
+    InputWait(10 / portTICK_PERIOD_MS);
   }
 }
 #ifdef ACTIONS_IN_TASKS
@@ -240,8 +239,8 @@ void ActionTask(void *pvParameters)
 {
   for (;;)
   {
-    HandleActions();
-    delay(50);
+    // wakes as soon as an action is queued
+    HandleActions(portMAX_DELAY);
   }
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "HidReport.h"
+namespace FreeTouchDeck
+{
+    // Same as the keyboard library's: usages of the US layout, with
+    // bit 7 set for the characters typed with shift
+    static const uint8_t AsciiMap[128] = {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // ........
+        0x2a, 0x2b, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00, // ........
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // ........
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // ........
+        0x2c, 0x9e, 0xb4, 0xa0, 0xa1, 0xa2, 0xa4, 0x34, // .!"#$%&'
+        0xa6, 0xa7, 0xa5, 0xae, 0x36, 0x2d, 0x37, 0x38, // ()*+,-./
+        0x27, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, // 01234567
+        0x25, 0x26, 0xb3, 0x33, 0xb6, 0x2e, 0xb7, 0xb8, // 89:;<=>?
+        0x9f, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, // @ABCDEFG
+        0x8b, 0x8c, 0x8d, 0x8e, 0x8f, 0x90, 0x91, 0x92, // HIJKLMNO
+        0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, // PQRSTUVW
+        0x9b, 0x9c, 0x9d, 0x2f, 0x31, 0x30, 0xa3, 0xad, // XYZ[\]^_
+        0x35, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, // `abcdefg
+        0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, // hijklmno
+        0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, // pqrstuvw
+        0x1b, 0x1c, 0x1d, 0xaf, 0xb1, 0xb0, 0xb5, 0x00  // xyz{|}~.
+    };
+    bool KeyToUsage(uint8_t key, uint8_t *usage, uint8_t *modifiers)
+    {
+        *usage = 0;
+        *modifiers = 0;
+        if (key >= 136)
+        {
+            // non printing keys, e.g. KEY_F1
+            *usage = key - 136;
+        }
+        else if (key >= 128)
+        {
+            // modifier keys, e.g. KEY_LEFT_CTRL
+            *modifiers = 1 << (key - 128);
+            return true;
+        }
+        else
+        {
+            *usage = AsciiMap[key] & 0x7F;
+            if (AsciiMap[key] & 0x80)
+            {
+                *modifiers = 0x02; // left shift
+            }
+        }
+        return *usage != 0;
+    }
+    size_t PackKeys(const uint8_t *values, size_t count, size_t start, KeyReport &report, uint8_t maxKeys)
+    {
+        uint8_t packed = 0;
+        size_t pos = start;
+        memset(&report, 0x00, sizeof(report));
+        maxKeys = min(maxKeys, (uint8_t)sizeof(report.keys));
+        for (; pos < count && packed < maxKeys; pos++)
+        {
+            uint8_t usage = 0;
+            uint8_t modifiers = 0;
+            if (!KeyToUsage(values[pos], &usage, &modifiers))
+            {
+                if (packed == 0)
+                {
+                    // skipped, as BleKeyboard::press does
+                    continue;
+                }
+                break;
+            }
+            if (usage == 0 || (packed > 0 && modifiers != report.modifiers) || memchr(report.keys, usage, packed))
+            {
+                // modifier keys are pressed on their own
+                if (packed == 0)
+                {
+                    report.modifiers = modifiers;
+                    pos++;
+                }
+                break;
+            }
+            report.modifiers = modifiers;
+            report.keys[packed++] = usage;
+        }
+        return pos - start;
+    }
+    bool SharesKeys(const KeyReport &a, const KeyReport &b)
+    {
+        for (uint8_t i = 0; i < sizeof(a.keys) && a.keys[i]; i++)
+        {
+            if (memchr(b.keys, a.keys[i], sizeof(b.keys)))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
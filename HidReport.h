@@ -0,0 +1,33 @@
+#pragma once
+#include "globals.hpp"
+#include "BleKeyboard.h"
+namespace FreeTouchDeck
+{
+    /**
+* @brief Converts a key, as accepted by BleKeyboard::press, to a HID
+*        usage and the modifiers it needs, using the US keyboard layout.
+*
+* @param key uint8_t character, modifier key or KEY_ code
+* @param usage uint8_t * receives the usage, 0 for modifier keys
+* @param modifiers uint8_t * receives the modifier bits
+*
+* @return bool false when the key can't be typed
+*/
+    bool KeyToUsage(uint8_t key, uint8_t *usage, uint8_t *modifiers);
+    /**
+* @brief Packs the next keys of a sequence in a single report. Keys are
+*        packed while they need the same modifiers and don't repeat a
+*        key already in the report.
+*
+* @param values const uint8_t * keys to send
+* @param count size_t number of keys to send
+* @param start size_t position of the first key to pack
+* @param report KeyReport & receives the keys and modifiers
+* @param maxKeys uint8_t largest number of keys in the report, up to 6
+*
+* @return size_t number of values consumed. Keys that can't be typed are skipped
+*/
+    size_t PackKeys(const uint8_t *values, size_t count, size_t start, KeyReport &report, uint8_t maxKeys);
+    // true when both reports press a same key
+    bool SharesKeys(const KeyReport &a, const KeyReport &b);
+}
@@ -9,34 +9,57 @@ static const char *module = "ImageCache";
 namespace FreeTouchDeck
 {
     std::vector<ImageWrapper *> ImageCache::ImageList; // reserve room for 100
+    // Images are indexed by name. The key is the single copy of the name
+    // kept for lookups, so draws don't compare strings across the list
+    std::unordered_map<std::string, ImageWrapper *> ImageCache::ImageIndex;
+    // Recursive, as the pixel cache functions call each other
+    SemaphoreHandle_t ImageCache::xImageCacheSemaphore = xSemaphoreCreateRecursiveMutex();
+    PixelCacheStats_t ImageCache::PixelCacheStats = {0, 0, 0, 0, 0, 0};
+    uint32_t ImageCache::PixelsUseCount = 0;
+    // Scaled images share the pixel cache budget and are evicted with the others
+    std::vector<ScaledPixels_t> ImageCache::ScaledList;
     ImageInstanceGetMap_t ImageCache::ConstructorList =
         {
-            {"bmp", [](const std::string &fileName)
+            {ImageFormats::BMP, [](const std::string &fileName)
              {
                  LOC_LOGD(module, "Getting Image instance from BMP constructor");
                  return (ImageWrapper *)ImageFormatBMP::GetImageInstance(fileName);
              }},
-            {"jpg", [](const std::string &fileName)
+            {ImageFormats::JPG, [](const std::string &fileName)
              {
                  LOC_LOGD(module, "Getting Image instance from JPG constructor");
                  return (ImageWrapper *)ImageFormatJPG::GetImageInstance(fileName);
              }}};
+    bool ImageCache::Lock()
+    {
+        if (xSemaphoreTakeRecursive(xImageCacheSemaphore, portMAX_DELAY) == pdTRUE)
+        {
+            return true;
+        }
+        LOC_LOGE(module, "Unable to lock the image cache");
+        return false;
+    }
+    void ImageCache::Unlock()
+    {
+        xSemaphoreGiveRecursive(xImageCacheSemaphore);
+    }
     ImageInstanceGet_t ImageCache::GetConstructorForImage(const std::string &imageName)
     {
-        const std::string ext = ImageWrapper::GetExtension(imageName);
-        LOC_LOGD(module, "Looking for constructor for extension %s", ext.c_str());
-        for (auto c : ConstructorList)
+        auto c = ConstructorList.find(ImageWrapper::GetImageFormat(imageName));
+        if (c == ConstructorList.end())
         {
-            if (ext == c.first)
-            {
-                LOC_LOGD(module, "Found Constructor for image type %s", ext.c_str());
-                return c.second;
-            }
+            return NULL;
         }
-        return NULL;
+        LOC_LOGD(module, "Found Constructor for image type %s", ImageWrapper::GetExtension(imageName));
+        return c->second;
     }
     ImageWrapper *ImageCache::GetImage(const std::string &imageName)
     {
+        ImageWrapper *returnedImage = NULL;
+        if (!Lock())
+        {
+            return NULL;
+        }
         if (ImageList.size() == 0)
         {
             // On the first call, insert a generic invalid image as the first element
@@ -45,40 +68,261 @@ namespace FreeTouchDeck
             PrintMemInfo(__FUNCTION__, __LINE__);
         }
 
-        if(imageName.empty())
+        if (imageName.empty())
         {
-            return ImageList.front();
+            returnedImage = ImageList.front();
         }
         else
         {
             LOC_LOGV(module, "Looking for image %s", imageName.c_str());
-            for (auto i : ImageList)
+            auto i = ImageIndex.find(imageName);
+            if (i != ImageIndex.end())
             {
-                if (i->LogoName == imageName)
-                {
-                    LOC_LOGV(module, "Returning cache entry for image %s", imageName.c_str());
-                    return i;
-                }
+                LOC_LOGV(module, "Returning cache entry for image %s", imageName.c_str());
+                returnedImage = i->second;
             }
         }
-        LOC_LOGD(module, "Image cache entry not found for %s. Adding it.", imageName.c_str());
-        PrintMemInfo(__FUNCTION__, __LINE__);
-        ImageInstanceGet_t constructor = GetConstructorForImage(imageName);
-        if (!constructor)
+        if (!returnedImage)
+        {
+            LOC_LOGD(module, "Image cache entry not found for %s. Adding it.", imageName.c_str());
+            PrintMemInfo(__FUNCTION__, __LINE__);
+            ImageInstanceGet_t constructor = GetConstructorForImage(imageName);
+            if (!constructor)
+            {
+                LOC_LOGE(module, "Unsupported file format %s", ImageWrapper::GetExtension(imageName));
+                returnedImage = ImageList.front();
+            }
+            else
+            {
+                PrintMemInfo(__FUNCTION__, __LINE__);
+                returnedImage = constructor(imageName);
+                LOC_LOGD(module, "Caching image name %s [%s]", returnedImage->LogoName.c_str(), returnedImage->valid ? "VALID" : "INVALID");
+                ImageList.push_back(returnedImage);
+                ImageIndex[imageName] = returnedImage;
+                PrintMemInfo(__FUNCTION__, __LINE__);
+            }
+            LOC_LOGD(module, "Returning image name %s [%s]", returnedImage->LogoName.c_str(), returnedImage->valid ? "VALID" : "INVALID");
+        }
+        Unlock();
+        return returnedImage; // guaranteed to return at least the empty image
+    }
+    ImageWrapper *ImageCache::FindImage(const std::string &imageName)
+    {
+        ImageWrapper *image = NULL;
+        if (!Lock())
+        {
+            return NULL;
+        }
+        auto i = ImageIndex.find(imageName);
+        if (i != ImageIndex.end())
+        {
+            image = i->second;
+        }
+        Unlock();
+        return image;
+    }
+    size_t ImageCache::GetPixelCacheBudget()
+    {
+#if defined(IMAGE_PIXEL_CACHE_PSRAM_SIZE) && defined(ESP32) && defined(CONFIG_SPIRAM_SUPPORT)
+        if (psramFound())
         {
-            LOC_LOGE(module, "Unsupported file format %s", ImageWrapper::GetExtension(imageName).c_str());
-            return ImageList.front();
+            return IMAGE_PIXEL_CACHE_PSRAM_SIZE;
+        }
+#endif
+#ifdef IMAGE_PIXEL_CACHE_RAM_SIZE
+        return IMAGE_PIXEL_CACHE_RAM_SIZE;
+#else
+        return 0;
+#endif
+    }
+    uint16_t *ImageCache::GetPixels(ImageWrapper *image)
+    {
+        uint16_t *pixels = NULL;
+        if (!Lock())
+        {
+            return NULL;
+        }
+        if (!image || !image->Pixels)
+        {
+            PixelCacheStats.Misses++;
         }
         else
         {
-            PrintMemInfo(__FUNCTION__, __LINE__);
-            ImageWrapper * newImage=constructor(imageName);
-            LOC_LOGD(module,"Caching image name %s [%s]",newImage->LogoName.c_str(), newImage->valid?"VALID":"INVALID");
-            ImageList.push_back(newImage);
-            PrintMemInfo(__FUNCTION__, __LINE__);
+            PixelCacheStats.Hits++;
+            image->PixelsLastUsed = ++PixelsUseCount;
+            pixels = image->Pixels;
+        }
+        Unlock();
+        return pixels;
+    }
+    bool ImageCache::EvictPixels()
+    {
+        ImageWrapper *oldest = NULL;
+        size_t oldestScaled = ScaledList.size();
+        for (auto i : ImageList)
+        {
+            if (i->Pixels && (!oldest || i->PixelsLastUsed < oldest->PixelsLastUsed))
+            {
+                oldest = i;
+            }
+        }
+        for (size_t i = 0; i < ScaledList.size(); i++)
+        {
+            uint32_t lastUsed = oldestScaled < ScaledList.size() ? ScaledList[oldestScaled].LastUsed : (oldest ? oldest->PixelsLastUsed : UINT32_MAX);
+            if (ScaledList[i].LastUsed < lastUsed)
+            {
+                oldestScaled = i;
+            }
         }
-        ImageWrapper * returnedImage=ImageList.back();
-        LOC_LOGD(module,"Returning image name %s [%s]",returnedImage->LogoName.c_str(), returnedImage->valid?"VALID":"INVALID");
-        return ImageList.back(); // guaranteed to return at least the empty image
+        if (oldestScaled < ScaledList.size())
+        {
+            ScaledPixels_t &scaled = ScaledList[oldestScaled];
+            LOC_LOGD(module, "Evicting pixels of image %s at 1/%d scale (%d bytes)", scaled.Image->LogoName.c_str(), scaled.Scale, scaled.Size);
+            FREE_AND_NULL(scaled.Pixels);
+            PixelCacheStats.BytesUsed -= scaled.Size;
+            PixelCacheStats.Entries--;
+            ScaledList.erase(ScaledList.begin() + oldestScaled);
+        }
+        else if (oldest)
+        {
+            LOC_LOGD(module, "Evicting pixels of image %s (%d bytes)", oldest->LogoName.c_str(), oldest->PixelsSize);
+            ReleasePixels(oldest);
+        }
+        else
+        {
+            return false;
+        }
+        PixelCacheStats.Evictions++;
+        return true;
+    }
+    uint16_t *ImageCache::AllocPixels(ImageWrapper *image, size_t size)
+    {
+        PixelCacheStats.Budget = GetPixelCacheBudget();
+        if (!image || size == 0 || size > PixelCacheStats.Budget || !Lock())
+        {
+            return NULL;
+        }
+        ReleasePixels(image);
+        while (PixelCacheStats.BytesUsed + size > PixelCacheStats.Budget && EvictPixels())
+        {
+        }
+#if defined(ESP32) && defined(CONFIG_SPIRAM_SUPPORT)
+        uint32_t caps = psramFound() ? MALLOC_CAP_SPIRAM : MALLOC_CAP_8BIT;
+#else
+        uint32_t caps = MALLOC_CAP_8BIT;
+#endif
+        // unlike malloc_fn, failing here isn't fatal: the image is read from flash instead
+        image->Pixels = (uint16_t *)heap_caps_malloc(size, caps);
+        if (!image->Pixels)
+        {
+            LOC_LOGW(module, "Unable to allocate %d bytes for the pixels of image %s", size, image->LogoName.c_str());
+            Unlock();
+            return NULL;
+        }
+        image->PixelsSize = size;
+        image->PixelsLastUsed = ++PixelsUseCount;
+        PixelCacheStats.BytesUsed += size;
+        PixelCacheStats.Entries++;
+        LOC_LOGD(module, "Keeping %d bytes of pixels for image %s. Pixel cache is using %d/%d bytes", size, image->LogoName.c_str(), PixelCacheStats.BytesUsed, PixelCacheStats.Budget);
+        Unlock();
+        return image->Pixels;
+    }
+    void ImageCache::ReleasePixels(ImageWrapper *image)
+    {
+        if (!image || !image->Pixels || !Lock())
+        {
+            return;
+        }
+        FREE_AND_NULL(image->Pixels);
+        PixelCacheStats.BytesUsed -= image->PixelsSize;
+        PixelCacheStats.Entries--;
+        image->PixelsSize = 0;
+        Unlock();
+    }
+    uint16_t *ImageCache::GetScaledPixels(ImageWrapper *image, uint8_t scale, uint16_t *width, uint16_t *height)
+    {
+        uint16_t *pixels = NULL;
+        if (!Lock())
+        {
+            return NULL;
+        }
+        for (auto &scaled : ScaledList)
+        {
+            if (scaled.Image == image && scaled.Scale == scale)
+            {
+                scaled.LastUsed = ++PixelsUseCount;
+                ASSING_IF_PASSED(width, scaled.Width);
+                ASSING_IF_PASSED(height, scaled.Height);
+                pixels = scaled.Pixels;
+                break;
+            }
+        }
+        if (pixels)
+        {
+            PixelCacheStats.Hits++;
+        }
+        else
+        {
+            PixelCacheStats.Misses++;
+        }
+        Unlock();
+        return pixels;
+    }
+    bool ImageCache::KeepScaledPixels(ImageWrapper *image, uint8_t scale, uint16_t *pixels, uint16_t width, uint16_t height)
+    {
+        size_t size = (size_t)width * height * sizeof(uint16_t);
+        PixelCacheStats.Budget = GetPixelCacheBudget();
+        if (!image || !pixels || size == 0 || size > PixelCacheStats.Budget || !Lock())
+        {
+            return false;
+        }
+        while (PixelCacheStats.BytesUsed + size > PixelCacheStats.Budget && EvictPixels())
+        {
+        }
+        ScaledList.push_back({image, scale, width, height, pixels, size, ++PixelsUseCount});
+        PixelCacheStats.BytesUsed += size;
+        PixelCacheStats.Entries++;
+        LOC_LOGD(module, "Keeping %d bytes of pixels for image %s at 1/%d scale. Pixel cache is using %d/%d bytes", size, image->LogoName.c_str(), scale, PixelCacheStats.BytesUsed, PixelCacheStats.Budget);
+        Unlock();
+        return true;
+    }
+    void ImageCache::ReleaseScaledPixels(ImageWrapper *image)
+    {
+        if (!Lock())
+        {
+            return;
+        }
+        for (size_t i = 0; i < ScaledList.size();)
+        {
+            if (ScaledList[i].Image == image)
+            {
+                FREE_AND_NULL(ScaledList[i].Pixels);
+                PixelCacheStats.BytesUsed -= ScaledList[i].Size;
+                PixelCacheStats.Entries--;
+                ScaledList.erase(ScaledList.begin() + i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+        Unlock();
+    }
+    bool ImageCache::CanHoldPixels(size_t size)
+    {
+        bool result = false;
+        if (!Lock())
+        {
+            return false;
+        }
+        PixelCacheStats.Budget = GetPixelCacheBudget();
+        result = size > 0 && PixelCacheStats.BytesUsed + size <= PixelCacheStats.Budget;
+        Unlock();
+        return result;
+    }
+    const PixelCacheStats_t &ImageCache::GetPixelCacheStats()
+    {
+        PixelCacheStats.Budget = GetPixelCacheBudget();
+        return PixelCacheStats;
     }
 }
\ No newline at end of file
@@ -1,15 +1,68 @@
 #pragma once
 #include "globals.hpp"
 #include "ImageWrapper.h"
+#include <unordered_map>
 namespace FreeTouchDeck
 {
-    
+    typedef struct
+    {
+        uint32_t Hits;
+        uint32_t Misses;
+        uint32_t Evictions;
+        size_t Entries;
+        size_t BytesUsed;
+        size_t Budget;
+    } PixelCacheStats_t;
+    // Image decoded at a fraction of its size, to fit a button
+    typedef struct
+    {
+        ImageWrapper *Image;
+        uint8_t Scale;
+        uint16_t Width;
+        uint16_t Height;
+        uint16_t *Pixels;
+        size_t Size;
+        uint32_t LastUsed;
+    } ScaledPixels_t;
+
     class ImageCache 
     {
         public:
         static ImageWrapper *GetImage(const std::string &imageName);
+        // Same as GetImage, without creating images that weren't loaded yet
+        static ImageWrapper *FindImage(const std::string &imageName);
+        static uint16_t *GetPixels(ImageWrapper *image);
+        static uint16_t *AllocPixels(ImageWrapper *image, size_t size);
+        static void ReleasePixels(ImageWrapper *image);
+        static bool CanHoldPixels(size_t size);
+        /**
+* @brief Returns the pixels of an image scaled down by scale, when kept in memory.
+*
+* @param image ImageWrapper * image the pixels were decoded from
+* @param scale uint8_t scale they were decoded at
+* @param width uint16_t * receives the width of the scaled image
+* @param height uint16_t * receives the height of the scaled image
+*
+* @return uint16_t * the RGB565 pixels, or NULL. Valid while the cache is locked
+*/
+        static uint16_t *GetScaledPixels(ImageWrapper *image, uint8_t scale, uint16_t *width, uint16_t *height);
+        // Takes ownership of pixels allocated by ImageWrapper::DecodeToBuffer when
+        // they fit in the budget. Returns false when the caller must free them
+        static bool KeepScaledPixels(ImageWrapper *image, uint8_t scale, uint16_t *pixels, uint16_t width, uint16_t height);
+        static void ReleaseScaledPixels(ImageWrapper *image);
+        static const PixelCacheStats_t &GetPixelCacheStats();
+        // Held while pixels kept in memory are used, so they can't be evicted
+        static bool Lock();
+        static void Unlock();
 
         private:
+        static SemaphoreHandle_t xImageCacheSemaphore;
+        static std::unordered_map<std::string, ImageWrapper *> ImageIndex;
+        static PixelCacheStats_t PixelCacheStats;
+        static uint32_t PixelsUseCount;
+        static std::vector<ScaledPixels_t> ScaledList;
+        static size_t GetPixelCacheBudget();
+        static bool EvictPixels();
         static std::vector<ImageWrapper *> ImageList;
         static ImageInstanceGetMap_t ConstructorList;
         static ImageInstanceGet_t GetConstructorForImage(const std::string &imageName);
@@ -4,6 +4,35 @@ static const char *module = "ImageFormatBMP";
 
 namespace FreeTouchDeck
 {
+    static void StreamSeek(BMPStream_t &stream, uint32_t filePos)
+    {
+        stream.file->seek(filePos);
+        stream.filePos = filePos;
+        stream.len = 0;
+        stream.pos = 0;
+    }
+    static void StreamInit(BMPStream_t &stream, fs::File *file, uint8_t *buffer, size_t size, uint32_t filePos)
+    {
+        stream.file = file;
+        stream.buffer = buffer;
+        stream.size = size;
+        StreamSeek(stream, filePos);
+    }
+    static int StreamRead(BMPStream_t &stream)
+    {
+        if (stream.pos >= stream.len)
+        {
+            stream.len = stream.file->read(stream.buffer, stream.size);
+            stream.pos = 0;
+            if (stream.len == 0)
+            {
+                return -1;
+            }
+        }
+        stream.filePos++;
+        return stream.buffer[stream.pos++];
+    }
+
     String ImageFormatBMP::Description="Bitmap File";
     ImageFormatBMP::ImageFormatBMP():ImageWrapper()
     {
@@ -19,14 +48,11 @@ namespace FreeTouchDeck
     };
     bool ImageFormatBMP::LoadImageDetails()
     {
-        
         char FileNameBuffer[101] = {0};
-#if defined(ESP32) && defined(CONFIG_SPIRAM_SUPPORT)
-
-        bool psramSupported = psramFound();
-#else
-        bool psramSupported = false;
-#endif
+        uint32_t redMask = 0;
+        uint32_t greenMask = 0;
+        uint32_t blueMask = 0;
+        uint32_t alphaMask = 0;
         // Open File
         FileName(FileNameBuffer, sizeof(FileNameBuffer));
         valid = true;
@@ -38,6 +64,7 @@ namespace FreeTouchDeck
             valid = false;
             return valid;
         }
+        SetSourceDetails(imageWrapper);
 
         if (valid && read16(imageWrapper) == 0x4D42)
         {
@@ -46,26 +73,72 @@ namespace FreeTouchDeck
             read32(imageWrapper);
             Offset = read32(imageWrapper);              // start of image data
             uint32_t headerSize = read32(imageWrapper); // header size
+            if (headerSize < 40)
+            {
+                LOC_LOGE(module, "Unsupported bitmap header size %d for image %s", headerSize, imageWrapper.name());
+                imageWrapper.close();
+                valid = false;
+                return valid;
+            }
             w = read32(imageWrapper);
-            h = read32(imageWrapper);
+            int32_t height = (int32_t)read32(imageWrapper);
+            // a negative height means that rows are stored top down
+            TopDown = height < 0;
+            h = TopDown ? -height : height;
             Planes = read16(imageWrapper);
             Depth = read16(imageWrapper); // Bits per pixel
-            if (headerSize > 12)
+            Compression = (BMPCompression)read32(imageWrapper);
+            (void)read32(imageWrapper);    // Raw bitmap data size; ignore
+            (void)read32(imageWrapper);    // Horizontal resolution, ignore
+            (void)read32(imageWrapper);    // Vertical resolution, ignore
+            Colors = read32(imageWrapper); // Number of colors in palette, or 0 for 2^depth
+            (void)read32(imageWrapper);    // Important colors, ignore
+            if (headerSize >= 52 || Compression == BMPCompression::BITFIELDS)
             {
-                Compression = read32(imageWrapper);
-                (void)read32(imageWrapper);    // Raw bitmap data size; ignore
-                (void)read32(imageWrapper);    // Horizontal resolution, ignore
-                (void)read32(imageWrapper);    // Vertical resolution, ignore
-                Colors = read32(imageWrapper); // Number of colors in palette, or 0 for 2^depth
+                // color masks are part of V2+ headers, or follow a V1 header
+                redMask = read32(imageWrapper);
+                greenMask = read32(imageWrapper);
+                blueMask = read32(imageWrapper);
+                alphaMask = headerSize >= 56 ? read32(imageWrapper) : 0;
             }
-            if (Depth != 24)
+            PaletteOffset = 14 + headerSize + (headerSize == 40 && Compression == BMPCompression::BITFIELDS ? 12 : 0);
+            switch (Depth)
             {
+            case 8:
+                Colors = Colors == 0 ? 256 : Colors;
+                if (Colors > 256 || (Compression != BMPCompression::RGB && Compression != BMPCompression::RLE8))
+                {
+                    valid = false;
+                }
+                break;
+            case 16:
+                Is565 = Compression == BMPCompression::BITFIELDS && redMask == 0xF800 && greenMask == 0x07E0 && blueMask == 0x001F;
+                if (Compression != BMPCompression::RGB && !Is565 && !(redMask == 0x7C00 && greenMask == 0x03E0 && blueMask == 0x001F))
+                {
+                    valid = false;
+                }
+                break;
+            case 24:
+                valid = Compression == BMPCompression::RGB;
+                break;
+            case 32:
+                HasAlpha = alphaMask == 0xFF000000;
+                if (Compression != BMPCompression::RGB && !(redMask == 0x00FF0000 && greenMask == 0x0000FF00 && blueMask == 0x000000FF))
+                {
+                    valid = false;
+                }
+                break;
+            default:
                 valid = false;
-                LOC_LOGE(module, "Unsupported bit depth %d for image %s. Image should be 24bpp.", Depth, imageWrapper.name());
+                break;
+            }
+            if (!valid)
+            {
+                LOC_LOGE(module, "Unsupported bit depth %d with compression %d for image %s. Image should be 8bpp (uncompressed or RLE), 16bpp, 24bpp or 32bpp.", Depth, (int)Compression, imageWrapper.name());
             }
-            if (Compression != 0)
+            if (Compression == BMPCompression::RLE8 && TopDown)
             {
-                LOC_LOGE(module, "Compression not supported for %s. Image should be uncompressed.", imageWrapper.name());
+                LOC_LOGE(module, "Top down RLE compressed bitmaps are invalid. Image %s", imageWrapper.name());
                 valid = false;
             }
             if (Planes != 1)
@@ -73,17 +146,40 @@ namespace FreeTouchDeck
                 LOC_LOGE(module, "Unsupported number of planes %d for image %s.", Planes, imageWrapper.name());
                 valid = false;
             }
+            // each row in a bmp pixel array is padded to a multiple of 4 bytes
+            RowSize = ((w * Depth + 31) / 32) * 4;
+            size_t needed = 256 * sizeof(uint16_t) + ((w * sizeof(uint16_t) + 3) & ~3) + (Compression == BMPCompression::RLE8 ? BMP_RLE_STREAM_BUFFER + w : RowSize);
+            if (valid && needed > IMAGE_DRAW_BUFFER_SIZE)
+            {
+                LOC_LOGE(module, "Image %s is too wide. %d bytes are needed to decode it, and the buffer is %d bytes", imageWrapper.name(), needed, IMAGE_DRAW_BUFFER_SIZE);
+                valid = false;
+            }
             if (valid)
             {
-                // each row in a bmp pixel array is padded to a multiple of 4 bytes
-                //padding = (4 - ((w * 3) & 3)) & 3;
-                padding = ((w * (Depth / 8)) % 4);
-                padding = padding > 0 ? 4 - padding : padding;
-                imageWrapper.seek(Offset); //skip bitmap header
-                LOC_LOGD(module, "Depth: %d width is %d, padded bytes: %d, padding: %d", Depth, w, (Depth / 8 * w) + padding, padding);
-                B = imageWrapper.read();
-                G = imageWrapper.read();
-                R = imageWrapper.read();
+                // the first pixel in the file gives the background color
+                uint16_t *palette = NULL;
+                uint8_t *input = NULL;
+                uint16_t *output = GetBuffers(&palette, &input);
+                bool success = Depth != 8 || LoadPalette(imageWrapper, palette);
+                if (success && Compression == BMPCompression::RLE8)
+                {
+                    BMPStream_t stream;
+                    BMPRleState_t state = {Offset, 0, 0, false};
+                    StreamInit(stream, &imageWrapper, input, BMP_RLE_STREAM_BUFFER, Offset);
+                    success = DecodeRleRow(stream, state, input + BMP_RLE_STREAM_BUFFER);
+                    input += BMP_RLE_STREAM_BUFFER;
+                }
+                else if (success)
+                {
+                    success = ReadRow(imageWrapper, 0, input);
+                }
+                if (success)
+                {
+                    ConvertRow(input, output, palette, false);
+                    PixelColor = output[0];
+                }
+                LOC_LOGD(module, "Depth: %d width is %d, row size: %d, compression: %d, background color 0x%04X", Depth, w, RowSize, (int)Compression, PixelColor);
+                valid = success;
             }
         }
         else
@@ -95,9 +191,184 @@ namespace FreeTouchDeck
         imageWrapper.close();
 
         LOC_LOGV(module, "Done parsing file");
+        // buttons draw large images scaled down, from the pixel cache: a full
+        // size cache file would cost a full decode and flash for nothing
+        if (valid && !IsScaledDown() && !CheckCache())
+        {
+            BuildCache();
+        }
         return valid;
     }
-    // move the drawing function to IRAM in an attempt to speed up drawing
+    uint16_t *ImageFormatBMP::GetBuffers(uint16_t **palette, uint8_t **input)
+    {
+        // The draw buffer of the current task is split in a palette, a converted row
+        // and the raw input, so drawing never allocates
+        uint8_t *buffer = GetDrawBuffer(NULL);
+        *palette = (uint16_t *)buffer;
+        uint16_t *output = (uint16_t *)(buffer + 256 * sizeof(uint16_t));
+        // input stays word aligned for the row conversion
+        *input = (uint8_t *)output + ((w * sizeof(uint16_t) + 3) & ~3);
+        return output;
+    }
+    bool ImageFormatBMP::LoadPalette(fs::File &bmpFS, uint16_t *palette)
+    {
+        uint8_t entry[4];
+        memset(palette, 0x00, 256 * sizeof(uint16_t));
+        bmpFS.seek(PaletteOffset);
+        for (uint32_t i = 0; i < Colors; i++)
+        {
+            // entries are stored as BGR plus an unused byte
+            if (bmpFS.read(entry, sizeof(entry)) != sizeof(entry))
+            {
+                LOC_LOGE(module, "Palette of %s is truncated", LogoName.c_str());
+                return false;
+            }
+            palette[i] = convertRGB888ToRGB565(entry, 24);
+        }
+        return true;
+    }
+    bool ImageFormatBMP::ReadRow(fs::File &bmpFS, uint16_t row, uint8_t *input)
+    {
+        if (!bmpFS.seek(Offset + row * RowSize) || bmpFS.read(input, RowSize) != RowSize)
+        {
+            LOC_LOGE(module, "Unable to read row %d of %s", row, LogoName.c_str());
+            return false;
+        }
+        return true;
+    }
+    void ImageFormatBMP::ConvertRow(const uint8_t *input, uint16_t *output, const uint16_t *palette, bool swapBytes)
+    {
+        uint16_t value = 0;
+        switch (Depth)
+        {
+        case 8:
+            for (uint16_t col = 0; col < w; col++)
+            {
+                value = palette[input[col]];
+                output[col] = swapBytes ? (value >> 8) | (value << 8) : value;
+            }
+            break;
+        case 16:
+            for (uint16_t col = 0; col < w; col++)
+            {
+                value = input[col * 2] | (input[col * 2 + 1] << 8);
+                // 555 is widened to 565, leaving the low green bit cleared
+                value = Is565 ? value : ((value & 0x7FE0) << 1) | (value & 0x001F);
+                output[col] = swapBytes ? (value >> 8) | (value << 8) : value;
+            }
+            break;
+        case 24:
+        case 32:
+            convertRGB888RowToRGB565(input, output, w, Depth, swapBytes);
+            for (uint16_t col = 0; HasAlpha && col < w; col++)
+            {
+                // fully transparent pixels take the transparent color
+                if (input[col * 4 + 3] < 0x80)
+                {
+                    output[col] = TFT_BLACK;
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    bool ImageFormatBMP::DecodeRleRow(BMPStream_t &stream, BMPRleState_t &state, uint8_t *indices)
+    {
+        int count = 0;
+        int value = 0;
+        memset(indices, 0x00, w);
+        if (state.done)
+        {
+            return true;
+        }
+        if (state.skipRows > 0)
+        {
+            // row was skipped by a delta
+            state.skipRows--;
+            return true;
+        }
+        if (stream.filePos != state.filePos)
+        {
+            StreamSeek(stream, state.filePos);
+        }
+        uint16_t x = state.x;
+        state.x = 0;
+        while (true)
+        {
+            count = StreamRead(stream);
+            value = StreamRead(stream);
+            if (count < 0 || value < 0)
+            {
+                LOC_LOGE(module, "Compressed data of %s is truncated", LogoName.c_str());
+                state.done = true;
+                return false;
+            }
+            if (count > 0)
+            {
+                // encoded run of the same color
+                for (int i = 0; i < count; i++)
+                {
+                    if (x < w)
+                    {
+                        indices[x++] = value;
+                    }
+                }
+                continue;
+            }
+            switch (value)
+            {
+            case 0:
+                // end of line
+                state.filePos = stream.filePos;
+                return true;
+            case 1:
+                // end of bitmap
+                state.done = true;
+                state.filePos = stream.filePos;
+                return true;
+            case 2:
+            {
+                int dx = StreamRead(stream);
+                int dy = StreamRead(stream);
+                if (dx < 0 || dy < 0)
+                {
+                    state.done = true;
+                    return false;
+                }
+                x += dx;
+                if (dy > 0)
+                {
+                    state.skipRows = dy - 1;
+                    state.x = x;
+                    state.filePos = stream.filePos;
+                    return true;
+                }
+            }
+            break;
+            default:
+                // absolute run of colors, padded to an even number of bytes
+                for (int i = 0; i < value; i++)
+                {
+                    count = StreamRead(stream);
+                    if (count < 0)
+                    {
+                        state.done = true;
+                        return false;
+                    }
+                    if (x < w)
+                    {
+                        indices[x++] = count;
+                    }
+                }
+                if (value & 1)
+                {
+                    StreamRead(stream);
+                }
+                break;
+            }
+        }
+    }
      void ImageFormatBMP::Draw(int16_t x, int16_t y, bool transparent)
     {
         char FileNameBuffer[100] = {0};
@@ -113,13 +384,14 @@ namespace FreeTouchDeck
             LOC_LOGW(module, "Not drawing an invalid image");
             return;
         }
+        if (DrawCache(x, y, transparent))
+        {
+            return;
+        }
 
-        LOC_LOGV(module, "Getting background color");
-        uint16_t BGColor = tft.color565(R, G, B);
+        uint16_t BGColor = PixelColor;
         bool Transparent = ((BGColor == TFT_BLACK) || transparent);
         FileName(FileNameBuffer, sizeof(FileNameBuffer));
-        bool oldSwapBytes = tft.getSwapBytes();
-        tft.setSwapBytes(true);
 
         LOC_LOGV(module, "Opening file %s", FileNameBuffer);
         fs::File bmpFS = ftdfs->open(FileNameBuffer, "r");
@@ -128,104 +400,187 @@ namespace FreeTouchDeck
             LOC_LOGE(module, "File not found: %s", FileNameBuffer);
             return;
         }
-        LOC_LOGV(module, "Seeking offset: %d", Offset);
-
-        bmpFS.seek(Offset);
-        uint16_t row;
-        uint8_t r, g, b;
-
-        uint8_t bytesPerPixel = Depth / 8;
-        size_t lineBufSpace = (bytesPerPixel * w) + padding;
-        // reserve buffer memory enough to load all lines or up to the max buffer allowed
-        size_t maxAlloclines = min(((size_t)(heap_caps_get_free_size(MALLOC_CAP_INTERNAL) * BITMAP_BUFFER_FREE_RAM_PCT)) / lineBufSpace, (size_t)h);
-        //uint8_t lines = w > 80 ? 1 : 10;
-        size_t bufferSize = maxAlloclines * lineBufSpace;
-        uint8_t *lineBuffer = (uint8_t *)malloc(bufferSize);
-        if (!lineBuffer)
+        uint16_t *palette = NULL;
+        uint8_t *input = NULL;
+        uint16_t *output = GetBuffers(&palette, &input);
+        if (Depth == 8 && !LoadPalette(bmpFS, palette))
         {
-            LOC_LOGE(module, "Error allocating %d bytes of buffer for image drawing!", bufferSize);
-            tft.setSwapBytes(oldSwapBytes);
-            free(lineBuffer);
-            LOC_LOGV(module, "Closing bitmap file %s", LogoName.c_str());
             bmpFS.close();
             return;
         }
-        LOC_LOGV(module, "Drawing picture lines: %d, bytesPerPixel: %d, lineBufSpace: %d, bufferSize: %d ", maxAlloclines, bytesPerPixel, lineBufSpace, bufferSize);
-        uint16_t lx = x - w / 2;
-        uint16_t ly = y + h / 2 - 1;
-        uint8_t *bptr = NULL;
-        uint16_t *tptr = NULL;
-        if (Transparent || transparent)
-        {
-            // Push the pixel row to screen, pushImage will crop the line if needed
-            // y is decremented as the BMP image is drawn bottom up
-            LOC_LOGV(module, "Drawing with transparent color 0x%04x", BGColor);
-        }
-        else
+        BMPStream_t stream;
+        BMPRleState_t state = {Offset, 0, 0, false};
+        uint8_t *indices = input + BMP_RLE_STREAM_BUFFER;
+        if (Compression == BMPCompression::RLE8)
         {
-            LOC_LOGV(module, "Drawing bitmap line opaque");
+            StreamInit(stream, &bmpFS, input, BMP_RLE_STREAM_BUFFER, Offset);
         }
-
-        for (row = 0; row < h; row += maxAlloclines)
+        // rows are converted straight to the screen's byte order, so
+        // the transparent color needs to be swapped the same way
+        uint16_t swappedBGColor = (BGColor >> 8) | (BGColor << 8);
+        bool oldSwapBytes = tft.getSwapBytes();
+        tft.setSwapBytes(false);
+        int16_t lx = x - w / 2;
+        int16_t ly = y - h / 2;
+        LOC_LOGV(module, "Drawing %s with %s", LogoName.c_str(), Transparent ? "transparency" : "no transparency");
+        // Rows are decoded one at a time, in the order they are stored, and
+        // pushed to the screen, pushImage will crop the line if needed
+        for (uint16_t row = 0; row < h; row++)
         {
-            size_t readBuf = bmpFS.read(lineBuffer, bufferSize);
-            bptr = lineBuffer;
-            tptr = (uint16_t *)lineBuffer;
-            uint8_t readLines = readBuf / lineBufSpace;
-            //LOC_LOGD(module, "Read %d bytes (%d lines) from bmp",readBuf, readLines);
-            // Convert 24 to 16 bit colours
-            for (uint16_t r = 0; r < readLines; r++)
+            if (Compression == BMPCompression::RLE8)
             {
-
-#ifdef DRAWDEBUG
-                uint8_t *bptr2 = bptr;
-                Serial.print("=>");
-                for (uint16_t col = 0; col < w; col++)
+                if (!DecodeRleRow(stream, state, indices))
                 {
-
-                    Serial.printf("%s", *bptr2 + bptr2[1] + bptr2[2] > 0 ? "." : "");
-                    bptr2 += bytesPerPixel;
-                }
-                Serial.println();
-                Serial.print("<=");
-                for (uint16_t col = 0; col < w; col++)
-                {
-                    *tptr = convertRGB888ToRGB565(bptr, Depth);
-                    Serial.printf("%s", (*tptr) > 0 ? "." : "");
-                    tptr++;
-                    bptr += bytesPerPixel;
+                    break;
                 }
-                Serial.println();
-#endif
-                for (uint16_t col = 0; col < w; col++)
+                ConvertRow(indices, output, palette, true);
+            }
+            else
+            {
+                if (!ReadRow(bmpFS, row, input))
                 {
-                    *tptr = convertRGB888ToRGB565(bptr, Depth);
-                    tptr++;
-                    bptr += bytesPerPixel;
+                    break;
                 }
-                bptr += padding;
+                ConvertRow(input, output, palette, true);
             }
-            tptr = (uint16_t *)lineBuffer;
-            for (uint16_t line = readLines; line > 0; line--)
+            if (Transparent)
             {
-                if (Transparent || transparent)
+                PushImage(lx, ly + DisplayRow(row), w, 1, output, swappedBGColor);
+            }
+            else
+            {
+                PushImage(lx, ly + DisplayRow(row), w, 1, output);
+            }
+        }
+        LOC_LOGV(module, "Closing bitmap file %s", LogoName.c_str());
+        bmpFS.close();
+        tft.setSwapBytes(oldSwapBytes);
+    }
+    uint16_t *ImageFormatBMP::DecodeToBuffer(uint8_t scale, uint16_t *width, uint16_t *height)
+    {
+        char FileNameBuffer[101] = {0};
+        BMPStream_t stream;
+        BMPRleState_t state = {Offset, 0, 0, false};
+        if (!valid || (scale != 1 && scale != 2 && scale != 4 && scale != 8))
+        {
+            LOC_LOGE(module, "Unable to decode %s with scale 1/%d", LogoName.c_str(), scale);
+            return NULL;
+        }
+        uint16_t bufferWidth = (w + scale - 1) / scale;
+        uint16_t bufferHeight = (h + scale - 1) / scale;
+        uint16_t *buffer = AllocDecodeBuffer((size_t)bufferWidth * bufferHeight * sizeof(uint16_t));
+        if (!buffer)
+        {
+            return NULL;
+        }
+        FileName(FileNameBuffer, sizeof(FileNameBuffer));
+        fs::File bmpFS = ftdfs->open(FileNameBuffer, FILE_READ);
+        uint16_t *palette = NULL;
+        uint8_t *input = NULL;
+        uint16_t *output = GetBuffers(&palette, &input);
+        uint8_t *indices = input + BMP_RLE_STREAM_BUFFER;
+        bool success = bmpFS && (Depth != 8 || LoadPalette(bmpFS, palette));
+        if (success && Compression == BMPCompression::RLE8)
+        {
+            StreamInit(stream, &bmpFS, input, BMP_RLE_STREAM_BUFFER, Offset);
+        }
+        for (uint16_t row = 0; row < h && success; row++)
+        {
+            // scaling keeps one pixel out of scale in each direction
+            uint16_t y = DisplayRow(row);
+            if (Compression == BMPCompression::RLE8)
+            {
+                // compressed rows are decoded even when skipped, to move forward
+                success = DecodeRleRow(stream, state, indices);
+                if (y % scale == 0)
                 {
-                    tft.pushImage(lx, ly--, w, 1, (uint16_t *)tptr, BGColor);
+                    ConvertRow(indices, output, palette, false);
                 }
-                else
+            }
+            else if (y % scale == 0)
+            {
+                success = ReadRow(bmpFS, row, input);
+                ConvertRow(input, output, palette, false);
+            }
+            if (success && y % scale == 0)
+            {
+                uint16_t *target = &buffer[(y / scale) * bufferWidth];
+                for (uint16_t col = 0; col < bufferWidth; col++)
                 {
-                    // Push the pixel row to screen, pushImage will crop the line if needed
-                    // y is decremented as the BMP image is drawn bottom up
-                    tft.pushImage(lx, ly--, w, 1, (uint16_t *)tptr);
+                    target[col] = output[col * scale];
                 }
-                tptr += w;
             }
         }
-        // }
-        free(lineBuffer);
-        LOC_LOGV(module, "Closing bitmap file %s", LogoName.c_str());
+        if (bmpFS)
+        {
+            bmpFS.close();
+        }
+        if (!success)
+        {
+            LOC_LOGE(module, "Unable to decode %s", FileNameBuffer);
+            FREE_AND_NULL(buffer);
+            return NULL;
+        }
+        ASSING_IF_PASSED(width, bufferWidth);
+        ASSING_IF_PASSED(height, bufferHeight);
+        return buffer;
+    }
+    bool ImageFormatBMP::WriteCachePixels(fs::File &cacheFile)
+    {
+        char FileNameBuffer[101] = {0};
+        BMPRleState_t *rowStates = NULL;
+        BMPStream_t stream;
+        BMPRleState_t state = {Offset, 0, 0, false};
+        uint16_t *palette = NULL;
+        uint8_t *input = NULL;
+        uint16_t *output = GetBuffers(&palette, &input);
+        uint8_t *indices = input + BMP_RLE_STREAM_BUFFER;
+        FileName(FileNameBuffer, sizeof(FileNameBuffer));
+        fs::File bmpFS = ftdfs->open(FileNameBuffer, FILE_READ);
+        if (!bmpFS)
+        {
+            LOC_LOGE(module, "File not found: %s", FileNameBuffer);
+            return false;
+        }
+        bool success = Depth != 8 || LoadPalette(bmpFS, palette);
+        if (success && Compression == BMPCompression::RLE8)
+        {
+            // The cache is written top down. Compressed rows can't be
+            // located without decoding, so a first pass records where
+            // each row starts
+            rowStates = (BMPRleState_t *)malloc(h * sizeof(BMPRleState_t));
+            success = rowStates != NULL;
+            StreamInit(stream, &bmpFS, input, BMP_RLE_STREAM_BUFFER, Offset);
+            for (uint16_t row = 0; row < h && success; row++)
+            {
+                rowStates[row] = state;
+                success = DecodeRleRow(stream, state, indices);
+            }
+        }
+        for (uint16_t y = 0; y < h && success; y++)
+        {
+            // bmp rows are usually stored bottom up
+            uint16_t row = DisplayRow(y);
+            if (Compression == BMPCompression::RLE8)
+            {
+                state = rowStates[row];
+                success = DecodeRleRow(stream, state, indices);
+                ConvertRow(indices, output, palette, false);
+            }
+            else
+            {
+                success = ReadRow(bmpFS, row, input);
+                ConvertRow(input, output, palette, false);
+            }
+            success = success && cacheFile.write((uint8_t *)output, w * sizeof(uint16_t)) == w * sizeof(uint16_t);
+        }
+        if (!success)
+        {
+            LOC_LOGE(module, "Error converting %s to cache", FileNameBuffer);
+        }
+        FREE_AND_NULL(rowStates);
         bmpFS.close();
-        tft.setSwapBytes(oldSwapBytes);
+        return success;
     }
     bool ImageFormatBMP::IsValid()
     {
@@ -241,8 +596,8 @@ namespace FreeTouchDeck
     }
      ImageFormatBMP * ImageFormatBMP::GetImageInstance(const std::string &imageName)
      {
-         LOC_LOGD(module,"BMP handler checking if extension of %s is a match for 'bmp'",imageName);
-         if(!IsExtensionMatch("bmp",imageName.c_str()))
+         LOC_LOGD(module,"BMP handler checking if extension of %s is a match for 'bmp'",imageName.c_str());
+         if(!IsExtensionMatch("bmp",imageName))
          {
              LOC_LOGE(module, "Invalid file extension. ");
              return new ImageFormatBMP();
@@ -251,8 +606,8 @@ namespace FreeTouchDeck
      }
      uint16_t ImageFormatBMP::GetPixelColor()
      {
-        return tft.color565(R, G, B);
+        return PixelColor;
      }
-   
-        
+
+
 }
\ No newline at end of file
@@ -2,12 +2,42 @@
 #include "globals.hpp"
 #include "ImageWrapper.h"
 
+// Bytes read at once from the file when decoding RLE compressed bitmaps
+#define BMP_RLE_STREAM_BUFFER 256
+
 namespace FreeTouchDeck
 {
+    enum class BMPCompression
+    {
+        RGB = 0,
+        RLE8 = 1,
+        BITFIELDS = 3
+    };
+    // Buffered sequential reader, used to decode compressed bitmaps
+    // without reading the file one byte at a time
+    typedef struct
+    {
+        fs::File *file;
+        uint8_t *buffer;
+        size_t size;
+        size_t len;
+        size_t pos;
+        uint32_t filePos;
+    } BMPStream_t;
+    // Position of the RLE decoder at the start of a stored row
+    typedef struct
+    {
+        uint32_t filePos;
+        uint16_t x;
+        uint16_t skipRows;
+        bool done;
+    } BMPRleState_t;
+
     class ImageFormatBMP : ImageWrapper
     {
     public:
         void Draw(int16_t x, int16_t y, bool transparent);
+        uint16_t *DecodeToBuffer(uint8_t scale, uint16_t *width, uint16_t *height);
         ImageFormatBMP(const std::string &imageName);
         ImageFormatBMP();
         static ImageFormatBMP * GetImageInstance(const std::string &imageName);
@@ -18,12 +48,27 @@ namespace FreeTouchDeck
     private:
         static String Description;
         uint32_t Offset = 0;
+        uint32_t PaletteOffset = 0;
         uint16_t Planes = 0;
         uint16_t Depth = 0;
-        uint32_t Compression = 0;
+        BMPCompression Compression = BMPCompression::RGB;
         uint32_t Colors = 0;
-        byte R, G, B;
-        uint16_t padding = 0;
+        uint32_t RowSize = 0;
+        bool TopDown = false;
+        bool Is565 = false;
+        bool HasAlpha = false;
+        uint16_t PixelColor = TFT_BLACK;
         bool LoadImageDetails();
+        bool WriteCachePixels(fs::File &cacheFile);
+        uint16_t *GetBuffers(uint16_t **palette, uint8_t **input);
+        bool LoadPalette(fs::File &bmpFS, uint16_t *palette);
+        void ConvertRow(const uint8_t *input, uint16_t *output, const uint16_t *palette, bool swapBytes);
+        bool ReadRow(fs::File &bmpFS, uint16_t row, uint8_t *input);
+        bool DecodeRleRow(BMPStream_t &stream, BMPRleState_t &state, uint8_t *indices);
+        inline uint16_t DisplayRow(uint16_t row)
+        {
+            // rows are stored bottom up, unless the height was negative
+            return TopDown ? row : h - 1 - row;
+        }
     };
-}
\ No newline at end of file
+}
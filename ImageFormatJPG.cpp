@@ -35,6 +35,9 @@ namespace FreeTouchDeck
     }
 
     String ImageFormatJPG::Description = "JPG File";
+    // TJpgDec is a single shared decoder, so decodes are serialized
+    SemaphoreHandle_t ImageFormatJPG::xDecoderSemaphore = xSemaphoreCreateMutex();
+    JpgDecodeContext_t *ImageFormatJPG::ActiveContext = NULL;
     ImageFormatJPG::ImageFormatJPG(const std::string &imageName) : ImageWrapper(imageName)
     {
         LOC_LOGD(module, "Instantiating JPG file");
@@ -44,16 +47,42 @@ namespace FreeTouchDeck
         }
     };
     ImageFormatJPG::ImageFormatJPG():ImageWrapper(){};
+    bool ImageFormatJPG::Decode(JpgDecodeContext_t &context, JpgOutput_t output, int16_t x, int16_t y, uint8_t scale)
+    {
+        char FileNameBuffer[101] = {0};
+        FileName(FileNameBuffer, sizeof(FileNameBuffer));
+        if (xSemaphoreTake(xDecoderSemaphore, portMAX_DELAY) != pdTRUE)
+        {
+            LOC_LOGE(module, "Unable to lock the jpg decoder");
+            return false;
+        }
+        // the decoder closes the file when it is done
+        File imageFile = ftdfs->open(FileNameBuffer, FILE_READ);
+        if (!imageFile)
+        {
+            LOC_LOGE(module, "Error opening %s", FileNameBuffer);
+            xSemaphoreGive(xDecoderSemaphore);
+            return false;
+        }
+        ActiveContext = &context;
+        TJpgDec.setJpgScale(scale);
+        TJpgDec.setCallback(output);
+        JRESULT res = TJpgDec.drawFsJpg(x, y, imageFile);
+        TJpgDec.setJpgScale(1);
+        ActiveContext = NULL;
+        xSemaphoreGive(xDecoderSemaphore);
+        // output functions interrupt the decoding when they are done
+        if (res != JDR_OK && res != JDR_INTR)
+        {
+            LOC_LOGE(module, "Unable to decode %s. Return code was %s", FileNameBuffer, enum_to_string(res));
+            return false;
+        }
+        return true;
+    }
     bool ImageFormatJPG::LoadImageDetails()
     {
-
         char FileNameBuffer[101] = {0};
-#if defined(ESP32) && defined(CONFIG_SPIRAM_SUPPORT)
-
-        bool psramSupported = psramFound();
-#else
-        bool psramSupported = false;
-#endif
+        JpgDecodeContext_t context;
         // Open File
         FileName(FileNameBuffer, sizeof(FileNameBuffer));
         valid = false;
@@ -66,28 +95,37 @@ namespace FreeTouchDeck
             LOC_LOGE(module, "Error opening %s", FileNameBuffer);
             return false;
         }
-        //LOC_LOGD(module, "Getting size from SD card file");
-        res = TJpgDec.getFsJpgSize(&w, &h, imageFile);
-
-        if (res == JDR_OK)
+        SetSourceDetails(imageFile);
+        if (xSemaphoreTake(xDecoderSemaphore, portMAX_DELAY) == pdTRUE)
         {
-            // need to open the file again, since get size will close it
-            TJpgDec.setCallback(ImageFormatJPG::pixelcheck);
-            //LOC_LOGD(module, "Getting pixel color from SD file");
-            TJpgDec.drawFsJpg(0, 0, imageFile);
+            // don't close the file; the getFsJpgSize call does it
+            res = TJpgDec.getFsJpgSize(&w, &h, imageFile);
+            xSemaphoreGive(xDecoderSemaphore);
+        }
+        else
+        {
+            res = JDR_INTR;
+        }
 
-            PixelColor = firstPixColor;
+        memset(&context, 0x00, sizeof(context));
+        if (res == JDR_OK && Decode(context, ImageFormatJPG::pixelcheck, 0, 0, 1))
+        {
+            PixelColor = context.FirstPixel;
             valid = true;
-            LOC_LOGD(module, "JPG File dimensions are %dx%d, background color is RGB565 0x%04d", w, h, PixelColor);
+            LOC_LOGD(module, "JPG File dimensions are %dx%d, background color is RGB565 0x%04X", w, h, PixelColor);
         }
         else
         {
             LOC_LOGE(module, "Unable to get JPG size. Return code was %s ", enum_to_string(res));
         }
-        imageFile.close();
         PrintMemInfo(__FUNCTION__, __LINE__);
-        // don't close the file; the getSdJpgSize call does it
         LOC_LOGV(module, "Done parsing file");
+        // buttons draw large images scaled down, from the pixel cache: a full
+        // size cache file would cost a full decode and flash for nothing
+        if (valid && !IsScaledDown() && !CheckCache())
+        {
+            BuildCache();
+        }
         return valid;
     }
     bool ImageFormatJPG::IsValid()
@@ -100,7 +138,7 @@ namespace FreeTouchDeck
     }
     void ImageFormatJPG::Draw(int16_t x, int16_t y, bool transparent)
     {
-        char FileNameBuffer[100] = {0};
+        JpgDecodeContext_t context;
         LOC_LOGD(module, "Drawing jpg file %s at [%d,%d] ", LogoName.c_str(), x, y);
         if ((x >= tft.width()) || (y >= tft.height()))
         {
@@ -113,29 +151,49 @@ namespace FreeTouchDeck
             LOC_LOGW(module, "Not drawing an invalid image");
             return;
         }
-        BGColor = PixelColor;
-        Transparent = ((BGColor == TFT_BLACK) || transparent);
-        FileName(FileNameBuffer, sizeof(FileNameBuffer));
+        if (DrawCache(x, y, transparent))
+        {
+            return;
+        }
+        memset(&context, 0x00, sizeof(context));
+        context.BGColor = PixelColor;
+        context.Transparent = ((context.BGColor == TFT_BLACK) || transparent);
         bool oldSwapBytes = tft.getSwapBytes();
         tft.setSwapBytes(true);
 
         uint16_t cornerX = max((uint16_t)(x - (w / 2)), (uint16_t)0);
         uint16_t cornerY = max((uint16_t)(y - (h / 2)), (uint16_t)0);
 
-        TJpgDec.setCallback(ImageFormatJPG::tft_output);
-        File imageFile = ftdfs->open(FileNameBuffer, FILE_READ);
-        if (!imageFile)
-        {
-            LOC_LOGE(module, "Error opening %s", FileNameBuffer);
-            return;
-        }
-
-        TJpgDec.drawFsJpg(cornerX, cornerY, imageFile);
-        imageFile.close();
+        Decode(context, ImageFormatJPG::tft_output, cornerX, cornerY, 1);
         PrintMemInfo(__FUNCTION__, __LINE__);
-        LOC_LOGV(module, "Closing bitmap file %s", LogoName.c_str());
         tft.setSwapBytes(oldSwapBytes);
     }
+    uint16_t *ImageFormatJPG::DecodeToBuffer(uint8_t scale, uint16_t *width, uint16_t *height)
+    {
+        JpgDecodeContext_t context;
+        if (!valid || (scale != 1 && scale != 2 && scale != 4 && scale != 8))
+        {
+            LOC_LOGE(module, "Unable to decode %s with scale 1/%d", LogoName.c_str(), scale);
+            return NULL;
+        }
+        memset(&context, 0x00, sizeof(context));
+        context.BufferWidth = (w + scale - 1) / scale;
+        context.BufferHeight = (h + scale - 1) / scale;
+        context.Buffer = AllocDecodeBuffer((size_t)context.BufferWidth * context.BufferHeight * sizeof(uint16_t));
+        if (!context.Buffer)
+        {
+            return NULL;
+        }
+        context.Success = true;
+        if (!Decode(context, ImageFormatJPG::buffer_output, 0, 0, scale) || !context.Success)
+        {
+            FREE_AND_NULL(context.Buffer);
+            return NULL;
+        }
+        ASSING_IF_PASSED(width, context.BufferWidth);
+        ASSING_IF_PASSED(height, context.BufferHeight);
+        return context.Buffer;
+    }
     const String &ImageFormatJPG::GetDescription()
     {
         return Description;
@@ -168,26 +226,89 @@ namespace FreeTouchDeck
 
         // This function will clip the image block rendering automatically at the TFT boundaries
 
-        if (Transparent)
+        if (ActiveContext->Transparent)
         {
-            tft.pushImage(x, y, w, h, bitmap, BGColor);
+            PushImage(x, y, w, h, bitmap, ActiveContext->BGColor);
         }
         else
         {
             // Push the pixel row to screen, pushImage will crop the line if needed
-            // y is decremented as the BMP image is drawn bottom up
-            tft.pushImage(x, y, w, h, bitmap);
+            PushImage(x, y, w, h, bitmap);
         }
 
         // Return 1 to decode next block
         return 1;
     }
-    bool ImageFormatJPG::Transparent = false;
-    uint16_t ImageFormatJPG::BGColor = TFT_BLACK;
-    uint16_t ImageFormatJPG::firstPixColor = 0;
+    bool ImageFormatJPG::buffer_output(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t *bitmap)
+    {
+        JpgDecodeContext_t &context = *ActiveContext;
+        if (x >= context.BufferWidth || y >= context.BufferHeight)
+        {
+            return 1;
+        }
+        uint16_t copyWidth = min(w, (uint16_t)(context.BufferWidth - x));
+        for (uint16_t row = 0; row < h && y + row < context.BufferHeight; row++)
+        {
+            memcpy(&context.Buffer[(y + row) * context.BufferWidth + x], &bitmap[row * w], copyWidth * sizeof(uint16_t));
+        }
+        return 1;
+    }
+    bool ImageFormatJPG::WriteCachePixels(fs::File &cacheFile)
+    {
+        JpgDecodeContext_t context;
+        // Decoded blocks come in MCU order, so a strip as high as the
+        // tallest MCU is assembled before rows are written to the cache
+        size_t stripSize = (size_t)w * JPG_MAX_MCU_HEIGHT * sizeof(uint16_t);
+        memset(&context, 0x00, sizeof(context));
+        context.Buffer = (uint16_t *)malloc(stripSize);
+        if (!context.Buffer)
+        {
+            LOC_LOGW(module, "Unable to allocate %d bytes to build the cache of %s", stripSize, LogoName.c_str());
+            return false;
+        }
+        memset(context.Buffer, 0x00, stripSize);
+        context.BufferWidth = w;
+        context.BufferHeight = JPG_MAX_MCU_HEIGHT;
+        context.CacheTarget = &cacheFile;
+        context.Success = true;
+        context.Success = Decode(context, ImageFormatJPG::cache_output, 0, 0, 1) && context.Success && FlushCacheStrip(context);
+        FREE_AND_NULL(context.Buffer);
+        return context.Success;
+    }
+    bool ImageFormatJPG::FlushCacheStrip(JpgDecodeContext_t &context)
+    {
+        size_t stripBytes = (size_t)context.StripRows * context.BufferWidth * sizeof(uint16_t);
+        if (stripBytes > 0 && context.CacheTarget->write((uint8_t *)context.Buffer, stripBytes) != stripBytes)
+        {
+            LOC_LOGE(module, "Error writing image cache");
+            return false;
+        }
+        context.StripRows = 0;
+        return true;
+    }
+    bool ImageFormatJPG::cache_output(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t *bitmap)
+    {
+        JpgDecodeContext_t &context = *ActiveContext;
+        if (!context.Success || x + w > context.BufferWidth)
+        {
+            return 0;
+        }
+        if (y + h > context.StripY + JPG_MAX_MCU_HEIGHT)
+        {
+            // block starts a new MCU row that doesn't fit in the strip
+            context.Success = FlushCacheStrip(context);
+            context.StripY = y;
+        }
+        for (uint16_t row = 0; row < h; row++)
+        {
+            memcpy(&context.Buffer[(y - context.StripY + row) * context.BufferWidth + x], &bitmap[row * w], w * sizeof(uint16_t));
+        }
+        context.StripRows = max(context.StripRows, (uint16_t)(y - context.StripY + h));
+        return context.Success;
+    }
     bool ImageFormatJPG::pixelcheck(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t *bitmap)
     {
-        firstPixColor = bitmap[0];
+        ActiveContext->FirstPixel = bitmap[0];
         return 0;
     }
 
@@ -3,12 +3,34 @@
 #include "ImageWrapper.h"
 
 
+// Largest MCU produced by the jpeg decoder (16x16 for 4:2:0 subsampling)
+#define JPG_MAX_MCU_HEIGHT 16
+
 namespace FreeTouchDeck
 {
+    // State of one decode. The decoder library only accepts plain
+    // callbacks, so the context of the running decode is published
+    // to them while the decoder is locked.
+    typedef struct
+    {
+        bool Transparent;
+        uint16_t BGColor;
+        uint16_t FirstPixel;
+        uint16_t *Buffer;
+        uint16_t BufferWidth;
+        uint16_t BufferHeight;
+        fs::File *CacheTarget;
+        uint16_t StripY;
+        uint16_t StripRows;
+        bool Success;
+    } JpgDecodeContext_t;
+    typedef bool (*JpgOutput_t)(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t *bitmap);
+
     class ImageFormatJPG : ImageWrapper
     {
     public:
         void Draw(int16_t x, int16_t y, bool transparent);
+        uint16_t *DecodeToBuffer(uint8_t scale, uint16_t *width, uint16_t *height);
         ImageFormatJPG(const std::string &imageName);
         ImageFormatJPG();
         static ImageFormatJPG * GetImageInstance(const std::string &imageName);
@@ -18,12 +40,16 @@ namespace FreeTouchDeck
         bool IsValid();
     private:
         uint16_t PixelColor;
-        static bool Transparent;
-        static uint16_t BGColor;
         static String Description;
+        static SemaphoreHandle_t xDecoderSemaphore;
+        static JpgDecodeContext_t *ActiveContext;
         bool LoadImageDetails();
+        bool Decode(JpgDecodeContext_t &context, JpgOutput_t output, int16_t x, int16_t y, uint8_t scale);
         static bool tft_output(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap);
         static bool pixelcheck(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap);
-        static uint16_t firstPixColor;
+        static bool cache_output(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap);
+        static bool buffer_output(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap);
+        static bool FlushCacheStrip(JpgDecodeContext_t &context);
+        bool WriteCachePixels(fs::File &cacheFile);
     };
-}
\ No newline at end of file
+}
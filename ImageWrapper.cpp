@@ -1,9 +1,13 @@
 #include "UserConfig.h"
 #include "Storage.h"
 #include "ImageWrapper.h"
+#include "ImageCache.h"
+#include <vector>
 static const char *module = "ImageWrapper";
 namespace FreeTouchDeck
 {
+    // "F565" in little endian
+    const uint32_t ImageWrapper::CacheSignature = 0x35363546;
     ImageWrapper::ImageWrapper()
     {
         valid = false;
@@ -14,23 +18,32 @@ namespace FreeTouchDeck
     // void ImageWrapper::Draw(int16_t x, int16_t y, bool transparent){LOC_LOGE(module,"Unsupported");};
     bool ImageWrapper::IsExtensionMatch(const char * extension, const std::string &name)
     {
-        char fileName[101] = {0};
-        String ext = FileName(fileName,sizeof(fileName), name);
-        String strExtension=String(extension);
-        strExtension.toLowerCase();
-        ext.toLowerCase();
-        return ext.endsWith(extension);
+        return strcasecmp(GetExtension(name), extension) == 0;
     }
     ImageWrapper::~ImageWrapper()
     {
-
+        ImageCache::ReleasePixels(this);
+        ImageCache::ReleaseScaledPixels(this);
+    }
+    const char *ImageWrapper::GetExtension(const std::string &fileName)
+    {
+        // points inside fileName, so nothing is allocated and
+        // concurrent callers don't share any state
+        size_t pos = fileName.find_last_of('.');
+        return pos == std::string::npos ? "" : fileName.c_str() + pos + 1;
     }
-    const std::string &ImageWrapper::GetExtension(const std::string &fileName)
+    ImageFormats ImageWrapper::GetImageFormat(const std::string &fileName)
     {
-        static std::string ext;
-        ext=fileName.substr(fileName.find_last_of(".")+1);
-        LOC_LOGD(module,"%s has extension %s",fileName.c_str(),ext.c_str());
-        return ext;
+        const char *ext = GetExtension(fileName);
+        if (strcasecmp(ext, "jpg") == 0)
+        {
+            return ImageFormats::JPG;
+        }
+        if (strcasecmp(ext, "bmp") == 0)
+        {
+            return ImageFormats::BMP;
+        }
+        return ImageFormats::UNKNOWN;
     }
     char *ImageWrapper::FileName(char *buffer, size_t buffSize, const std::string& name)
     {
@@ -44,6 +57,337 @@ namespace FreeTouchDeck
     {
         return FileName(buffer,buffSize,LogoName);
     }
+    char *ImageWrapper::CacheFileName(char *buffer, size_t buffSize, const std::string &name)
+    {
+        memset(buffer, 0x00, buffSize);
+#ifdef IMAGE_CACHE_FOLDER
+        if (name.empty())
+        {
+            return NULL;
+        }
+        int len = snprintf(buffer, buffSize, "%s/%s.565", IMAGE_CACHE_FOLDER, name.c_str());
+        if (len < 0 || len >= buffSize || len > IMAGE_CACHE_MAX_PATH)
+        {
+            // don't risk truncated names, which could collide with another image
+            LOC_LOGD(module, "Cache file name for %s is too long", name.c_str());
+            memset(buffer, 0x00, buffSize);
+            return NULL;
+        }
+        return buffer;
+#else
+        return NULL;
+#endif
+    }
+    char *ImageWrapper::CacheFileName(char *buffer, size_t buffSize)
+    {
+        return CacheFileName(buffer, buffSize, LogoName);
+    }
+    bool ImageWrapper::RemoveCache(const std::string &name)
+    {
+        char cacheName[101] = {0};
+        if (!CacheFileName(cacheName, sizeof(cacheName), name) || !ftdfs->exists(cacheName))
+        {
+            return false;
+        }
+        LOC_LOGD(module, "Removing cache file %s", cacheName);
+        return ftdfs->remove(cacheName);
+    }
+    uint8_t *ImageWrapper::GetDrawBuffer(size_t *bufferSize)
+    {
+        // Images are drawn by the screen task, and decoded or cached by the
+        // prefetch and action tasks at the same time. Each task gets its own
+        // buffer, allocated once when it first needs one
+        static SemaphoreHandle_t xDrawBuffersSemaphore = xSemaphoreCreateMutex();
+        static std::vector<std::pair<TaskHandle_t, uint8_t *>> drawBuffers;
+        TaskHandle_t task = xTaskGetCurrentTaskHandle();
+        uint8_t *drawBuffer = NULL;
+        xSemaphoreTake(xDrawBuffersSemaphore, portMAX_DELAY);
+        for (auto &entry : drawBuffers)
+        {
+            if (entry.first == task)
+            {
+                drawBuffer = entry.second;
+                break;
+            }
+        }
+        if (!drawBuffer)
+        {
+            drawBuffer = (uint8_t *)malloc_fn(IMAGE_DRAW_BUFFER_SIZE);
+            drawBuffers.push_back(std::make_pair(task, drawBuffer));
+        }
+        xSemaphoreGive(xDrawBuffersSemaphore);
+        ASSING_IF_PASSED(bufferSize, drawBuffer ? IMAGE_DRAW_BUFFER_SIZE : 0);
+        return drawBuffer;
+    }
+    uint16_t *ImageWrapper::AllocDecodeBuffer(size_t size)
+    {
+#if defined(ESP32) && defined(CONFIG_SPIRAM_SUPPORT)
+        uint32_t caps = psramFound() ? MALLOC_CAP_SPIRAM : MALLOC_CAP_8BIT;
+#else
+        uint32_t caps = MALLOC_CAP_8BIT;
+#endif
+        // not fatal, unlike malloc_fn: callers fall back to drawing from the file
+        uint16_t *buffer = (uint16_t *)heap_caps_malloc(size, caps);
+        if (!buffer)
+        {
+            LOC_LOGW(module, "Unable to allocate %d bytes to decode an image", size);
+            return NULL;
+        }
+        memset(buffer, 0x00, size);
+        return buffer;
+    }
+    uint8_t ImageWrapper::ScaleToFit(uint16_t width, uint16_t height, uint16_t maxWidth, uint16_t maxHeight)
+    {
+        uint8_t scale = 1;
+        while (scale < 8 && (width > maxWidth * scale || height > maxHeight * scale))
+        {
+            scale *= 2;
+        }
+        return scale;
+    }
+    bool ImageWrapper::IsScaledDown()
+    {
+        uint8_t cols = max(generalconfig.colscount, (uint8_t)1);
+        uint8_t rows = max(generalconfig.rowscount, (uint8_t)1);
+        return ScaleToFit(w, h, tft.width() / cols, tft.height() / rows) > 1;
+    }
+    void ImageWrapper::SetSourceDetails(fs::File &source)
+    {
+        SourceSize = source.size();
+        SourceTime = (uint32_t)source.getLastWrite();
+    }
+    bool ImageWrapper::CheckCache()
+    {
+        char cacheName[101] = {0};
+        RawCacheHeader_t header;
+        CacheValid = false;
+        if (!valid || !CacheFileName(cacheName, sizeof(cacheName)))
+        {
+            return false;
+        }
+        if (!ftdfs->exists(cacheName))
+        {
+            LOC_LOGD(module, "No cache file found for %s", LogoName.c_str());
+            return false;
+        }
+        fs::File cacheFile = ftdfs->open(cacheName, FILE_READ);
+        if (!cacheFile)
+        {
+            return false;
+        }
+        size_t expectedSize = sizeof(header) + (size_t)w * h * sizeof(uint16_t);
+        if (cacheFile.read((uint8_t *)&header, sizeof(header)) == sizeof(header) && cacheFile.size() == expectedSize)
+        {
+            CacheValid = header.Signature == CacheSignature && header.Width == w && header.Height == h && header.PixelColor == GetPixelColor() && header.SourceSize == SourceSize && header.SourceTime == SourceTime;
+        }
+        cacheFile.close();
+        if (!CacheValid)
+        {
+            LOC_LOGI(module, "Cache file %s is out of date", cacheName);
+        }
+        return CacheValid;
+    }
+    bool ImageWrapper::BuildCache()
+    {
+        char cacheName[101] = {0};
+        RawCacheHeader_t header;
+        CacheValid = false;
+        if (!valid || !CacheFileName(cacheName, sizeof(cacheName)))
+        {
+            return false;
+        }
+#ifdef IMAGE_CACHE_FOLDER
+        if (!ftdfs->exists(IMAGE_CACHE_FOLDER))
+        {
+            // SPIFFS has a flat structure and doesn't need the folder, so
+            // the result is ignored here. Opening the file will tell.
+            ftdfs->mkdir(IMAGE_CACHE_FOLDER);
+        }
+#endif
+        LOC_LOGI(module, "Building cache file %s", cacheName);
+        PrintMemInfo(__FUNCTION__, __LINE__);
+        fs::File cacheFile = ftdfs->open(cacheName, FILE_WRITE);
+        if (!cacheFile)
+        {
+            LOC_LOGW(module, "Unable to create cache file %s", cacheName);
+            return false;
+        }
+        memset(&header, 0x00, sizeof(header));
+        header.Signature = CacheSignature;
+        header.Width = w;
+        header.Height = h;
+        header.PixelColor = GetPixelColor();
+        header.SourceTime = SourceTime;
+        header.SourceSize = SourceSize;
+        bool success = cacheFile.write((uint8_t *)&header, sizeof(header)) == sizeof(header);
+        success = success && WriteCachePixels(cacheFile);
+        size_t written = cacheFile.size();
+        cacheFile.close();
+        if (!success || written != sizeof(header) + (size_t)w * h * sizeof(uint16_t))
+        {
+            LOC_LOGW(module, "Could not write cache file %s. Removing it.", cacheName);
+            ftdfs->remove(cacheName);
+            return false;
+        }
+        PrintMemInfo(__FUNCTION__, __LINE__);
+        CacheValid = true;
+        return true;
+    }
+    uint16_t *ImageWrapper::LoadPixels(const char *cacheName)
+    {
+        size_t pixelsSize = (size_t)w * h * sizeof(uint16_t);
+        if (!ImageCache::Lock())
+        {
+            return NULL;
+        }
+        uint16_t *pixels = ImageCache::AllocPixels(this, pixelsSize);
+        if (!pixels)
+        {
+            ImageCache::Unlock();
+            return NULL;
+        }
+        fs::File cacheFile = ftdfs->open(cacheName, FILE_READ);
+        if (!cacheFile || !cacheFile.seek(sizeof(RawCacheHeader_t)) || cacheFile.read((uint8_t *)pixels, pixelsSize) != pixelsSize)
+        {
+            LOC_LOGW(module, "Unable to load pixels from cache file %s", cacheName);
+            ImageCache::ReleasePixels(this);
+            pixels = NULL;
+        }
+        if (cacheFile)
+        {
+            cacheFile.close();
+        }
+        ImageCache::Unlock();
+        return pixels;
+    }
+    bool ImageWrapper::Prefetch()
+    {
+        char cacheName[101] = {0};
+        bool loaded = false;
+        if (!valid || !CacheValid || !CacheFileName(cacheName, sizeof(cacheName)) || !ImageCache::Lock())
+        {
+            return false;
+        }
+        // only fill free room, so the images on screen aren't evicted
+        loaded = Pixels || (ImageCache::CanHoldPixels((size_t)w * h * sizeof(uint16_t)) && LoadPixels(cacheName));
+        ImageCache::Unlock();
+        return loaded;
+    }
+    bool ImageWrapper::DrawTo(TFT_eSprite &canvas, int16_t x, int16_t y, bool transparent)
+    {
+        char cacheName[101] = {0};
+        if (!valid || !CacheValid || !CacheFileName(cacheName, sizeof(cacheName)))
+        {
+            return false;
+        }
+        if (!ImageCache::Lock())
+        {
+            return false;
+        }
+        uint16_t *pixels = ImageCache::GetPixels(this);
+        if (!pixels)
+        {
+            pixels = LoadPixels(cacheName);
+        }
+        if (!pixels)
+        {
+            ImageCache::Unlock();
+            return false;
+        }
+        uint16_t BGColor = GetPixelColor();
+        // cached pixels are in native byte order, as for the screen
+        canvas.setSwapBytes(true);
+        if (BGColor == TFT_BLACK || transparent)
+        {
+            canvas.pushImage(x - w / 2, y - h / 2, w, h, pixels, BGColor);
+        }
+        else
+        {
+            canvas.pushImage(x - w / 2, y - h / 2, w, h, pixels);
+        }
+        ImageCache::Unlock();
+        return true;
+    }
+    bool ImageWrapper::DrawCache(int16_t x, int16_t y, bool transparent)
+    {
+        char cacheName[101] = {0};
+        size_t bufferSize = 0;
+        uint16_t *buffer = NULL;
+        size_t lineSize = (size_t)w * sizeof(uint16_t);
+        if (!CacheValid || !CacheFileName(cacheName, sizeof(cacheName)) || !ImageCache::Lock())
+        {
+            return false;
+        }
+        uint16_t *pixels = ImageCache::GetPixels(this);
+        if (!pixels)
+        {
+            pixels = LoadPixels(cacheName);
+        }
+        if (!pixels)
+        {
+            // pixels are read from flash, other tasks may use the image cache meanwhile
+            ImageCache::Unlock();
+            buffer = (uint16_t *)GetDrawBuffer(&bufferSize);
+            if (!buffer || lineSize == 0 || lineSize > bufferSize)
+            {
+                LOC_LOGD(module, "Image %s is too wide to be drawn from cache", LogoName.c_str());
+                return false;
+            }
+        }
+        fs::File cacheFile;
+        if (!pixels)
+        {
+            cacheFile = ftdfs->open(cacheName, FILE_READ);
+            if (!cacheFile)
+            {
+                LOC_LOGW(module, "Unable to open cache file %s", cacheName);
+                CacheValid = false;
+                return false;
+            }
+            cacheFile.seek(sizeof(RawCacheHeader_t));
+        }
+        LOC_LOGD(module, "Drawing %s from %s at [%d,%d]", LogoName.c_str(), pixels ? "memory" : "cache", x, y);
+        uint16_t BGColor = GetPixelColor();
+        bool Transparent = ((BGColor == TFT_BLACK) || transparent);
+        bool oldSwapBytes = tft.getSwapBytes();
+        tft.setSwapBytes(true);
+        int16_t lx = x - w / 2;
+        int16_t ly = y - h / 2;
+        // pixels held in memory are pushed in one go
+        uint16_t linesPerRead = pixels ? h : bufferSize / lineSize;
+        for (uint16_t row = 0; row < h; row += linesPerRead)
+        {
+            uint16_t lines = min((uint16_t)(h - row), linesPerRead);
+            if (pixels)
+            {
+                buffer = pixels;
+            }
+            else if (cacheFile.read((uint8_t *)buffer, lines * lineSize) != lines * lineSize)
+            {
+                LOC_LOGE(module, "Cache file %s is truncated", cacheName);
+                CacheValid = false;
+                break;
+            }
+            if (Transparent)
+            {
+                PushImage(lx, ly + row, w, lines, buffer, BGColor);
+            }
+            else
+            {
+                PushImage(lx, ly + row, w, lines, buffer);
+            }
+        }
+        if (cacheFile)
+        {
+            cacheFile.close();
+        }
+        if (pixels)
+        {
+            ImageCache::Unlock();
+        }
+        tft.setSwapBytes(oldSwapBytes);
+        return true;
+    }
 
     ImageWrapper::ImageWrapper(const std::string  &imageName)
     {
@@ -4,6 +4,25 @@
 #include <functional>
 namespace FreeTouchDeck
 {
+    class ImageCache;
+    enum class ImageFormats
+    {
+        UNKNOWN,
+        BMP,
+        JPG
+    };
+    // Header of the pre-decoded RGB565 copy of an image. Pixels
+    // follow the header, top row first, in native byte order
+    typedef struct
+    {
+        uint32_t Signature;
+        uint16_t Width;
+        uint16_t Height;
+        uint16_t PixelColor;
+        uint16_t Reserved;
+        uint32_t SourceTime;
+        uint32_t SourceSize;
+    } RawCacheHeader_t;
 
     class ImageWrapper
     {
@@ -13,10 +32,13 @@ namespace FreeTouchDeck
         char *FileName(char *buffer, size_t buffSize);
         static char *FileName(char *buffer, size_t buffSize,const std::string& name);
         char *CacheFileName(char *buffer, size_t buffSize);
+        static char *CacheFileName(char *buffer, size_t buffSize, const std::string &name);
+        static bool RemoveCache(const std::string &name);
         std::string LogoName ;
         static char * Extension[31];
         virtual const String& GetDescription()=0;
-        static const std::string &GetExtension(const std::string &fileName);
+        static const char *GetExtension(const std::string &fileName);
+        static ImageFormats GetImageFormat(const std::string &fileName);
         uint16_t w = 0;
         uint16_t h = 0;
         ImageWrapper(const std::string &imageName);
@@ -25,14 +47,55 @@ namespace FreeTouchDeck
         ~ImageWrapper();
         virtual const std::string &GetLogoName()=0;
         virtual void Draw(int16_t x, int16_t y, bool transparent)=0;
+        bool DrawTo(TFT_eSprite &canvas, int16_t x, int16_t y, bool transparent);
+        /**
+* @brief Decodes the image to a new RGB565 buffer, in native byte order.
+*
+* @param scale uint8_t 1, 2, 4 or 8 to decode at 1/scale of the image size
+* @param width uint16_t * receives the width of the decoded image
+* @param height uint16_t * receives the height of the decoded image
+*
+* @return uint16_t * buffer to be freed by the caller, NULL on failure
+*
+* @note Decoding state is kept per call, so it can run from any task
+*/
+        virtual uint16_t *DecodeToBuffer(uint8_t scale, uint16_t *width, uint16_t *height)=0;
+        /**
+* @brief Loads the pre-decoded pixels of the image in memory, if the
+*        pixel cache has room left for them, so the next draw doesn't
+*        read the file system.
+*
+* @return bool true when the pixels are held in memory
+*/
+        bool Prefetch();
+        static uint8_t ScaleToFit(uint16_t width, uint16_t height, uint16_t maxWidth, uint16_t maxHeight);
         virtual bool IsValid()=0;
     protected:
+        friend class ImageCache;
+        static const uint32_t CacheSignature;
+        bool CacheValid = false;
+        uint32_t SourceTime = 0;
+        uint32_t SourceSize = 0;
+        // Pixels kept in memory by the image cache, if any
+        uint16_t *Pixels = NULL;
+        size_t PixelsSize = 0;
+        uint32_t PixelsLastUsed = 0;
         static uint16_t read16(fs::File &f);
         static uint32_t read32(fs::File &f);
         static bool IsExtensionMatch(const char * extension,const std::string &fileName);
+        static uint8_t *GetDrawBuffer(size_t *bufferSize);
+        static uint16_t *AllocDecodeBuffer(size_t size);
         bool SetNameAndPath(const std::string &imageName);
+        void SetSourceDetails(fs::File &source);
+        bool CheckCache();
+        bool BuildCache();
+        // true when larger than a button of the configured grid
+        bool IsScaledDown();
+        bool DrawCache(int16_t x, int16_t y, bool transparent);
+        uint16_t *LoadPixels(const char *cacheName);
+        virtual bool WriteCachePixels(fs::File &cacheFile)=0;
         virtual bool LoadImageDetails()=0;
     };
     typedef std::function<ImageWrapper *(const std::string &)> ImageInstanceGet_t;
-    typedef std::map<const std::string, ImageInstanceGet_t> ImageInstanceGetMap_t;
-}
\ No newline at end of file
+    typedef std::map<ImageFormats, ImageInstanceGet_t> ImageInstanceGetMap_t;
+}
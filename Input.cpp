@@ -0,0 +1,168 @@
+#include "Input.h"
+#include "System.h"
+#include "RingQueue.h"
+#include "FTAction.h"
+#include <atomic>
+namespace FreeTouchDeck
+{
+    static const char *module = "Input";
+    // State of the touch being tracked, only used by the sampling task
+    typedef struct
+    {
+        bool LongPressSent;
+        uint16_t StartX;
+        uint16_t StartY;
+        uint16_t LastX;
+        uint16_t LastY;
+        uint32_t StartTime;
+        uint32_t LastTouchTime;
+    } TouchTracker_t;
+    static TouchTracker_t Tracker;
+    static std::atomic<bool> Touched{false};
+    static RingQueue<InputEvent_t, INPUT_EVENT_QUEUE_SIZE> Events;
+    static TaskHandle_t xInputTask = NULL;
+
+    const char *enum_to_string(InputEventType type)
+    {
+        switch (type)
+        {
+            ENUM_TO_STRING_HELPER(InputEventType, NONE);
+            ENUM_TO_STRING_HELPER(InputEventType, PRESS);
+            ENUM_TO_STRING_HELPER(InputEventType, RELEASE);
+            ENUM_TO_STRING_HELPER(InputEventType, LONG_PRESS);
+            ENUM_TO_STRING_HELPER(InputEventType, SWIPE_LEFT);
+            ENUM_TO_STRING_HELPER(InputEventType, SWIPE_RIGHT);
+            ENUM_TO_STRING_HELPER(InputEventType, SWIPE_UP);
+            ENUM_TO_STRING_HELPER(InputEventType, SWIPE_DOWN);
+        default:
+            return "Unknown";
+        }
+    }
+    static void PushEvent(InputEventType type, uint16_t x, uint16_t y, uint32_t time)
+    {
+        InputEvent_t event = {type, x, y, time};
+        LOC_LOGD(module, "Touch event %s at [%d,%d]", enum_to_string(type), x, y);
+        if (!Events.Push(event))
+        {
+            LOC_LOGW(module, "Touch event queue is full. Dropping %s event", enum_to_string(type));
+        }
+    }
+    static InputEventType GetReleaseType()
+    {
+        int32_t dx = (int32_t)Tracker.LastX - Tracker.StartX;
+        int32_t dy = (int32_t)Tracker.LastY - Tracker.StartY;
+        if (Tracker.LastTouchTime - Tracker.StartTime > INPUT_SWIPE_MAX_MS || max(abs(dx), abs(dy)) < INPUT_SWIPE_MIN_DISTANCE)
+        {
+            return InputEventType::RELEASE;
+        }
+        if (abs(dx) >= abs(dy))
+        {
+            return dx > 0 ? InputEventType::SWIPE_RIGHT : InputEventType::SWIPE_LEFT;
+        }
+        return dy > 0 ? InputEventType::SWIPE_DOWN : InputEventType::SWIPE_UP;
+    }
+    static void ProcessSample(bool pressed, uint16_t x, uint16_t y, uint32_t now)
+    {
+        if (pressed)
+        {
+            Tracker.LastX = x;
+            Tracker.LastY = y;
+            Tracker.LastTouchTime = now;
+            if (!Touched)
+            {
+                Tracker.StartX = x;
+                Tracker.StartY = y;
+                Tracker.StartTime = now;
+                Tracker.LongPressSent = false;
+                Touched = true;
+                PushEvent(InputEventType::PRESS, x, y, now);
+            }
+            else if (!Tracker.LongPressSent && now - Tracker.StartTime >= INPUT_LONG_PRESS_MS &&
+                     max(abs((int32_t)x - Tracker.StartX), abs((int32_t)y - Tracker.StartY)) < INPUT_SWIPE_MIN_DISTANCE)
+            {
+                Tracker.LongPressSent = true;
+                PushEvent(InputEventType::LONG_PRESS, x, y, now);
+            }
+            return;
+        }
+        // short losses of contact are ignored
+        if (!Touched || now - Tracker.LastTouchTime < INPUT_DEBOUNCE_MS)
+        {
+            return;
+        }
+        Touched = false;
+        PushEvent(GetReleaseType(), Tracker.LastX, Tracker.LastY, Tracker.LastTouchTime);
+    }
+#if defined(USECAPTOUCH) && defined(INPUT_TOUCH_TASK)
+    static void IRAM_ATTR TouchInterrupt()
+    {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(xInputTask, &woken);
+        if (woken)
+        {
+            portYIELD_FROM_ISR();
+        }
+    }
+    static void InputTask(void *pvParameters)
+    {
+        uint16_t x = 0;
+        uint16_t y = 0;
+        for (;;)
+        {
+            // an interrupt missed while sampling is caught up on by the timeout
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+            TickType_t lastWake = xTaskGetTickCount();
+            do
+            {
+                bool pressed = getTouch(&x, &y);
+                ProcessSample(pressed, x, y, millis());
+                vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(INPUT_SAMPLE_PERIOD_MS));
+            } while (Touched);
+        }
+    }
+#endif
+    void InputInit()
+    {
+#if defined(USECAPTOUCH) && defined(INPUT_TOUCH_TASK)
+        if (touchInterruptPin < 0 || xInputTask)
+        {
+            return;
+        }
+        xTaskCreate(InputTask, "Input", 1024 * 3, NULL, tskIDLE_PRIORITY + 6, &xInputTask);
+        pinMode(touchInterruptPin, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(touchInterruptPin), TouchInterrupt, FALLING);
+        LOC_LOGI(module, "Touch input sampled every %dms from interrupt on pin %d", INPUT_SAMPLE_PERIOD_MS, touchInterruptPin);
+#endif
+    }
+    void InputPoll()
+    {
+        uint16_t x = 0;
+        uint16_t y = 0;
+        if (xInputTask)
+        {
+            return;
+        }
+        bool pressed = getTouch(&x, &y);
+        ProcessSample(pressed, x, y, millis());
+    }
+    bool PopInputEvent(InputEvent_t &event)
+    {
+        return Events.Pop(event);
+    }
+    bool InputWait(TickType_t xTicksToWait)
+    {
+        return Events.Wait(xTicksToWait, ScreenQueuePending);
+    }
+    void InputWake()
+    {
+        Events.Wake();
+    }
+    bool InputTouched()
+    {
+        return Touched;
+    }
+    bool InputTaskRunning()
+    {
+        return xInputTask != NULL;
+    }
+}
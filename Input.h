@@ -0,0 +1,58 @@
+#pragma once
+#include "globals.hpp"
+#include "UserConfig.h"
+namespace FreeTouchDeck
+{
+    enum class InputEventType
+    {
+        NONE,
+        PRESS,
+        RELEASE,
+        LONG_PRESS,
+        SWIPE_LEFT,
+        SWIPE_RIGHT,
+        SWIPE_UP,
+        SWIPE_DOWN
+    };
+    const char *enum_to_string(InputEventType type);
+    typedef struct
+    {
+        InputEventType Type;
+        uint16_t x;
+        uint16_t y;
+        // time the event was detected, in milliseconds
+        uint32_t Time;
+    } InputEvent_t;
+
+    /**
+* @brief Starts sampling the touch screen from a task, woken by the
+*        touch controller interrupt.
+*
+* @note Without a capacitive touch controller and an interrupt pin, the
+*       screen is sampled by InputPoll instead
+*/
+    void InputInit();
+    /**
+* @brief Samples the touch screen from the calling task, when no input
+*        task was started.
+*/
+    void InputPoll();
+    /**
+* @brief Removes the oldest touch event.
+*
+* @param event InputEvent_t & receives the event
+*
+* @return bool true when an event was removed
+*
+* @note Must always be called from the same task
+*/
+    bool PopInputEvent(InputEvent_t &event);
+    // Waits for a touch event, without removing it. Actions queued for the
+    // screen task end the wait as well
+    bool InputWait(TickType_t xTicksToWait);
+    // Ends the wait of InputWait, for other work of the screen task
+    void InputWake();
+    // Debounced touch state, read without accessing the touch controller
+    bool InputTouched();
+    bool InputTaskRunning();
+}
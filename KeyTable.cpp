@@ -0,0 +1,85 @@
+#include "KeyTable.h"
+#include "BleKeyboard.h"
+namespace FreeTouchDeck
+{
+#define KEY_ENTRY(k)                            \
+    {                                           \
+        QUOTE(k), {KEY_##k, 0}, 1, false, false \
+    }
+#define MODIFIER_ENTRY(k)                      \
+    {                                          \
+        QUOTE(k), {KEY_##k, 0}, 1, true, false \
+    }
+#define MEDIAKEY_ENTRY(k)                                              \
+    {                                                                  \
+        QUOTE(k), {KEY_MEDIA_##k[0], KEY_MEDIA_##k[1]}, 2, false, true \
+    }
+    constexpr KeyEntry_t KeyTable[] = {
+        MEDIAKEY_ENTRY(MUTE), MEDIAKEY_ENTRY(VOLUME_DOWN), MEDIAKEY_ENTRY(VOLUME_UP), MEDIAKEY_ENTRY(PLAY_PAUSE), MEDIAKEY_ENTRY(STOP), MEDIAKEY_ENTRY(NEXT_TRACK), MEDIAKEY_ENTRY(PREVIOUS_TRACK), MEDIAKEY_ENTRY(WWW_HOME), MEDIAKEY_ENTRY(LOCAL_MACHINE_BROWSER), MEDIAKEY_ENTRY(CALCULATOR), MEDIAKEY_ENTRY(WWW_BOOKMARKS), MEDIAKEY_ENTRY(WWW_SEARCH), MEDIAKEY_ENTRY(WWW_STOP), MEDIAKEY_ENTRY(WWW_BACK), MEDIAKEY_ENTRY(CONSUMER_CONTROL_CONFIGURATION), MEDIAKEY_ENTRY(EMAIL_READER),
+        KEY_ENTRY(F1), KEY_ENTRY(F2), KEY_ENTRY(F3), KEY_ENTRY(F4), KEY_ENTRY(F5), KEY_ENTRY(F6), KEY_ENTRY(F7), KEY_ENTRY(F8), KEY_ENTRY(F9), KEY_ENTRY(F10), KEY_ENTRY(F11), KEY_ENTRY(F12), KEY_ENTRY(F13), KEY_ENTRY(F14), KEY_ENTRY(F15), KEY_ENTRY(F16), KEY_ENTRY(F17), KEY_ENTRY(F18), KEY_ENTRY(F19), KEY_ENTRY(F20), KEY_ENTRY(F21), KEY_ENTRY(F22), KEY_ENTRY(F23), KEY_ENTRY(F24),
+        KEY_ENTRY(UP_ARROW), KEY_ENTRY(DOWN_ARROW), KEY_ENTRY(LEFT_ARROW), KEY_ENTRY(RIGHT_ARROW), KEY_ENTRY(BACKSPACE), KEY_ENTRY(TAB), KEY_ENTRY(RETURN), KEY_ENTRY(PAGE_UP), KEY_ENTRY(PAGE_DOWN), KEY_ENTRY(DELETE),
+        MODIFIER_ENTRY(LEFT_CTRL), MODIFIER_ENTRY(LEFT_SHIFT), MODIFIER_ENTRY(LEFT_ALT), MODIFIER_ENTRY(LEFT_GUI), MODIFIER_ENTRY(RIGHT_CTRL), MODIFIER_ENTRY(RIGHT_SHIFT), MODIFIER_ENTRY(RIGHT_ALT), MODIFIER_ENTRY(RIGHT_GUI)};
+    constexpr size_t KeyCount = sizeof(KeyTable) / sizeof(KeyTable[0]);
+    const size_t KeyTableSize = KeyCount;
+
+    // The seed was searched so that no two key names share a slot. When
+    // keys are added and the static_assert below fails, search a new one.
+#define KEY_HASH_SEED 3024
+#define KEY_HASH_SLOTS 256
+#define KEY_NO_ENTRY 0xFF
+    static_assert(KeyCount < KEY_NO_ENTRY, "Too many keys for the slot table");
+
+    // FNV-1a, written as a single expression so the table can be built by the compiler
+    constexpr uint32_t KeyHash(const char *name, uint32_t hash = 2166136261u ^ KEY_HASH_SEED)
+    {
+        return *name ? KeyHash(name + 1, (hash ^ (uint8_t)*name) * 16777619u) : hash ^ (hash >> 16);
+    }
+    constexpr size_t KeySlot(const char *name)
+    {
+        return KeyHash(name) & (KEY_HASH_SLOTS - 1);
+    }
+    constexpr uint8_t SlotEntry(size_t slot, size_t index = 0)
+    {
+        return index >= KeyCount ? KEY_NO_ENTRY : KeySlot(KeyTable[index].Name) == slot ? index : SlotEntry(slot, index + 1);
+    }
+    // number of keys that aren't the first key of their slot
+    constexpr size_t KeyCollisions(size_t index = 0)
+    {
+        return index >= KeyCount ? 0 : (SlotEntry(KeySlot(KeyTable[index].Name)) != index) + KeyCollisions(index + 1);
+    }
+    static_assert(KeyCollisions() == 0, "Key names collide in the slot table, change KEY_HASH_SEED");
+
+    template <size_t... I>
+    struct IndexList
+    {
+    };
+    template <size_t N, size_t... I>
+    struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...>
+    {
+    };
+    template <size_t... I>
+    struct MakeIndexList<0, I...>
+    {
+        typedef IndexList<I...> Type;
+    };
+    template <size_t... I>
+    constexpr std::array<uint8_t, sizeof...(I)> BuildSlots(IndexList<I...>)
+    {
+        return {{SlotEntry(I)...}};
+    }
+    constexpr std::array<uint8_t, KEY_HASH_SLOTS> KeySlots = BuildSlots(MakeIndexList<KEY_HASH_SLOTS>::Type());
+
+    const KeyEntry_t *FindKey(const char *name)
+    {
+        if (ISNULLSTRING(name))
+        {
+            return NULL;
+        }
+        uint8_t index = KeySlots[KeySlot(name)];
+        if (index == KEY_NO_ENTRY || strcmp(KeyTable[index].Name, name) != 0)
+        {
+            return NULL;
+        }
+        return &KeyTable[index];
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "globals.hpp"
+namespace FreeTouchDeck
+{
+    typedef struct
+    {
+        const char *Name;
+        uint8_t Value[2];
+        uint8_t Size;
+        bool NeedsRelease;
+        bool DoubleBytes;
+    } KeyEntry_t;
+    /**
+* @brief Finds a key by name in the perfect hash table of key names.
+*
+* @param name const char * key name, e.g. LEFT_CTRL, F5 or VOLUME_UP
+*
+* @return const KeyEntry_t * key code and flags, NULL if the name is not a key
+*/
+    const KeyEntry_t *FindKey(const char *name);
+    // Key entries, in definition order
+    extern const KeyEntry_t KeyTable[];
+    extern const size_t KeyTableSize;
+}
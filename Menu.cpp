@@ -1,12 +1,15 @@
 #include "Menu.h"
 #include <cstdlib>
 #include "System.h"
+#include "CompiledMenus.h"
+#include "MenuNavigation.h"
 
 namespace FreeTouchDeck
 {
     static const char *module = "Menu";
     static const char *nameTemplate = "/config/%s.json";
     FTAction *Menu::homeMenu = new FTAction(ParametersList_t({"MENU", "home"}));
+    FTAction *Menu::backMenu = new FTAction(ParametersList_t({"MENU", "~BACK"}));
     bool Menu::Button(FTAction *action)
     {
         bool success = false;
@@ -60,6 +63,33 @@ namespace FreeTouchDeck
             FTButton::BackButton->DrawImage(force);
         }
     }
+    void Menu::Draw(bool force)
+    {
+        // Buttons of the grid never overlap, each one that changed draws
+        // itself once. Untouched buttons are skipped
+        for (int i = 0; i < buttons.size(); i++)
+        {
+            if (force)
+            {
+                buttons.at(i).Invalidate();
+            }
+            if (buttons.at(i).IsDirty())
+            {
+                buttons.at(i).Draw(false);
+            }
+        }
+        if (HasBackButton())
+        {
+            if (force)
+            {
+                FTButton::BackButton->Invalidate();
+            }
+            if (FTButton::BackButton->IsDirty())
+            {
+                FTButton::BackButton->Draw(false);
+            }
+        }
+    }
     Menu::~Menu()
     {
         LOC_LOGD(module, "Freeing memory for menu %s", Name.c_str());
@@ -102,6 +132,7 @@ namespace FreeTouchDeck
         {
             tft.fillScreen(BackgroundColor);
             Active = true;
+            LastActive = millis();
             LOC_LOGD(module, "Activating menu %s", Name.c_str());
             if (HasBackButton())
             {
@@ -117,6 +148,49 @@ namespace FreeTouchDeck
             }
         }
     }
+    bool Menu::Load()
+    {
+        if (Loaded)
+        {
+            return true;
+        }
+        UnloadColdMenus();
+        if (heap_caps_get_free_size(MALLOC_CAP_8BIT) < MENU_LOAD_MIN_FREE_HEAP)
+        {
+            LOC_LOGE(module, "Not enough memory to load menu %s", Name.c_str());
+            return false;
+        }
+        Loaded = LoadCompiledMenu(this);
+        return Loaded;
+    }
+    bool Menu::CanUnload()
+    {
+        if (!Loaded || ImageOffset == 0 || Active || Pressed)
+        {
+            return false;
+        }
+        // the state of latched buttons is only kept in memory
+        for (FTButton &button : buttons)
+        {
+            if (button.IsLatched())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    void Menu::Unload()
+    {
+        if (!CanUnload())
+        {
+            return;
+        }
+        LOC_LOGD(module, "Unloading menu %s", Name.c_str());
+        // the local actions and the code of the sequences stay with the compiled image
+        std::vector<FTButton>().swap(buttons);
+        ActionSequencesList().swap(Actions);
+        Loaded = false;
+    }
     void Menu::Deactivate()
     {
         if (Active)
@@ -175,6 +249,51 @@ namespace FreeTouchDeck
             LOC_LOGD(module, "No button was found under touch coordinates");
         }
     }
+    void Menu::Touch(const InputEvent_t &event)
+    {
+        switch (event.Type)
+        {
+        case InputEventType::PRESS:
+        case InputEventType::LONG_PRESS:
+            Touch(event.x, event.y);
+            break;
+        case InputEventType::RELEASE:
+            // the finger may have moved to another button since the press
+            Touch(event.x, event.y);
+            ReleaseAll();
+            break;
+        case InputEventType::SWIPE_RIGHT:
+            CancelPress();
+            if (HasBackButton())
+            {
+                CancelLane(ActionLane::HID);
+                QueueAction(backMenu);
+            }
+            break;
+        case InputEventType::SWIPE_LEFT:
+        case InputEventType::SWIPE_UP:
+        case InputEventType::SWIPE_DOWN:
+            CancelPress();
+            break;
+        default:
+            break;
+        }
+    }
+    void Menu::CancelPress()
+    {
+        if (!Pressed)
+            return;
+        // a swipe isn't a button press, buttons are released without running their actions
+        Pressed = false;
+        for (int i = 0; i < buttons.size(); i++)
+        {
+            buttons.at(i).UnPress();
+        }
+        if (HasBackButton())
+        {
+            FTButton::BackButton->UnPress();
+        }
+    }
     const char *Menu::JsonLabelName = "name";
     const char *Menu::JsonLabelIcon = "logo";
     const char *Menu::JsonLabelBackgroundColor = "backgroundcolor";
@@ -288,6 +407,7 @@ namespace FreeTouchDeck
     {
         Name = name;
         Label = label;
+        Icon = icon;
         LOC_LOGD(module, "Label %s, name: %s", Label.c_str(), Name.c_str());
         RowsCount = rowsCount;
         ColsCount = colsCount;
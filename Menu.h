@@ -6,6 +6,7 @@
 #include "cJSON.h" // using cJSON for menu processing
 #include <FS.h>    // Filesystem support header
 #include "FTButton.h"
+#include "Input.h"
 #include "UserConfig.h"
 #include "globals.hpp"
 
@@ -47,27 +48,41 @@ namespace FreeTouchDeck
     uint32_t BackgroundColor = TFT_BLACK;
     MenuTypes Type = MenuTypes::STANDARD;
     bool Active = false;
+    // Menus of the compiled image are loaded when first shown, and can be unloaded when memory runs low
     bool Loaded = true;
+    // position of the menu in the compiled image, 0 when the menu was built from JSON
+    uint32_t ImageOffset = 0;
+    // millis() when the menu was last activated
+    uint32_t LastActive = 0;
     std::vector<FTButton> buttons;
     bool Pressed = false;
     Menu(cJSON *menuJson);
     Menu(MenuTypes menutype, const char *name, const char *label, const char *icon, uint8_t rowsCount, uint8_t colsCount, uint32_t backgroundColor, uint32_t outline, uint32_t textColor, uint8_t textSize);
     void DrawShape(bool force = false);
     void DrawImages(bool force = false);
+    void Draw(bool force = false);
     ~Menu();
     void Touch(uint16_t x, uint16_t y);
+    void Touch(const InputEvent_t &event);
     void ReleaseAll();
+    void CancelPress();
     void Activate();
     //    void Init(uint8_t rowsCount, uint8_t colsCount);
     bool Button(FTAction *action);
     FTButton &GetButton(const std::string &buttonName);
     void Deactivate();
+    bool Load();
+    bool CanUnload();
+    void Unload();
     cJSON *ToJSON();
     static Menu *FromJson(const char *jsonString);
     uint16_t ButtonWidth = 0;
     uint16_t ButtonHeight = 0;
     void AddButton(FTButton &button);
     ActionSequencesList Actions;
+    inline uint32_t GetOutline() { return _outline; }
+    inline uint32_t GetTextColor() { return _textColor; }
+    inline uint8_t GetTextSize() { return _textSize; }
 
   private:
     uint32_t _outline = 0xFFFFFFFF;
@@ -82,6 +97,7 @@ namespace FreeTouchDeck
       return Type != MenuTypes::EMPTY && Type != MenuTypes::ROOT && Type != MenuTypes::SYSTEM;
     }
     static FTAction *homeMenu;
+    static FTAction *backMenu;
   };
   inline MenuTypes &operator++(MenuTypes &state, int)
   {
@@ -2,9 +2,15 @@
 #include "Menu.h"
 #include "FTAction.h"
 #include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <atomic>
 #include <TFT_eSPI.h>
 #include "FTAction.h"
 #include "Storage.h"
+#include "ImageCache.h"
+#include "CompiledMenus.h"
+#include "ConfigStore.h"
 namespace FreeTouchDeck
 {
     FTAction *sleepSetLatchAction = new FTAction(ParametersList_t({"LATCH", "Preferences", "Sleep", "ON"}));
@@ -81,6 +87,13 @@ namespace FreeTouchDeck
     static const char *module = "MenuNavigation";
     using namespace std;
     std::vector<Menu *> Menus;
+    // position of the menus in Menus, by name
+    static std::unordered_map<std::string, size_t> MenuIndex;
+    // Published under the screen lock, read by the display and input handling without it
+    static std::atomic<Menu *> ActiveMenu{NULL};
+    // Replaced menus, deleted by the display handling once it no longer draws them
+    static std::vector<Menu *> RetiredMenus;
+    static std::atomic<bool> HasRetiredMenus{false};
     SemaphoreHandle_t xScreenSemaphore = xSemaphoreCreateMutex();
     bool ScreenLock(TickType_t xTicksToWait)
     {
@@ -102,30 +115,141 @@ namespace FreeTouchDeck
         //LOC_LOGD(TAG, "Screen object unlocked!");
         xSemaphoreGive(xScreenSemaphore);
     }
-    Menu *GetActiveScreen()
+    // Called with the screen lock held
+    static Menu *FindMenu(const char *name)
     {
-        Menu *ActiveScreen = NULL;
-        LOC_LOGV(TAG, "Getting active screen");
-        if (ScreenLock(portMAX_DELAY / portTICK_PERIOD_MS))
+        auto found = MenuIndex.find(name);
+        return found == MenuIndex.end() ? NULL : Menus[found->second];
+    }
+#ifdef MENU_PREFETCH
+    static TaskHandle_t xPrefetchTask = NULL;
+    // images waiting to be loaded, guarded by the screen lock
+    static std::vector<std::string> PrefetchImages;
+    // bumped to abandon the images being loaded by the prefetch task
+    static volatile uint32_t PrefetchGeneration = 0;
+    static void PrefetchTask(void *pvParameters)
+    {
+        std::vector<std::string> images;
+        for (;;)
         {
-            for (auto m : Menus)
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            uint32_t generation = 0;
+            if (!ScreenLock(portMAX_DELAY / portTICK_PERIOD_MS))
             {
-                if (m->Active)
+                continue;
+            }
+            images.swap(PrefetchImages);
+            generation = PrefetchGeneration;
+            ScreenUnlock();
+            size_t loaded = 0;
+            uint32_t start = millis();
+            for (auto &name : images)
+            {
+                if (generation != PrefetchGeneration)
                 {
-                    ActiveScreen = m;
+                    LOC_LOGD(module, "Prefetch cancelled after %d/%d images", loaded, images.size());
+                    break;
                 }
+                // creating an image decodes it and may write its cache file, all
+                // under the image cache lock the screen task waits for. Only
+                // images already created are loaded in memory
+                ImageWrapper *image = ImageCache::FindImage(name);
+                if (image && image->Prefetch())
+                {
+                    loaded++;
+                }
+                // let the other tasks of the same priority run between images
+                taskYIELD();
             }
-            ScreenUnlock();
+            LOC_LOGD(module, "Prefetched %d/%d images in %dms", loaded, images.size(), millis() - start);
+            images.clear();
         }
-        if (ActiveScreen)
+    }
+    static void AddPrefetchMenu(std::vector<std::string> &images, std::vector<Menu *> &visited, Menu *menu)
+    {
+        if (!menu || std::find(visited.begin(), visited.end(), menu) != visited.end())
         {
-            LOC_LOGV(module, "Found active screen %s", ActiveScreen->Name);
+            return;
         }
-        else
+        visited.push_back(menu);
+        if (!menu->Loaded)
+        {
+            // the logos are read from the compiled image, without loading the menu
+            GetCompiledMenuImages(menu, images);
+            return;
+        }
+        for (auto &button : menu->buttons)
+        {
+            button.GetImageNames(images);
+        }
+    }
+    // Called with the screen lock held, once menu is active
+    static void QueuePrefetch(Menu *menu)
+    {
+        std::vector<std::string> targets;
+        std::vector<Menu *> visited;
+        if (!xPrefetchTask)
+        {
+            return;
+        }
+        PrefetchGeneration++;
+        PrefetchImages.clear();
+        for (auto &button : menu->buttons)
         {
-            LOC_LOGV(module, "No active screen found");
+            button.GetMenuTargets(targets);
         }
-        return ActiveScreen;
+        for (auto &sequence : menu->Actions)
+        {
+            for (FTAction *action : sequence.Actions)
+            {
+                if (action->Type == ActionTypes::LOCAL && strcmp(action->ActionName(), "MENU") == 0)
+                {
+                    targets.push_back(action->FirstParameterStr());
+                }
+            }
+        }
+        // the active menu is drawn by the UI task already
+        visited.push_back(menu);
+        for (auto &target : targets)
+        {
+            // ~BACK leads to the navigation stack, added below
+            if (target[0] != '~')
+            {
+                AddPrefetchMenu(PrefetchImages, visited, FindMenu(target.c_str()));
+            }
+        }
+        for (auto m = PrevScreen.rbegin(); m != PrevScreen.rend(); m++)
+        {
+            AddPrefetchMenu(PrefetchImages, visited, *m);
+        }
+        LOC_LOGD(module, "Prefetching %d images for %d menus", PrefetchImages.size(), visited.size() - 1);
+        xTaskNotifyGive(xPrefetchTask);
+    }
+    void StartPrefetchTask()
+    {
+        if (!xPrefetchTask)
+        {
+            xTaskCreate(PrefetchTask, "Prefetch", MENU_PREFETCH_TASK_STACK, NULL, tskIDLE_PRIORITY, &xPrefetchTask);
+        }
+    }
+    void CancelPrefetch()
+    {
+        PrefetchGeneration++;
+    }
+#else
+    static void QueuePrefetch(Menu *menu)
+    {
+    }
+    void StartPrefetchTask()
+    {
+    }
+    void CancelPrefetch()
+    {
+    }
+#endif
+    Menu *GetActiveScreen()
+    {
+        return ActiveMenu.load();
     }
     FreeTouchDeck::Menu *GetScreen(const char *name, bool lock)
     {
@@ -142,24 +266,24 @@ namespace FreeTouchDeck
                 }
                 else
                 {
-                    Match = GetScreen("home");
+                    // the lock is already held
+                    Match = FindMenu("home");
                 }
             }
             else
             {
-                for (auto m : Menus)
-                {
-                    if (!strcmp(m->Name.c_str(), name))
-                    {
-                        Match = m;
-                    }
-                }
+                Match = FindMenu(name);
             }
 
             if (!Match)
             {
                 LOC_LOGD(module, "Screen %s not found", name);
             }
+            else if (!Match->Load())
+            {
+                LOC_LOGE(module, "Screen %s could not be loaded", name);
+                Match = NULL;
+            }
             else
             {
                 LOC_LOGD(module, "Screen %s was found", name);
@@ -169,6 +293,32 @@ namespace FreeTouchDeck
         }
         return Match;
     }
+    void UnloadColdMenus()
+    {
+        std::vector<Menu *> cold;
+        if (heap_caps_get_free_size(MALLOC_CAP_8BIT) >= MENU_UNLOAD_FREE_HEAP)
+        {
+            return;
+        }
+        for (auto m : Menus)
+        {
+            if (m->CanUnload())
+            {
+                cold.push_back(m);
+            }
+        }
+        std::sort(cold.begin(), cold.end(), [](const Menu *a, const Menu *b)
+                  { return a->LastActive < b->LastActive; });
+        for (auto m : cold)
+        {
+            if (heap_caps_get_free_size(MALLOC_CAP_8BIT) >= MENU_UNLOAD_FREE_HEAP)
+            {
+                break;
+            }
+            LOC_LOGI(module, "Low memory, unloading menu %s", m->Name.c_str());
+            m->Unload();
+        }
+    }
     bool SetActiveScreen(const char *name)
     {
         bool result = false;
@@ -187,6 +337,13 @@ namespace FreeTouchDeck
             }
             if (ScreenLock(portMAX_DELAY / portTICK_PERIOD_MS))
             {
+                // another menu switch may have unloaded it since it was found
+                if (!Match->Load())
+                {
+                    LOC_LOGE(module, "Screen %s could not be loaded", name);
+                    ScreenUnlock();
+                    return false;
+                }
                 if (Active)
                 {
                     if (strcmp(name, "~BACK") != 0)
@@ -196,12 +353,14 @@ namespace FreeTouchDeck
                     Active->Deactivate();
                 }
                 Match->Activate();
+                ActiveMenu = Match;
                 if (strcmp("home", Match->Name.c_str()) == 0 && PrevScreen.size() > 0)
                 {
                     LOC_LOGD(module, "Returning to home from lower level menu. Clearing navigation stack");
                     PrevScreen.clear();
                 }
-
+                UnloadColdMenus();
+                QueuePrefetch(Match);
                 ScreenUnlock();
                 result = true;
             }
@@ -221,18 +380,24 @@ namespace FreeTouchDeck
             LOC_LOGE(module, "Invalid menu object!");
             return false;
         }
-        LOC_LOGD(module, "Checking if menu %s already exists in list of %d", menu->Name.c_str(), Menus.size());
-        for (int i = 0; i < Menus.size(); i++)
+        auto found = MenuIndex.find(menu->Name);
+        if (found != MenuIndex.end())
         {
-            if (Menus[i]->Name == menu->Name)
+            Menu *replaced = Menus[found->second];
+            LOC_LOGD(module, "Replacing existing menu %s in the structure", menu->Name.c_str());
+            if (replaced == ActiveMenu)
             {
-                LOC_LOGD(module, "Replacing existing menu %s in the structure", menu->Name.c_str());
-                delete (Menus[i]);
-                Menus[i] = menu;
-                return true;
+                ActiveMenu = NULL;
             }
+            std::replace(PrevScreen.begin(), PrevScreen.end(), replaced, menu);
+            // the display handling may be drawing it through ActiveMenu
+            RetiredMenus.push_back(replaced);
+            HasRetiredMenus = true;
+            Menus[found->second] = menu;
+            return true;
         }
         LOC_LOGD(module, "Adding menu %s to the list", menu->Name.c_str());
+        MenuIndex[menu->Name] = Menus.size();
         Menus.push_back(menu);
         return true;
     }
@@ -364,7 +529,7 @@ namespace FreeTouchDeck
             if (m)
             {
                 LOC_LOGD(module, "Home screen has %d buttons", m->buttons.size());
-                Menus.push_back(m);
+                AddReplaceMenuEntry(m);
             }
             else
             {
@@ -403,7 +568,7 @@ namespace FreeTouchDeck
                     home->AddButton(button);
                 }
             }
-            Menus.push_back(home);
+            AddReplaceMenuEntry(home);
         }
         else
         {
@@ -413,38 +578,56 @@ namespace FreeTouchDeck
     }
     bool SaveFullFormat()
     {
+        bool result = false;
         LOC_LOGI(module, "Saving full menu structure");
-        File menus = ftdfs->open("/config/menus.json", FILE_WRITE);
-        if (!menus)
-        {
-            LOC_LOGE(module, "Error opening menus.json");
-            return false;
-        }
         char *json = MenusToJson(false);
         if (json)
         {
-
-            size_t written = menus.write((const uint8_t *)json, strlen(json));
-            menus.close();
-            if (strlen(json) != written)
-            {
-                ESP_LOGE(module, "Expected to write %d bytes but only %d bytes were written", strlen(json), written);
-                ftdfs->remove("/config/menus.json");
-            }
+            result = WriteConfigFile("/config/menus.json", (const uint8_t *)json, strlen(json));
             FREE_AND_NULL(json);
         }
         else
         {
             LOC_LOGE(module, "Unable to print menu structure");
         }
+        if (result && ScreenLock(portMAX_DELAY / portTICK_PERIOD_MS))
+        {
+            SaveCompiledMenus(Menus);
+            ScreenUnlock();
+        }
+        return result;
     }
     bool LoadFullFormat()
     {
         return LoadFullFormat("/config/menus.json");
     }
+    // Parses and adds one menu, from the text of its JSON object
+    static bool PushStreamedMenu(const std::string &menuText)
+    {
+        cJSON *menuJson = cJSON_Parse(menuText.c_str());
+        if (!menuJson)
+        {
+            const char *error = cJSON_GetErrorPtr();
+            LOC_LOGE(module, "Menu parsing failed: %s", error);
+            drawErrorMessage(true, module, "Unable to parse json string : %s", error);
+            return false;
+        }
+        bool result = PushJsonMenu(menuJson);
+        cJSON_Delete(menuJson);
+        return result;
+    }
     bool LoadFullFormat(const char *fileName)
     {
-        bool result = false;
+        bool result = true;
+        char chunk[MENU_LOAD_CHUNK_SIZE];
+        // text of the menu being read, its capacity grows to the largest menu
+        std::string menuText;
+        int depth = 0;
+        int menuDepth = -1;
+        bool isArray = false;
+        bool inString = false;
+        bool escaped = false;
+        size_t menusCount = 0;
         LOC_LOGI(module, "Loading menu structure from %s", fileName);
         PrintMemInfo(__FUNCTION__, __LINE__);
         File menus = ftdfs->open(fileName, FILE_READ);
@@ -453,25 +636,81 @@ namespace FreeTouchDeck
             LOC_LOGW(module, "File not found or file is empty");
             return false;
         }
-        char *fullbuffer = (char *)malloc_fn(menus.size() + 1);
-        if (!fullbuffer)
+        // Menus are read in chunks and split on the objects of the top level array,
+        // so only one menu is held as text and parsed at a time
+        size_t len = 0;
+        while (result && (len = menus.read((uint8_t *)chunk, sizeof(chunk))) > 0)
         {
-            drawErrorMessage(true, module, "Unable to load menus file. Insufficient memory to allocate %d bytes", menus.size() + 1);
-        }
-        else
-        {
-            if (menus.readBytes(fullbuffer, menus.size()) != menus.size())
-            {
-                drawErrorMessage(true, module, "Could not read file %s", menus.name());
-            }
-            else
+            for (size_t i = 0; i < len && result; i++)
             {
-                LOC_LOGD(module, "Menu structure was read from file. Parsing");
-                result = PushJsonMenu(fullbuffer);
+                char c = chunk[i];
+                if (menuDepth >= 0)
+                {
+                    menuText += c;
+                }
+                if (inString)
+                {
+                    if (escaped)
+                    {
+                        escaped = false;
+                    }
+                    else if (c == '\\')
+                    {
+                        escaped = true;
+                    }
+                    else if (c == '"')
+                    {
+                        inString = false;
+                    }
+                    continue;
+                }
+                switch (c)
+                {
+                case '"':
+                    inString = true;
+                    break;
+                case '[':
+                case '{':
+                    if (depth == 0)
+                    {
+                        isArray = c == '[';
+                    }
+                    if (c == '{' && menuDepth < 0 && depth == (isArray ? 1 : 0))
+                    {
+                        menuDepth = depth;
+                        menuText += c;
+                    }
+                    depth++;
+                    break;
+                case ']':
+                case '}':
+                    depth--;
+                    if (depth == menuDepth)
+                    {
+                        LOC_LOGD(module, "Pushing one menu of %d bytes", menuText.size());
+                        result = PushStreamedMenu(menuText);
+                        menuText.clear();
+                        menuDepth = -1;
+                        menusCount++;
+                    }
+                    break;
+                default:
+                    break;
+                }
             }
         }
+        if (result && (depth != 0 || inString))
+        {
+            drawErrorMessage(true, module, "File %s ends in the middle of a menu", menus.name());
+            result = false;
+        }
+        else if (result && !isArray && menusCount == 0)
+        {
+            drawErrorMessage(true, module, "File %s doesn't contain any menu", menus.name());
+            result = false;
+        }
+        LOC_LOGD(module, "Loaded %d menus", menusCount);
         menus.close();
-        FREE_AND_NULL(fullbuffer);
         PrintMemInfo(__FUNCTION__, __LINE__);
         return result;
     }
@@ -479,7 +718,21 @@ namespace FreeTouchDeck
     {
         if (ScreenLock(portMAX_DELAY / portTICK_PERIOD_MS))
         {
-            if (LoadFullFormat())
+            std::vector<Menu *> compiled;
+            bool loaded = LoadCompiledMenus(compiled);
+            if (loaded)
+            {
+                for (Menu *menu : compiled)
+                {
+                    AddReplaceMenuEntry(menu);
+                }
+            }
+            else if ((loaded = LoadFullFormat()))
+            {
+                // the next boots can skip parsing menus.json
+                SaveCompiledMenus(Menus);
+            }
+            if (loaded)
             {
                 LoadSystemMenus();
                 GenerateHomeScreenObject();
@@ -514,8 +767,19 @@ namespace FreeTouchDeck
                     continue; // don't output system menus as they are built-in
                 LOC_LOGD(module, "Converting menu %s", m->Name.c_str());
                 PrintMemInfo(__FUNCTION__, __LINE__);
+                // menus that aren't loaded are loaded one at a time
+                bool wasLoaded = m->Loaded;
+                if (!m->Load())
+                {
+                    LOC_LOGE(module, "Menu %s could not be loaded", m->Name.c_str());
+                    continue;
+                }
                 cJSON *menuEntry = m->ToJSON();
                 cJSON_AddItemToArray(menusArray, menuEntry);
+                if (!wasLoaded)
+                {
+                    m->Unload();
+                }
             }
             LOC_LOGD(module, "Unlocking menu object");
             ScreenUnlock();
@@ -546,22 +810,119 @@ namespace FreeTouchDeck
         PrintMemInfo(__FUNCTION__, __LINE__);
         return json;
     }
-    void handleDisplay(bool pressed, uint16_t t_x, uint16_t t_y)
+    void BenchmarkMenus(uint8_t rounds)
     {
-        static unsigned nextlog = 0;
-        auto Active = GetActiveScreen();
-        if (Active)
+        std::vector<Menu *> targets;
+        if (rounds == 0)
+        {
+            rounds = 1;
+        }
+        Menu *previous = GetActiveScreen();
+        if (!ScreenLock(portMAX_DELAY / portTICK_PERIOD_MS))
         {
-            if (pressed)
+            return;
+        }
+        uint32_t lookupStart = micros();
+        for (auto m : Menus)
+        {
+            FindMenu(m->Name.c_str());
+        }
+        uint32_t lookupTime = micros() - lookupStart;
+        for (auto m : Menus)
+        {
+            if (m->Type != MenuTypes::EMPTY && m->Load())
             {
-                Active->Touch(t_x, t_y);
+                targets.push_back(m);
             }
-            else
+        }
+        if (previous)
+        {
+            previous->Deactivate();
+        }
+        // the menus being measured aren't drawn by the UI task
+        ActiveMenu = NULL;
+        ScreenUnlock();
+        LOC_LOGI(module, "Looked up %d menus by name in %u us", Menus.size(), lookupTime);
+        LOC_LOGI(module, "Benchmarking %d menus, %d rounds each. Times are in microseconds", targets.size(), rounds);
+        LOC_LOGI(module, "%-20s %8s %8s %8s %8s %8s %10s", "menu", "first", "min", "avg", "max", "pushes", "pixels");
+        for (auto m : targets)
+        {
+            uint32_t first = 0;
+            uint32_t minTime = UINT32_MAX;
+            uint32_t maxTime = 0;
+            uint32_t totalTime = 0;
+            RenderStats_t startStats = RenderStats;
+            for (uint8_t r = 0; r < rounds; r++)
             {
-                Active->ReleaseAll();
+                uint32_t start = micros();
+                m->Activate();
+                m->Draw();
+                uint32_t elapsed = micros() - start;
+                m->Deactivate();
+                // the first round includes loading the images
+                if (r == 0)
+                {
+                    first = elapsed;
+                }
+                minTime = min(minTime, elapsed);
+                maxTime = max(maxTime, elapsed);
+                totalTime += elapsed;
             }
-            Active->DrawShape();
-            Active->DrawImages();
+            LOC_LOGI(module, "%-20s %8u %8u %8u %8u %8u %10u", m->Name.c_str(), first, minTime, totalTime / rounds, maxTime,
+                     (RenderStats.PushCalls - startStats.PushCalls) / rounds, (RenderStats.PushPixels - startStats.PushPixels) / rounds);
+        }
+        if (previous && ScreenLock(portMAX_DELAY / portTICK_PERIOD_MS))
+        {
+            // the next screen handling pass redraws the menu
+            previous->Activate();
+            ActiveMenu = previous;
+            ScreenUnlock();
+        }
+    }
+    void handleInput(const InputEvent_t &event)
+    {
+        auto Active = GetActiveScreen();
+        if (event.Type == InputEventType::PRESS)
+        {
+            CancelPrefetch();
+            // touching the screen stops the keys being sent
+            CancelLane(ActionLane::HID);
+        }
+        if (Active)
+        {
+            Active->Touch(event);
+        }
+    }
+    // Called by the display handling, between draws
+    static void DeleteRetiredMenus()
+    {
+        std::vector<Menu *> retired;
+        if (!HasRetiredMenus || !ScreenLock(portMAX_DELAY / portTICK_PERIOD_MS))
+        {
+            return;
+        }
+        retired.swap(RetiredMenus);
+        HasRetiredMenus = false;
+        for (Menu *menu : retired)
+        {
+            // releases a button held on it, before a repeat can run it again
+            menu->Deactivate();
+        }
+        ScreenUnlock();
+        for (Menu *menu : retired)
+        {
+            LOC_LOGD(module, "Deleting replaced menu %s", menu->Name.c_str());
+            delete (menu);
+        }
+    }
+    void handleDisplay()
+    {
+        static unsigned nextlog = 0;
+        DeleteRetiredMenus();
+        auto Active = GetActiveScreen();
+        if (Active)
+        {
+            Active->Draw();
         }
         else
         {
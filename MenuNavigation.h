@@ -1,6 +1,7 @@
 #pragma once
 #include "UserConfig.h"
 #include "Menu.h"
+#include "Input.h"
 #include "globals.hpp"
 namespace FreeTouchDeck {
     void LoadAllMenus();
@@ -16,7 +17,36 @@ namespace FreeTouchDeck {
     Menu *GetLatchScreen(FTAction *action);
     bool LoadFullFormat(const char * fileName);
     bool LoadFullFormat();
-    void handleDisplay(bool pressed, uint16_t t_x, uint16_t t_y);
+    /**
+* @brief Unloads the menus shown the longest time ago, until
+*        MENU_UNLOAD_FREE_HEAP bytes are free.
+*
+* @note The caller holds the screen lock
+*/
+    void UnloadColdMenus();
+    void handleInput(const InputEvent_t &event);
+    void handleDisplay();
+    /**
+* @brief Draws every menu a number of times and logs how long each
+*        menu switch took, with the number of image transfers and pixels.
+*
+* @param rounds uint8_t number of times each menu is drawn
+*
+* @note The first round includes loading the images
+*/
+    void BenchmarkMenus(uint8_t rounds);
+    /**
+* @brief Starts the task loading the images of the menus reachable from
+*        the active menu, after each menu switch.
+*/
+    void StartPrefetchTask();
+    /**
+* @brief Stops loading images in the background, so a screen press is
+*        handled without waiting for the prefetch task.
+*
+* @note Loading of the image in progress completes first
+*/
+    void CancelPrefetch();
     extern FTAction *sleepSetLatchAction;
     extern FTAction *sleepClearLatchAction;
     extern FTAction *sleepToggleLatchAction;
@@ -0,0 +1,131 @@
+#pragma once
+#include "globals.hpp"
+#include <atomic>
+namespace FreeTouchDeck
+{
+    /**
+* @brief Fixed capacity queue for one consumer task. Slots are allocated
+*        with the queue, so pushing never reaches the heap, and the consumer
+*        never takes a lock.
+*
+* @note Size must be a power of two. Pushing to a full queue fails and
+*       is counted in Overflows. Pushes aren't synchronized with each
+*       other: several producers must serialize them, as the action queues
+*       do with a critical section around TryPush
+*/
+    template <typename T, size_t Size>
+    class RingQueue
+    {
+        static_assert(Size > 0 && (Size & (Size - 1)) == 0, "RingQueue size must be a power of two");
+
+    public:
+        bool Push(const T &item)
+        {
+            if (!TryPush(item))
+            {
+                return false;
+            }
+            Wake();
+            return true;
+        }
+        // Adds the item without waking the consumer, for use in critical sections
+        bool TryPush(const T &item)
+        {
+            size_t head = Head.load(std::memory_order_relaxed);
+            if (head - Tail.load(std::memory_order_acquire) >= Size)
+            {
+                Overflows.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            Items[head & (Size - 1)] = item;
+            Head.store(head + 1, std::memory_order_seq_cst);
+            size_t depth = head + 1 - Tail.load(std::memory_order_relaxed);
+            if (depth > HighWater.load(std::memory_order_relaxed))
+            {
+                HighWater.store(depth, std::memory_order_relaxed);
+            }
+            return true;
+        }
+        void Wake()
+        {
+            TaskHandle_t waiting = Waiting.load(std::memory_order_seq_cst);
+            if (waiting)
+            {
+                xTaskNotifyGive(waiting);
+            }
+        }
+        /**
+* @brief Removes the oldest item of the queue.
+*
+* @param item T & receives the item
+* @param xTicksToWait TickType_t time to wait for an item when the queue is empty
+*
+* @return bool true when an item was removed
+*
+* @note Waiting uses the notification of the consumer task
+*/
+        bool Pop(T &item, TickType_t xTicksToWait = 0)
+        {
+            size_t tail = Tail.load(std::memory_order_relaxed);
+            if (!Wait(xTicksToWait))
+            {
+                return false;
+            }
+            item = Items[tail & (Size - 1)];
+            Tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+        /**
+* @brief Waits for the queue to hold an item, without removing it.
+*
+* @param xTicksToWait TickType_t time to wait when the queue is empty
+* @param pending bool (*)() other work of the consumer, that doesn't wait
+*        when it returns true. Its producers must call Wake
+*
+* @return bool true when the queue holds an item
+*/
+        bool Wait(TickType_t xTicksToWait, bool (*pending)() = NULL)
+        {
+            size_t tail = Tail.load(std::memory_order_relaxed);
+            if (Head.load(std::memory_order_acquire) == tail && xTicksToWait > 0 && !(pending && pending()))
+            {
+                Waiting.store(xTaskGetCurrentTaskHandle(), std::memory_order_seq_cst);
+                // an item pushed before the producer saw the waiting task wouldn't notify
+                if (Head.load(std::memory_order_seq_cst) == tail && !(pending && pending()))
+                {
+                    ulTaskNotifyTake(pdTRUE, xTicksToWait);
+                }
+                Waiting.store(NULL, std::memory_order_relaxed);
+            }
+            return Head.load(std::memory_order_acquire) != tail;
+        }
+        size_t Count()
+        {
+            return Head.load(std::memory_order_acquire) - Tail.load(std::memory_order_acquire);
+        }
+        bool Empty()
+        {
+            return Count() == 0;
+        }
+        size_t Capacity()
+        {
+            return Size;
+        }
+        uint32_t OverflowCount()
+        {
+            return Overflows.load(std::memory_order_relaxed);
+        }
+        size_t HighWaterMark()
+        {
+            return HighWater.load(std::memory_order_relaxed);
+        }
+
+    private:
+        T Items[Size];
+        std::atomic<size_t> Head{0};
+        std::atomic<size_t> Tail{0};
+        std::atomic<uint32_t> Overflows{0};
+        std::atomic<size_t> HighWater{0};
+        std::atomic<TaskHandle_t> Waiting{NULL};
+    };
+}
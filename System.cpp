@@ -6,6 +6,10 @@
 #include "ConfigLoad.h"
 #include "ConfigHelper.h"
 #include "Audio.h"
+#include "Input.h"
+#include "ActionBytecode.h"
+#include "Trace.h"
+#include "ConfigStore.h"
 #include "UserConfig.h"
 
 #ifdef USECAPTOUCH
@@ -21,6 +25,8 @@ namespace FreeTouchDeck
     BleKeyboard bleKeyboard("FreeTouchDeck", "Made by me");
     RTC_NOINIT_ATTR SystemMode restartReason = SystemMode::STANDARD;
     SystemMode RunMode = SystemMode::STANDARD;
+    Histogram_t ActionLatency;
+    Histogram_t ActionQueueDepth;
 
     IRAM_ATTR char *ps_strdup(const char *fmt)
     {
@@ -97,24 +103,7 @@ namespace FreeTouchDeck
         bool result = false;
         if (!ISNULLSTRING(contentString))
         {
-            fs::File file = ftdfs->open(fileName, "w");
-            if (!file)
-            {
-                LOC_LOGE(module, "Error opening target file %s", STRING_OR_DEFAULT(fileName, "?"));
-            }
-            else
-            {
-                size_t written = file.write((uint8_t *)contentString, strlen(contentString));
-                file.close();
-                if (written != strlen(contentString))
-                {
-                    LOC_LOGE(module, "File %s could not be fully written to. Wrote %d bytes of %d bytes", STRING_OR_DEFAULT(fileName, "?"), written, strlen(contentString));
-                }
-                else
-                {
-                    result = true;
-                }
-            }
+            result = WriteConfigFile(fileName, (const uint8_t *)contentString, strlen(contentString));
             FREE_AND_NULL(contentString);
         }
         PrintMemInfo(__FUNCTION__, __LINE__);
@@ -129,6 +118,11 @@ namespace FreeTouchDeck
         touchInit();
         PrintMemInfo(__FUNCTION__, __LINE__);
         InitFileSystem();
+        if (isStorageInitialized())
+        {
+            RecoverConfigWrites();
+        }
+        InitConfigSaving();
         PrintMemInfo(__FUNCTION__, __LINE__);
 
         // We cannot rely on the c++ compiler to initialize our
@@ -213,6 +207,7 @@ namespace FreeTouchDeck
     void ChangeMode(SystemMode newMode)
     {
         restartReason = newMode;
+        FlushConfigSaving();
         ESP.restart();
     }
 
@@ -394,6 +389,7 @@ namespace FreeTouchDeck
         else
         {
             LOC_LOGI(module, "Capacitive touch started");
+            InputInit();
         }
 #endif
         PrintMemInfo(__FUNCTION__, __LINE__);
@@ -464,6 +460,11 @@ namespace FreeTouchDeck
     bool isTouched()
     {
         uint16_t t_x, t_y;
+        if (InputTaskRunning())
+        {
+            // the touch controller is read by the input task
+            return InputTouched();
+        }
         return getTouch(&t_x, &t_y);
     }
     void processSleep()
@@ -503,7 +504,8 @@ namespace FreeTouchDeck
         }
         else
         {
-
+            // the debounced configuration save would be lost
+            FlushConfigSaving();
             esp_deep_sleep_start();
         }
         return true;
@@ -514,29 +516,58 @@ namespace FreeTouchDeck
         SleepInterval = sleepInterval * 60000;
     }
 
+    void HistogramAdd(Histogram_t &histogram, uint32_t value)
+    {
+        uint8_t bucket = value == 0 ? 0 : 32 - __builtin_clz(value);
+        histogram.Buckets[min(bucket, (uint8_t)(HISTOGRAM_BUCKETS - 1))]++;
+        histogram.Count++;
+        histogram.Total += value;
+        histogram.Max = max(histogram.Max, value);
+    }
+    void HistogramReset(Histogram_t &histogram)
+    {
+        memset(&histogram, 0x00, sizeof(histogram));
+    }
+    void HistogramLog(const char *name, const Histogram_t &histogram)
+    {
+        LOC_LOGI(module, "%s: %u samples, avg: %u, max: %u", name, histogram.Count, histogram.Count ? (uint32_t)(histogram.Total / histogram.Count) : 0, histogram.Max);
+        for (uint8_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+        {
+            if (histogram.Buckets[i] > 0)
+            {
+                LOC_LOGI(module, "  %s%8u: %u", i == HISTOGRAM_BUCKETS - 1 ? ">=" : "< ", i == HISTOGRAM_BUCKETS - 1 ? 1 << (i - 1) : 1 << i, histogram.Buckets[i]);
+            }
+        }
+    }
     void HandleScreen()
     {
-        uint16_t t_x = 0;
-        uint16_t t_y = 0;
         try
         {
-            bool pressed = getTouch(&t_x, &t_y);
+            InputEvent_t event;
+            InputPoll();
             if (RunMode == SystemMode::CONFIG || RunMode == SystemMode::CONSOLE)
             {
                 delay(100);
-                if (pressed)
+                if (InputTouched())
                 {
+                    FlushConfigSaving();
                     ESP.restart();
                 }
                 return;
             }
-            handleDisplay(pressed, t_x, t_y);
+            while (PopInputEvent(event))
+            {
+                handleInput(event);
+            }
+            handleDisplay();
             LOC_LOGV(module, "Checking for screen actions");
             FTAction *Action = PopScreenQueue();
             if (Action)
             {
                 ResetSleep();
+                TraceAction(TraceEvent::EXECUTE_START, Action, NULL, micros());
                 Action->Execute();
+                TraceAction(TraceEvent::EXECUTE_END, Action, NULL, micros());
             }
         }
         catch (const std::exception &e)
@@ -545,17 +576,34 @@ namespace FreeTouchDeck
         }
     }
 
-    void HandleActions()
+    void HandleActions(TickType_t xTicksToWait)
     {
         LOC_LOGV(module, "Checking for regular actions");
         try
         {
-            FTAction *Action = NULL;
-            Action = PopQueue();
-            if (Action)
+            QueuedAction_t queued;
+            bool popped = PopQueue(queued, xTicksToWait);
+            // a cancelled sequence may not reach the instruction releasing its keys
+            ReleaseCancelledKeys();
+            if (popped)
             {
+                HistogramAdd(ActionLatency, micros() - queued.QueuedTime);
+                HistogramAdd(ActionQueueDepth, GetActionQueueStats(ActionLane::HID).Depth);
                 ResetSleep();
-                Action->Execute();
+                TraceAction(TraceEvent::EXECUTE_START, queued.Action, queued.Op, micros());
+                if (queued.Op)
+                {
+                    RunKeyboardOp(queued.Op, queued.Token);
+                }
+                else if (queued.Action)
+                {
+                    queued.Action->Execute();
+                }
+                else
+                {
+                    FTButton::RunRepeat();
+                }
+                TraceAction(TraceEvent::EXECUTE_END, queued.Action, queued.Op, micros());
             }
         }
         catch (const std::exception &e)
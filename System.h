@@ -36,7 +36,28 @@ namespace FreeTouchDeck
     void ChangeMode(SystemMode newMode);
     void *malloc_fn(size_t sz);
     bool EnterSleep();
-    void HandleActions();
+    // Histogram of values, where bucket i counts values up to 2^i - 1
+    #define HISTOGRAM_BUCKETS 20
+    typedef struct
+    {
+        uint32_t Buckets[HISTOGRAM_BUCKETS];
+        uint32_t Count;
+        uint32_t Max;
+        uint64_t Total;
+    } Histogram_t;
+    void HistogramAdd(Histogram_t &histogram, uint32_t value);
+    void HistogramLog(const char *name, const Histogram_t &histogram);
+    void HistogramReset(Histogram_t &histogram);
+    // Time from queuing to running a keyboard action, in microseconds
+    extern Histogram_t ActionLatency;
+    // Keyboard actions still queued when one starts running
+    extern Histogram_t ActionQueueDepth;
+    /**
+* @brief Runs the next keyboard action from the queue
+*
+* @param xTicksToWait TickType_t time to wait for an action when none is queued
+*/
+    void HandleActions(TickType_t xTicksToWait = 0);
     void HandleScreen();
     char * AllocPrintJson(cJSON * doc, bool freeDoc = true);
     bool SaveJsonToFile(const char * fileName,cJSON * content,bool freeDoc=true);
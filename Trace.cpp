@@ -0,0 +1,191 @@
+#include "Trace.h"
+#include "ActionBytecode.h"
+#include <algorithm>
+namespace FreeTouchDeck
+{
+    static const char *module = "Trace";
+#ifdef ACTION_TRACE_SIZE
+    // Written from the screen, keyboard and web server tasks
+    static portMUX_TYPE TraceMux = portMUX_INITIALIZER_UNLOCKED;
+    static TraceRecord_t Records[ACTION_TRACE_SIZE];
+    // number of events recorded since the trace was cleared
+    static size_t Recorded = 0;
+#endif
+
+    const char *enum_to_string(TraceEvent event)
+    {
+        switch (event)
+        {
+            ENUM_TO_STRING_HELPER(TraceEvent, ENQUEUE);
+            ENUM_TO_STRING_HELPER(TraceEvent, DEQUEUE);
+            ENUM_TO_STRING_HELPER(TraceEvent, EXECUTE_START);
+            ENUM_TO_STRING_HELPER(TraceEvent, EXECUTE_END);
+            ENUM_TO_STRING_HELPER(TraceEvent, HID_REPORT);
+        default:
+            return "Unknown";
+        }
+    }
+    static uint16_t OpKeys(const uint8_t *op)
+    {
+        switch ((ActionOp)op[0])
+        {
+        case ActionOp::TYPE:
+        case ActionOp::PRESS:
+            return op[3];
+        case ActionOp::KEYS:
+            return op[5];
+        case ActionOp::MEDIA:
+            return 1;
+        default:
+            return 0;
+        }
+    }
+    static void Record(TraceEvent event, const void *subject, const char *name, uint16_t keys, uint32_t time, uint32_t duration)
+    {
+#ifdef ACTION_TRACE_SIZE
+        TraceRecord_t record = {time, duration, subject, {0}, xTaskGetCurrentTaskHandle(), keys, event};
+        strncpy(record.Name, name, sizeof(record.Name) - 1);
+        portENTER_CRITICAL(&TraceMux);
+        Records[Recorded++ % ACTION_TRACE_SIZE] = record;
+        portEXIT_CRITICAL(&TraceMux);
+#endif
+    }
+    void TraceAction(TraceEvent event, FTAction *action, const uint8_t *op, uint32_t time)
+    {
+        if (op)
+        {
+            // the instruction may be temporary, only its name and key count are kept
+            Record(event, op, enum_to_string((ActionOp)op[0]), OpKeys(op), time, 0);
+        }
+        else if (action)
+        {
+            Record(event, action, action->Parameters.size() > 0 ? action->Parameters[0].c_str() : enum_to_string(action->Type), action->Values.size(), time, 0);
+        }
+    }
+    void TraceReport(const uint8_t *op, uint32_t start)
+    {
+        uint32_t now = micros();
+        Record(TraceEvent::HID_REPORT, op, enum_to_string((ActionOp)op[0]), OpKeys(op), start, now - start);
+    }
+    // Copies the recorded events, oldest first
+    static size_t CopyRecords(TraceRecord_t *records)
+    {
+        size_t count = 0;
+#ifdef ACTION_TRACE_SIZE
+        portENTER_CRITICAL(&TraceMux);
+        size_t first = Recorded > ACTION_TRACE_SIZE ? Recorded - ACTION_TRACE_SIZE : 0;
+        for (size_t i = first; i < Recorded; i++)
+        {
+            records[count++] = Records[i % ACTION_TRACE_SIZE];
+        }
+        portEXIT_CRITICAL(&TraceMux);
+#endif
+        return count;
+    }
+    static cJSON *TraceEventJson(const char *name, const char *phase, uint32_t time, TaskHandle_t task)
+    {
+        cJSON *entry = cJSON_CreateObject();
+        cJSON_AddStringToObject(entry, "name", name);
+        cJSON_AddStringToObject(entry, "ph", phase);
+        cJSON_AddNumberToObject(entry, "ts", time);
+        cJSON_AddNumberToObject(entry, "pid", 1);
+        cJSON_AddNumberToObject(entry, "tid", (uint32_t)(uintptr_t)task);
+        return entry;
+    }
+    cJSON *TraceJson()
+    {
+        cJSON *doc = cJSON_CreateObject();
+        cJSON *events = cJSON_CreateArray();
+        cJSON_AddItemToObject(doc, "traceEvents", events);
+        cJSON_AddStringToObject(doc, "displayTimeUnit", "ms");
+#ifdef ACTION_TRACE_SIZE
+        char id[11] = {0};
+        std::vector<TaskHandle_t> tasks;
+        TraceRecord_t *records = (TraceRecord_t *)malloc_fn(sizeof(TraceRecord_t) * ACTION_TRACE_SIZE);
+        if (!records)
+        {
+            LOC_LOGE(module, "Unable to allocate memory for the trace");
+            return doc;
+        }
+        size_t count = CopyRecords(records);
+        for (size_t i = 0; i < count; i++)
+        {
+            TraceRecord_t &record = records[i];
+            cJSON *entry = NULL;
+            switch (record.Event)
+            {
+            case TraceEvent::ENQUEUE:
+            case TraceEvent::DEQUEUE:
+                // the time spent queued is an async span, matched by the queued subject
+                entry = TraceEventJson(record.Name, record.Event == TraceEvent::ENQUEUE ? "b" : "e", record.Time, record.Task);
+                cJSON_AddStringToObject(entry, "cat", "queue");
+                snprintf(id, sizeof(id), "0x%08x", (uint32_t)(uintptr_t)record.Subject);
+                cJSON_AddStringToObject(entry, "id", id);
+                break;
+            case TraceEvent::EXECUTE_START:
+            case TraceEvent::EXECUTE_END:
+                entry = TraceEventJson(record.Name, record.Event == TraceEvent::EXECUTE_START ? "B" : "E", record.Time, record.Task);
+                cJSON_AddStringToObject(entry, "cat", "execute");
+                break;
+            case TraceEvent::HID_REPORT:
+                entry = TraceEventJson("report", "X", record.Time, record.Task);
+                cJSON_AddStringToObject(entry, "cat", "hid");
+                cJSON_AddNumberToObject(entry, "dur", record.Duration);
+                break;
+            default:
+                continue;
+            }
+            cJSON *args = cJSON_CreateObject();
+            cJSON_AddStringToObject(args, "op", record.Name);
+            cJSON_AddNumberToObject(args, "keys", record.Keys);
+            cJSON_AddItemToObject(entry, "args", args);
+            cJSON_AddItemToArray(events, entry);
+            if (std::find(tasks.begin(), tasks.end(), record.Task) == tasks.end())
+            {
+                tasks.push_back(record.Task);
+            }
+        }
+        FREE_AND_NULL(records);
+        // names the rows of the tasks
+        for (TaskHandle_t task : tasks)
+        {
+            cJSON *entry = TraceEventJson("thread_name", "M", 0, task);
+            cJSON *args = cJSON_CreateObject();
+            cJSON_AddStringToObject(args, "name", pcTaskGetTaskName(task));
+            cJSON_AddItemToObject(entry, "args", args);
+            cJSON_AddItemToArray(events, entry);
+        }
+#endif
+        return doc;
+    }
+    void TraceLog()
+    {
+#ifdef ACTION_TRACE_SIZE
+        TraceRecord_t *records = (TraceRecord_t *)malloc_fn(sizeof(TraceRecord_t) * ACTION_TRACE_SIZE);
+        if (!records)
+        {
+            LOC_LOGE(module, "Unable to allocate memory for the trace");
+            return;
+        }
+        size_t count = CopyRecords(records);
+        LOC_LOGI(module, "%d events, times in microseconds", count);
+        for (size_t i = 0; i < count; i++)
+        {
+            TraceRecord_t &record = records[i];
+            LOC_LOGI(module, "%10u %+8d %-12s %-13s %-10s keys: %d, blocked: %u", record.Time, i > 0 ? (int32_t)(record.Time - records[i - 1].Time) : 0,
+                     pcTaskGetTaskName(record.Task), enum_to_string(record.Event), record.Name, record.Keys, record.Duration);
+        }
+        FREE_AND_NULL(records);
+#else
+        LOC_LOGW(module, "Action tracing is disabled. Define ACTION_TRACE_SIZE in UserConfig.h to enable it");
+#endif
+    }
+    void TraceClear()
+    {
+#ifdef ACTION_TRACE_SIZE
+        portENTER_CRITICAL(&TraceMux);
+        Recorded = 0;
+        portEXIT_CRITICAL(&TraceMux);
+#endif
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "globals.hpp"
+#include "UserConfig.h"
+#include "FTAction.h"
+namespace FreeTouchDeck
+{
+    enum class TraceEvent : uint8_t
+    {
+        ENQUEUE,
+        DEQUEUE,
+        EXECUTE_START,
+        EXECUTE_END,
+        HID_REPORT
+    };
+    const char *enum_to_string(TraceEvent event);
+    // Names are copied, actions can be freed while their events are kept
+#define TRACE_NAME_SIZE 16
+    typedef struct
+    {
+        // time of the event, in microseconds
+        uint32_t Time;
+        // time the keyboard library blocked, for HID_REPORT events
+        uint32_t Duration;
+        // queued action or instruction, matches enqueue and dequeue events
+        const void *Subject;
+        char Name[TRACE_NAME_SIZE];
+        TaskHandle_t Task;
+        uint16_t Keys;
+        TraceEvent Event;
+    } TraceRecord_t;
+
+    /**
+* @brief Records an event of a queued action or keyboard instruction in
+*        the trace ring buffer. The oldest events are overwritten.
+*
+* @param event TraceEvent what happened
+* @param action FTAction * action, or NULL for a keyboard instruction
+* @param op const uint8_t * keyboard instruction, or NULL for an action
+* @param time uint32_t time of the event, from micros()
+*/
+    void TraceAction(TraceEvent event, FTAction *action, const uint8_t *op, uint32_t time);
+    // Records a call to the keyboard library made for op, started at start
+    void TraceReport(const uint8_t *op, uint32_t start);
+    // Times a call to the keyboard library
+#ifdef ACTION_TRACE_SIZE
+#define TRACE_REPORT(op, call)           \
+    do                                   \
+    {                                    \
+        uint32_t reportStart = micros(); \
+        call;                            \
+        TraceReport(op, reportStart);    \
+    } while (0)
+#else
+#define TRACE_REPORT(op, call) call
+#endif
+    /**
+* @brief Builds the trace in the Chrome trace event format, which can be
+*        opened in chrome://tracing or Perfetto.
+*
+* @return cJSON * trace document, to be freed by the caller
+*/
+    cJSON *TraceJson();
+    void TraceLog();
+    void TraceClear();
+}
@@ -34,6 +34,7 @@ namespace FreeTouchDeck
         }
         // save the configuration
         QueueSaving();
+        return true;
     }
     bool ChangeBrightness(FTAction *action)
     {
@@ -164,6 +165,7 @@ namespace FreeTouchDeck
          {
              LOC_LOGW(module, "Restarting in configuration mode");
              restartReason = SystemMode::CONFIG;
+             FlushConfigSaving();
              ESP.restart();
              return true;
          }},
@@ -190,6 +192,7 @@ namespace FreeTouchDeck
         {"FONTTEST", FontTest},
         {"REBOOT", [](FTAction *action)
          {
+             FlushConfigSaving();
              ESP.restart();
              return false;
          }},
@@ -113,7 +113,101 @@
 
 #define LED_BRIGHTNESS_INCREMENT 25
 
-// percentage of free memory that the system will use as
-// a temporary buffer when drawing images. Warning! 
-// too much buffer will lead to system instabilities. 
-#define BITMAP_BUFFER_FREE_RAM_PCT 0.30
+// Pre-decoded RGB565 copies of the logos are written to this folder the
+// first time an image is loaded, so later draws can be pushed to the
+// screen without decoding the jpg/bmp again. Comment out to disable.
+#define IMAGE_CACHE_FOLDER "/cache"
+// SPIFFS object names are limited to 31 characters
+#define IMAGE_CACHE_MAX_PATH 31
+
+// Size of the buffer used to read image lines before pushing them to the
+// screen. Each task drawing or caching images allocates one
+#define IMAGE_DRAW_BUFFER_SIZE 4096
+
+
+// Byte budget for image pixels kept in memory, so the logos of the most
+// recently drawn buttons are pushed to the screen without reading the
+// file system. The least recently drawn images are evicted first. The
+// larger budget applies when PSRAM is found. Comment out to disable.
+#define IMAGE_PIXEL_CACHE_PSRAM_SIZE (1024 * 1024)
+#define IMAGE_PIXEL_CACHE_RAM_SIZE (24 * 1024)
+
+// Compose whole buttons (shape, logo and label) in an off-screen buffer
+// and push each one to the screen in a single transfer, which avoids
+// flicker. The buffer is placed in PSRAM when found. Drawing falls back
+// to the screen when the buffer or the logo pixels can't be held in
+// memory. Comment out to disable.
+#define BUTTON_SPRITE_DRAW
+// Without PSRAM, internal RAM that must remain free once the button buffer is allocated
+#define BUTTON_SPRITE_MIN_FREE_RAM (40 * 1024)
+
+// Once a menu is shown, load the logos of the menus it leads to, and of
+// the menus to go back to, in a low priority task so switching menus
+// doesn't wait for the file system. A screen press interrupts the task.
+// Comment out to disable.
+#define MENU_PREFETCH
+// images not loaded yet are decoded by the prefetch task
+#define MENU_PREFETCH_TASK_STACK (1024 * 6)
+
+// Size of the reads of menus.json. Menus are parsed one at a time as the
+// file is read, so the whole file is never held in memory.
+#define MENU_LOAD_CHUNK_SIZE 512
+
+// Once menus.json is loaded or saved, the menus are compiled to a binary
+// image so the next boots skip parsing JSON. The image is mapped from the
+// data partition with this name when the partition table has one, and read
+// from COMPILED_MENUS_FILE otherwise. Comment out to always use the file.
+#define COMPILED_MENUS_PARTITION "ftdconfig"
+#define COMPILED_MENUS_FILE "/config/menus.bin"
+// Menus of the compiled image are loaded when first shown. When less memory
+// than this is free after switching menu, the menus shown the longest time
+// ago are unloaded. This is also checked before a menu is loaded, and
+// loading is refused when less than MENU_LOAD_MIN_FREE_HEAP remains free.
+#define MENU_UNLOAD_FREE_HEAP (32 * 1024)
+#define MENU_LOAD_MIN_FREE_HEAP (16 * 1024)
+
+// Number of actions each of the keyboard and screen queues can hold, a
+// power of two. Actions queued while the queue is full are dropped.
+#define ACTION_QUEUE_SIZE 32
+
+// Run keyboard actions in their own task, which wakes up as soon as an
+// action is queued. Otherwise actions are run from the main loop,
+// between screen updates. Comment out to disable.
+#define ACTIONS_IN_TASKS
+
+// Sample the capacitive touch controller from a task woken by the
+// touchInterruptPin interrupt, instead of polling it from the main
+// loop. Comment out to disable.
+#define INPUT_TOUCH_TASK
+// Period at which a touch is sampled by the input task
+#define INPUT_SAMPLE_PERIOD_MS 10
+// Losses of contact shorter than this don't release the touch
+#define INPUT_DEBOUNCE_MS 30
+// A touch held this long without moving is reported as a long press
+#define INPUT_LONG_PRESS_MS 600
+// A touch moving this many pixels in less than INPUT_SWIPE_MAX_MS is a swipe.
+// Swiping right goes back to the previous menu.
+#define INPUT_SWIPE_MIN_DISTANCE 60
+#define INPUT_SWIPE_MAX_MS 500
+// Number of touch events waiting to be handled by the screen
+#define INPUT_EVENT_QUEUE_SIZE 16
+
+// Text is typed by sending up to this many keys in each keyboard report,
+// from 1 to 6. Lower it if a host reorders characters typed quickly.
+#define HID_KEYS_PER_REPORT 6
+// Smallest time between two keyboard reports, about the BLE connection interval
+#define HID_REPORT_INTERVAL_MS 8
+
+// Default time between the repeats of a button with a repeatdelay, and
+// the shortest time its repeatacceleration can bring it down to
+#define BUTTON_REPEAT_INTERVAL_MS 100
+#define BUTTON_REPEAT_MIN_INTERVAL_MS 20
+
+// Number of action queue, execution and keyboard report events kept for
+// the trace console command and /trace.json. Comment out to disable.
+#define ACTION_TRACE_SIZE 128
+
+// Configuration changes saved within this delay of each other are written
+// to general.json once the last one is this old. Pending changes are saved
+// before restarting or sleeping.
+#define CONFIG_SAVE_DELAY_MS 3000
@@ -3,6 +3,9 @@
 #include "Storage.h"
 #include "ConfigLoad.h"
 #include "ConfigHelper.h"
+#include "ImageCache.h"
+#include "Trace.h"
+#include "ConfigStore.h"
 namespace FreeTouchDeck
 {
   extern cJSON * MenusToJsonObject(bool withSystem);
@@ -90,6 +93,42 @@ namespace FreeTouchDeck
     cJSON_AddStringToObject(element,"Sleep","Disabled");
     cJSON_AddItemToArray(infoDoc,element);
 #endif
+    const PixelCacheStats_t &imageStats = ImageCache::GetPixelCacheStats();
+    element = cJSON_CreateObject();
+    cJSON_AddNumberToObject(element,"Image Cache Bytes",imageStats.BytesUsed);
+    cJSON_AddItemToArray(infoDoc,element);
+    element = cJSON_CreateObject();
+    cJSON_AddNumberToObject(element,"Image Cache Budget",imageStats.Budget);
+    cJSON_AddItemToArray(infoDoc,element);
+    element = cJSON_CreateObject();
+    cJSON_AddNumberToObject(element,"Image Cache Hits",imageStats.Hits);
+    cJSON_AddItemToArray(infoDoc,element);
+    element = cJSON_CreateObject();
+    cJSON_AddNumberToObject(element,"Image Cache Misses",imageStats.Misses);
+    cJSON_AddItemToArray(infoDoc,element);
+    element = cJSON_CreateObject();
+    cJSON_AddNumberToObject(element,"Image Cache Evictions",imageStats.Evictions);
+    cJSON_AddItemToArray(infoDoc,element);
+    ActionQueueStats_t queueStats = GetActionQueueStats(ActionLane::HID);
+    element = cJSON_CreateObject();
+    cJSON_AddNumberToObject(element,"Action Queue High Water",queueStats.HighWater);
+    cJSON_AddItemToArray(infoDoc,element);
+    element = cJSON_CreateObject();
+    cJSON_AddNumberToObject(element,"Action Queue Overflows",queueStats.Overflows + GetActionQueueStats(ActionLane::SYSTEM).Overflows + GetActionQueueStats(ActionLane::NAVIGATION).Overflows);
+    cJSON_AddItemToArray(infoDoc,element);
+    element = cJSON_CreateObject();
+    cJSON_AddNumberToObject(element,"Keyboard Actions Cancelled",queueStats.Cancelled);
+    cJSON_AddItemToArray(infoDoc,element);
+    ConfigWriteStats_t writeStats = GetConfigWriteStats();
+    element = cJSON_CreateObject();
+    cJSON_AddNumberToObject(element,"Config Saves Coalesced",writeStats.Coalesced);
+    cJSON_AddItemToArray(infoDoc,element);
+    element = cJSON_CreateObject();
+    cJSON_AddNumberToObject(element,"Config Writes",writeStats.Writes);
+    cJSON_AddItemToArray(infoDoc,element);
+    element = cJSON_CreateObject();
+    cJSON_AddNumberToObject(element,"Config Bytes Written",writeStats.BytesWritten);
+    cJSON_AddItemToArray(infoDoc,element);
     return infoDoc;
   }
 
@@ -431,6 +470,7 @@ Note   : none
     webserver.on("/useractions.json", HTTP_GET, [](AsyncWebServerRequest *request){RespondWithJSON(request,UserActionsJson());});
     webserver.on("/keynames.json", HTTP_GET, [](AsyncWebServerRequest *request){RespondWithJSON(request,KeyNamesJson());});
     webserver.on("/info", HTTP_GET, [](AsyncWebServerRequest *request) { RespondWithJSON(request, AllocGetInfoJson()) ; });
+    webserver.on("/trace.json", HTTP_GET, [](AsyncWebServerRequest *request) { RespondWithJSON(request, TraceJson()); });
 
     //----------- 404 handler -----------------
 
@@ -519,6 +559,7 @@ Note   : none
                    request->send(200, "text/plain", "FreeTouchDeck is restarting...");
                    // Then restart the ESP
                    LOC_LOGD(module, "Restarting");
+                   FlushConfigSaving();
                    ESP.restart();
                  });
 
@@ -548,6 +589,7 @@ Note   : none
                      {
                        ftdfs->stremove(filename);
                      }
+                     ImageWrapper::RemoveCache(p->value().c_str());
 
                      resultFiles += p->value().c_str();
                      resultFiles += "<br>";
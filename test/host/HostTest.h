@@ -0,0 +1,50 @@
+#pragma once
+// Helpers shared by the host tests and benchmarks
+#include <Arduino.h>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include "Host.h"
+
+namespace HostTest
+{
+    static int Failures = 0;
+#define CHECK(x)                                                           \
+    do                                                                     \
+    {                                                                      \
+        if (!(x))                                                          \
+        {                                                                  \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            HostTest::Failures++;                                          \
+        }                                                                  \
+    } while (0)
+
+    // Microseconds taken by the fastest of the given rounds
+    inline double BestOf(int rounds, const std::function<void()> &fn)
+    {
+        double best = 0;
+        for (int r = 0; r < rounds; r++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            best = r == 0 || elapsed < best ? elapsed : best;
+        }
+        return best;
+    }
+    // Mounts a fresh copy of the sketch's data folder as SPIFFS
+    inline bool MountData(const char *target)
+    {
+        return HostMountCopy(HOST_DATA_DIR, target);
+    }
+    inline int Result(const char *name)
+    {
+        if (Failures > 0)
+        {
+            fprintf(stderr, "%s: %d check(s) failed\n", name, Failures);
+            return 1;
+        }
+        printf("%s: passed\n", name);
+        return 0;
+    }
+}
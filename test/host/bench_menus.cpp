@@ -0,0 +1,144 @@
+// Times the menu registry with 500 menus: loading menus.json, looking menus
+// up by name, compared with the former scan of the list, and switching menus.
+#include "HostTest.h"
+#include "globals.hpp"
+#include "Storage.h"
+#include "Menu.h"
+#include "MenuNavigation.h"
+#include <string>
+#include <vector>
+
+using namespace FreeTouchDeck;
+namespace FreeTouchDeck
+{
+    extern std::vector<Menu *> Menus;
+}
+
+static const int MenusCount = 500;
+static const int Rounds = 20;
+
+static std::string MenuName(int index)
+{
+    char name[20];
+    snprintf(name, sizeof(name), "menu%03d", index);
+    return name;
+}
+
+// Writes a menus.json of MenusCount menus, the first few listed on the home screen
+static bool WriteMenus()
+{
+    static const char *logos[] = {"mute.jpg", "play.jpg", "stop.jpg", "mail.jpg", "obs.jpg", "music.jpg"};
+    cJSON *menus = cJSON_CreateArray();
+    for (int i = 0; i < MenusCount; i++)
+    {
+        cJSON *menu = cJSON_CreateObject();
+        cJSON_AddStringToObject(menu, "name", MenuName(i).c_str());
+        cJSON_AddStringToObject(menu, "type", i < 8 ? "HOME" : "STANDARD");
+        cJSON_AddStringToObject(menu, "logo", logos[i % 6]);
+        cJSON *buttons = cJSON_AddArrayToObject(menu, "buttons");
+        for (int b = 0; b < 5; b++)
+        {
+            cJSON *button = cJSON_CreateObject();
+            cJSON *actions = cJSON_AddArrayToObject(button, "actions");
+            if (b == 0)
+            {
+                std::string action = "{MENU:" + MenuName((i + 1) % MenusCount) + "}";
+                cJSON_AddItemToArray(actions, cJSON_CreateString(action.c_str()));
+            }
+            else
+            {
+                cJSON_AddStringToObject(button, "logo", logos[b]);
+                cJSON_AddItemToArray(actions, cJSON_CreateString("Hello{LEFT_ALT}{TAB}"));
+            }
+            cJSON_AddItemToArray(buttons, button);
+        }
+        cJSON_AddItemToArray(menus, menu);
+    }
+    return SaveJsonToFile("/config/menus.json", menus);
+}
+
+// How menus were found before they were indexed
+static Menu *ScanForMenu(const char *name)
+{
+    for (auto m : Menus)
+    {
+        if (strcmp(m->Name.c_str(), name) == 0)
+        {
+            return m;
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    HostSetVerbose(argc > 1 && strcmp(argv[1], "-v") == 0);
+    if (!HostTest::MountData("bench_menus_fs"))
+    {
+        return 1;
+    }
+    SetGeneralConfigDefaults();
+    InitFileSystem();
+    FTAction::InitConstants();
+    FTButton::InitConstants();
+    loadGeneralConfig();
+    displayInit();
+    CHECK(WriteMenus());
+
+    double load = HostTest::BestOf(1, []()
+                                   { LoadAllMenus(); });
+    // the generated home menu and the system menus come on top
+    CHECK(Menus.size() >= MenusCount);
+    std::vector<std::string> names;
+    for (int i = 0; i < MenusCount; i++)
+    {
+        names.push_back(MenuName(i));
+        Menu *menu = GetScreen(names.back().c_str());
+        CHECK(menu && menu->Name == names.back());
+    }
+
+    double indexed = HostTest::BestOf(Rounds, [&names]()
+                                      {
+                                          for (auto &name : names)
+                                          {
+                                              CHECK(GetScreen(name.c_str()) != NULL);
+                                          }
+                                      });
+    double scanned = HostTest::BestOf(Rounds, [&names]()
+                                      {
+                                          for (auto &name : names)
+                                          {
+                                              CHECK(ScanForMenu(name.c_str()) != NULL);
+                                          }
+                                      });
+    double missing = HostTest::BestOf(Rounds, []()
+                                      {
+                                          for (int i = 0; i < MenusCount; i++)
+                                          {
+                                              CHECK(GetScreen("nosuchmenu") == NULL);
+                                          }
+                                      });
+    double switching = HostTest::BestOf(Rounds, [&names]()
+                                        {
+                                            for (auto &name : names)
+                                            {
+                                                SetActiveScreen(name.c_str());
+                                            }
+                                        });
+    CHECK(GetActiveScreen() && GetActiveScreen()->Name == names.back());
+    // loading again replaces every menu in place
+    double reload = HostTest::BestOf(1, []()
+                                     { LoadFullFormat(); });
+    CHECK(GetScreen(names.front().c_str()) != NULL);
+    // the replaced menus are deleted by the display handling
+    handleDisplay();
+
+    printf("\n%d menus, times in us\n", (int)Menus.size());
+    printf("%-40s %12.1f\n", "load menus.json", load);
+    printf("%-40s %12.1f\n", "reload, replacing every menu", reload);
+    printf("%-40s %12.3f\n", "GetScreen, per menu", indexed / MenusCount);
+    printf("%-40s %12.3f\n", "scan of the menus list, per menu", scanned / MenusCount);
+    printf("%-40s %12.3f\n", "GetScreen of a missing menu", missing / MenusCount);
+    printf("%-40s %12.3f\n", "SetActiveScreen, per switch", switching / MenusCount);
+    return HostTest::Result("bench_menus");
+}
@@ -0,0 +1,215 @@
+// Times the rendering of the menus and logos of the data folder on the host
+// stand-ins: menu activation, shapes and images, then JPG and BMP draws.
+// Times are host times, the pushes and pixels are what the screen receives.
+#include "HostTest.h"
+#include "globals.hpp"
+#include "Storage.h"
+#include "Menu.h"
+#include "MenuNavigation.h"
+#include "ImageCache.h"
+#include <SPIFFS.h>
+#include <algorithm>
+#include <dirent.h>
+#include <string>
+#include <vector>
+
+using namespace FreeTouchDeck;
+namespace FreeTouchDeck
+{
+    extern std::vector<Menu *> Menus;
+}
+
+static const int Rounds = 20;
+
+static void PrintRow(const char *name, double first, double best, const TFT_HostStats_t &before)
+{
+    printf("%-24s %10.1f %10.1f %8u %10llu\n", name, first, best, (tft.Stats.PushCalls - before.PushCalls) / (Rounds + 1),
+           (unsigned long long)(tft.Stats.Pixels - before.Pixels) / (Rounds + 1));
+}
+
+// Writes a 24 bits BMP logo, as there are none in the data folder
+static bool WriteBmp(const char *path, int32_t width, int32_t height)
+{
+    File f = ftdfs->open(path, "w");
+    if (!f)
+    {
+        return false;
+    }
+    uint32_t rowSize = (width * 3 + 3) & ~3;
+    uint8_t header[54] = {'B', 'M'};
+    auto put32 = [&header](size_t offset, uint32_t value)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            header[offset + i] = value >> (8 * i);
+        }
+    };
+    put32(2, sizeof(header) + rowSize * height);
+    put32(10, sizeof(header));
+    put32(14, 40);
+    put32(18, width);
+    put32(22, height);
+    // one plane, 24 bits per pixel, no compression
+    put32(26, 1 | (24 << 16));
+    put32(34, rowSize * height);
+    f.write(header, sizeof(header));
+    std::vector<uint8_t> row(rowSize, 0);
+    for (int32_t y = 0; y < height; y++)
+    {
+        for (int32_t x = 0; x < width; x++)
+        {
+            row[x * 3] = x * 255 / width;
+            row[x * 3 + 1] = y * 255 / height;
+            row[x * 3 + 2] = 128;
+        }
+        f.write(row.data(), rowSize);
+    }
+    f.close();
+    return true;
+}
+
+static void BenchMenus()
+{
+    printf("\n%-24s %10s %10s %8s %10s\n", "menu (us)", "first", "best", "pushes", "pixels");
+    int drawn = 0;
+    for (auto m : Menus)
+    {
+        if (m->Type == MenuTypes::EMPTY || !m->Load())
+        {
+            continue;
+        }
+        drawn++;
+        TFT_HostStats_t before = tft.Stats;
+        auto render = [m]()
+        {
+            m->Activate();
+            m->Draw(true);
+            m->Deactivate();
+        };
+        double first = HostTest::BestOf(1, render);
+        PrintRow(m->Name.c_str(), first, HostTest::BestOf(Rounds, render), before);
+    }
+    CHECK(drawn > 0);
+
+    printf("\n%-24s %10s %10s %8s %10s\n", "shape/images (us)", "shape", "images", "pushes", "pixels");
+    for (auto m : Menus)
+    {
+        if (m->Type == MenuTypes::EMPTY || !m->Loaded)
+        {
+            continue;
+        }
+        TFT_HostStats_t before = tft.Stats;
+        m->Activate();
+        double shape = HostTest::BestOf(Rounds + 1, [m]()
+                                        { m->DrawShape(true); });
+        double images = HostTest::BestOf(Rounds + 1, [m]()
+                                         { m->DrawImages(true); });
+        m->Deactivate();
+        printf("%-24s %10.1f %10.1f %8u %10llu\n", m->Name.c_str(), shape, images,
+               (tft.Stats.PushCalls - before.PushCalls) / (2 * (Rounds + 1)),
+               (unsigned long long)(tft.Stats.Pixels - before.Pixels) / (2 * (Rounds + 1)));
+    }
+}
+
+static void BenchLogos()
+{
+    std::vector<std::string> logos;
+    DIR *dir = opendir((SPIFFS.Root + "/logos").c_str());
+    CHECK(dir != NULL);
+    for (struct dirent *entry = dir ? readdir(dir) : NULL; entry; entry = readdir(dir))
+    {
+        if (entry->d_name[0] != '.')
+        {
+            logos.push_back(entry->d_name);
+        }
+    }
+    if (dir)
+    {
+        closedir(dir);
+    }
+    std::sort(logos.begin(), logos.end());
+    printf("\n%-24s %10s %10s %10s %8s %10s\n", "logo (us)", "decode", "first", "best", "pushes", "pixels");
+    for (auto &name : logos)
+    {
+        ImageWrapper *image = ImageCache::GetImage(name);
+        CHECK(image && image->IsValid());
+        if (!image || !image->IsValid())
+        {
+            continue;
+        }
+        auto draw = [image]()
+        {
+            image->Draw(0, 0, false);
+        };
+        // decoding the file, which draws skip once the pixels are cached
+        double decode = HostTest::BestOf(Rounds, [image]()
+                                         {
+                                             uint16_t width = 0;
+                                             uint16_t height = 0;
+                                             uint16_t *pixels = image->DecodeToBuffer(1, &width, &height);
+                                             CHECK(pixels && width == image->w && height == image->h);
+                                             free(pixels);
+                                         });
+        TFT_HostStats_t drawStats = tft.Stats;
+        double first = HostTest::BestOf(1, draw);
+        double best = HostTest::BestOf(Rounds, draw);
+        printf("%-24s %10.1f %10.1f %10.1f %8u %10llu\n", name.c_str(), decode, first, best,
+               (tft.Stats.PushCalls - drawStats.PushCalls) / (Rounds + 1),
+               (unsigned long long)(tft.Stats.Pixels - drawStats.Pixels) / (Rounds + 1));
+    }
+}
+
+// Logos larger than their button are decoded scaled down once, then kept
+static void BenchScaledLogo()
+{
+    ImageWrapper *image = ImageCache::GetImage("gradient_large.bmp");
+    CHECK(image && image->IsValid());
+    if (!image || !image->IsValid())
+    {
+        return;
+    }
+    uint16_t width = 0;
+    uint16_t height = 0;
+    CHECK(ImageCache::GetScaledPixels(image, 4, &width, &height) == NULL);
+    double decode = HostTest::BestOf(Rounds, [image]()
+                                     {
+                                         uint16_t w = 0;
+                                         uint16_t h = 0;
+                                         free(image->DecodeToBuffer(4, &w, &h));
+                                     });
+    uint16_t *pixels = image->DecodeToBuffer(4, &width, &height);
+    CHECK(pixels && width == 75 && height == 75);
+    CHECK(ImageCache::KeepScaledPixels(image, 4, pixels, width, height));
+    double cached = HostTest::BestOf(Rounds, [image, pixels]()
+                                     {
+                                         uint16_t w = 0;
+                                         uint16_t h = 0;
+                                         CHECK(ImageCache::GetScaledPixels(image, 4, &w, &h) == pixels && w == 75 && h == 75);
+                                     });
+    // another scale of the same logo is a separate entry
+    CHECK(ImageCache::GetScaledPixels(image, 2, &width, &height) == NULL);
+    ImageCache::ReleaseScaledPixels(image);
+    CHECK(ImageCache::GetScaledPixels(image, 4, &width, &height) == NULL);
+    printf("\n%-24s %10s %10s\n", "1/4 scale logo (us)", "decode", "cached");
+    printf("%-24s %10.1f %10.1f\n", image->LogoName.c_str(), decode, cached);
+}
+
+int main(int argc, char **argv)
+{
+    HostSetVerbose(argc > 1 && strcmp(argv[1], "-v") == 0);
+    if (!HostTest::MountData("bench_render_fs"))
+    {
+        return 1;
+    }
+    SetGeneralConfigDefaults();
+    InitSystem();
+    CHECK(WriteBmp("/logos/gradient.bmp", 75, 75));
+    CHECK(WriteBmp("/logos/gradient_small.bmp", 40, 40));
+    BenchMenus();
+    BenchLogos();
+    CHECK(WriteBmp("/logos/gradient_large.bmp", 300, 300));
+    BenchScaledLogo();
+    printf("\nscreen totals: %u pushes, %llu bytes pushed, %llu pixels\n", tft.Stats.PushCalls,
+           (unsigned long long)tft.Stats.PushBytes, (unsigned long long)tft.Stats.Pixels);
+    return HostTest::Result("bench_render");
+}
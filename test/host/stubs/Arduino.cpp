@@ -0,0 +1,287 @@
+#include <Arduino.h>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <vector>
+#include <cstdarg>
+#include "esp_partition.h"
+#include "esp_bt.h"
+#include "esp_bt_device.h"
+#include "rom/rtc.h"
+#include "Wire.h"
+#include "Host.h"
+
+static const auto StartTime = std::chrono::steady_clock::now();
+static bool Verbose = false;
+static size_t FreeInternal = 256 * 1024;
+static size_t FreePsram = 0;
+HardwareSerial Serial;
+EspClass ESP;
+TwoWire Wire;
+
+void HostSetVerbose(bool verbose)
+{
+    Verbose = verbose;
+}
+void HostSetFreeHeap(size_t internal, size_t psram)
+{
+    FreeInternal = internal;
+    FreePsram = psram;
+}
+void HostLog(char level, const char *tag, const char *fmt, ...)
+{
+    if (!Verbose && level != 'E')
+    {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "[%c][%s] ", level, tag);
+    vfprintf(stderr, fmt, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+}
+
+unsigned long millis()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - StartTime).count();
+}
+unsigned long micros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - StartTime).count();
+}
+int64_t esp_timer_get_time()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - StartTime).count();
+}
+void delay(uint32_t ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+void yield()
+{
+    std::this_thread::yield();
+}
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t val) {}
+int digitalRead(uint8_t pin) { return HIGH; }
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {}
+void detachInterrupt(uint8_t pin) {}
+double ledcSetup(uint8_t channel, double freq, uint8_t resolution_bits) { return freq; }
+void ledcAttachPin(uint8_t pin, uint8_t channel) {}
+void ledcDetachPin(uint8_t pin) {}
+void ledcWrite(uint8_t channel, uint32_t duty) {}
+double ledcWriteTone(uint8_t channel, double freq) { return freq; }
+void btStop() {}
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+void EspClass::restart()
+{
+    esp_restart();
+}
+uint32_t EspClass::getFreeHeap() { return FreeInternal + FreePsram; }
+uint32_t EspClass::getHeapSize() { return 320 * 1024 + FreePsram; }
+uint32_t EspClass::getMinFreeHeap() { return getFreeHeap(); }
+uint32_t EspClass::getMaxAllocHeap() { return FreeInternal; }
+uint32_t EspClass::getPsramSize() { return FreePsram; }
+uint32_t EspClass::getFreePsram() { return FreePsram; }
+const char *EspClass::getSdkVersion() { return esp_get_idf_version(); }
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--)
+    {
+        n += write(*buffer++);
+    }
+    return n;
+}
+size_t Print::printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (len <= 0)
+    {
+        return 0;
+    }
+    std::vector<char> buffer(len + 1);
+    va_start(args, format);
+    vsnprintf(buffer.data(), buffer.size(), format, args);
+    va_end(args);
+    return write((const uint8_t *)buffer.data(), len);
+}
+size_t Print::print(long value, int base)
+{
+    char buffer[70];
+    if (base == 16)
+    {
+        snprintf(buffer, sizeof(buffer), "%lx", value);
+    }
+    else
+    {
+        snprintf(buffer, sizeof(buffer), "%ld", value);
+    }
+    return write(buffer);
+}
+size_t Print::print(unsigned long value, int base)
+{
+    char buffer[70];
+    snprintf(buffer, sizeof(buffer), base == 16 ? "%lx" : "%lu", value);
+    return write(buffer);
+}
+size_t Print::print(double value, int digits)
+{
+    char buffer[70];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return write(buffer);
+}
+size_t HardwareSerial::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    if (Verbose)
+    {
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code)
+    {
+    case ESP_OK:
+        return "ESP_OK";
+    case ESP_ERR_NO_MEM:
+        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+        return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:
+        return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:
+        return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:
+        return "ESP_ERR_NOT_FOUND";
+    default:
+        return "ESP_FAIL";
+    }
+}
+static std::vector<shutdown_handler_t> ShutdownHandlers;
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handle)
+{
+    for (auto h : ShutdownHandlers)
+    {
+        if (h == handle)
+        {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    ShutdownHandlers.push_back(handle);
+    return ESP_OK;
+}
+void esp_restart()
+{
+    for (auto h : ShutdownHandlers)
+    {
+        h();
+    }
+    fprintf(stderr, "esp_restart called\n");
+    exit(2);
+}
+uint32_t esp_random()
+{
+    static std::mt19937 generator(0x5eed);
+    return generator();
+}
+const char *esp_get_idf_version()
+{
+    return "host";
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    if (caps & MALLOC_CAP_SPIRAM)
+    {
+        return FreePsram;
+    }
+    return (caps & MALLOC_CAP_INTERNAL) ? FreeInternal : FreeInternal + FreePsram;
+}
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    if ((caps & MALLOC_CAP_SPIRAM) && FreePsram == 0)
+    {
+        return NULL;
+    }
+    return malloc(size);
+}
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause()
+{
+    return ESP_SLEEP_WAKEUP_UNDEFINED;
+}
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t gpio_num, int level)
+{
+    return ESP_OK;
+}
+void esp_deep_sleep_start()
+{
+    fprintf(stderr, "esp_deep_sleep_start called\n");
+    exit(2);
+}
+void esp_deep_sleep(uint64_t time_in_us)
+{
+    esp_deep_sleep_start();
+}
+esp_err_t esp_bt_controller_disable() { return ESP_OK; }
+esp_err_t esp_bt_controller_deinit() { return ESP_OK; }
+esp_err_t esp_bt_controller_mem_release(esp_bt_mode_t mode) { return ESP_OK; }
+const uint8_t *esp_bt_dev_get_address()
+{
+    static const uint8_t address[6] = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x01};
+    return address;
+}
+RESET_REASON rtc_get_reset_reason(int cpu_no)
+{
+    return POWERON_RESET;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char *label)
+{
+    return NULL;
+}
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    return ESP_ERR_NOT_FOUND;
+}
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    return ESP_ERR_NOT_FOUND;
+}
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    return ESP_ERR_NOT_FOUND;
+}
+esp_err_t esp_partition_mmap(const esp_partition_t *partition, size_t offset, size_t size, spi_flash_mmap_memory_t memory, const void **out_ptr, spi_flash_mmap_handle_t *out_handle)
+{
+    return ESP_ERR_NOT_FOUND;
+}
+void spi_flash_munmap(spi_flash_mmap_handle_t handle) {}
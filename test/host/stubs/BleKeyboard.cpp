@@ -0,0 +1,95 @@
+#include "BleKeyboard.h"
+#include "HidReport.h"
+
+void BleKeyboard::sendReport(KeyReport *keys)
+{
+    Reports++;
+    LastReport = *keys;
+}
+void BleKeyboard::sendReport(MediaKeyReport *keys)
+{
+    MediaReports++;
+}
+// Keys are converted as the sketch does to pack its reports
+size_t BleKeyboard::press(uint8_t k)
+{
+    uint8_t usage = 0;
+    uint8_t modifiers = 0;
+    if (!FreeTouchDeck::KeyToUsage(k, &usage, &modifiers))
+    {
+        if (modifiers == 0)
+        {
+            return 0;
+        }
+    }
+    _keyReport.modifiers |= modifiers;
+    if (usage != 0 && !memchr(_keyReport.keys, usage, sizeof(_keyReport.keys)))
+    {
+        uint8_t *slot = (uint8_t *)memchr(_keyReport.keys, 0, sizeof(_keyReport.keys));
+        if (!slot)
+        {
+            return 0;
+        }
+        *slot = usage;
+    }
+    sendReport(&_keyReport);
+    return 1;
+}
+size_t BleKeyboard::press(const MediaKeyReport k)
+{
+    _mediaKeyReport[0] |= k[0];
+    _mediaKeyReport[1] |= k[1];
+    sendReport(&_mediaKeyReport);
+    return 1;
+}
+size_t BleKeyboard::release(uint8_t k)
+{
+    uint8_t usage = 0;
+    uint8_t modifiers = 0;
+    FreeTouchDeck::KeyToUsage(k, &usage, &modifiers);
+    _keyReport.modifiers &= ~modifiers;
+    for (auto &key : _keyReport.keys)
+    {
+        if (usage != 0 && key == usage)
+        {
+            key = 0;
+        }
+    }
+    sendReport(&_keyReport);
+    return 1;
+}
+size_t BleKeyboard::release(const MediaKeyReport k)
+{
+    _mediaKeyReport[0] &= ~k[0];
+    _mediaKeyReport[1] &= ~k[1];
+    sendReport(&_mediaKeyReport);
+    return 1;
+}
+size_t BleKeyboard::write(uint8_t c)
+{
+    size_t p = press(c);
+    release(c);
+    return p;
+}
+size_t BleKeyboard::write(const MediaKeyReport c)
+{
+    size_t p = press(c);
+    release(c);
+    return p;
+}
+size_t BleKeyboard::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--)
+    {
+        n += write(*buffer++);
+    }
+    return n;
+}
+void BleKeyboard::releaseAll()
+{
+    memset(&_keyReport, 0x00, sizeof(_keyReport));
+    _mediaKeyReport[0] = 0;
+    _mediaKeyReport[1] = 0;
+    sendReport(&_keyReport);
+}
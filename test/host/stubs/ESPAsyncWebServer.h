@@ -0,0 +1,16 @@
+#pragma once
+// Only declares the web server types named by the sketch headers
+#include <Arduino.h>
+#include "FS.h"
+class AsyncWebServerRequest
+{
+public:
+    File _tempFile;
+};
+class AsyncWebServer
+{
+public:
+    AsyncWebServer(uint16_t port) {}
+    void begin() {}
+    void end() {}
+};
@@ -0,0 +1,355 @@
+#include "FS.h"
+#include "SPIFFS.h"
+#include "SD.h"
+#include "Host.h"
+#include <algorithm>
+#include <cstdio>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+fs::SPIFFSFS SPIFFS;
+fs::SDFS SD;
+
+namespace fs
+{
+    class FileImpl
+    {
+    public:
+        ~FileImpl() { Close(); }
+        void Close()
+        {
+            if (Handle)
+            {
+                fclose(Handle);
+                Handle = NULL;
+            }
+            Open = false;
+        }
+        FS *Owner = NULL;
+        std::string Path;
+        std::string HostPath;
+        FILE *Handle = NULL;
+        bool Open = false;
+        bool Directory = false;
+        bool Writing = false;
+        // entries of a directory, as full paths
+        std::vector<std::string> Entries;
+        size_t NextEntry = 0;
+    };
+
+    size_t File::write(uint8_t c)
+    {
+        return write(&c, 1);
+    }
+    size_t File::write(const uint8_t *buf, size_t size)
+    {
+        if (!_p || !_p->Handle || !_p->Writing)
+        {
+            return 0;
+        }
+        size_t written = fwrite(buf, 1, size, _p->Handle);
+        _p->Owner->BytesWritten += written;
+        return written;
+    }
+    int File::available()
+    {
+        return _p && _p->Handle ? (int)(size() - position()) : 0;
+    }
+    int File::read()
+    {
+        uint8_t c = 0;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+    int File::peek()
+    {
+        int c = read();
+        if (c >= 0)
+        {
+            fseek(_p->Handle, -1, SEEK_CUR);
+        }
+        return c;
+    }
+    void File::flush()
+    {
+        if (_p && _p->Handle)
+        {
+            fflush(_p->Handle);
+        }
+    }
+    size_t File::read(uint8_t *buf, size_t size)
+    {
+        if (!_p || !_p->Handle || _p->Writing)
+        {
+            return 0;
+        }
+        return fread(buf, 1, size, _p->Handle);
+    }
+    bool File::seek(uint32_t pos, SeekMode mode)
+    {
+        if (!_p || !_p->Handle)
+        {
+            return false;
+        }
+        return fseek(_p->Handle, pos, mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END) == 0;
+    }
+    size_t File::position() const
+    {
+        return _p && _p->Handle ? ftell(_p->Handle) : 0;
+    }
+    size_t File::size() const
+    {
+        if (!_p || !_p->Open || _p->Directory)
+        {
+            return 0;
+        }
+        if (_p->Handle)
+        {
+            fflush(_p->Handle);
+        }
+        struct stat st;
+        return stat(_p->HostPath.c_str(), &st) == 0 ? st.st_size : 0;
+    }
+    void File::close()
+    {
+        if (_p)
+        {
+            _p->Close();
+        }
+    }
+    File::operator bool() const
+    {
+        return _p && _p->Open;
+    }
+    time_t File::getLastWrite()
+    {
+        struct stat st;
+        return _p && stat(_p->HostPath.c_str(), &st) == 0 ? st.st_mtime : 0;
+    }
+    const char *File::name() const
+    {
+        return _p ? _p->Path.c_str() : NULL;
+    }
+    const char *File::path() const
+    {
+        return name();
+    }
+    bool File::isDirectory()
+    {
+        return _p && _p->Directory;
+    }
+    File File::openNextFile(const char *mode)
+    {
+        if (!_p || !_p->Directory || _p->NextEntry >= _p->Entries.size())
+        {
+            return File();
+        }
+        return _p->Owner->open(_p->Entries[_p->NextEntry++].c_str(), mode);
+    }
+    void File::rewindDirectory()
+    {
+        if (_p)
+        {
+            _p->NextEntry = 0;
+        }
+    }
+
+    std::string FS::HostPath(const char *path) const
+    {
+        std::string p = path ? path : "";
+        if (p.empty() || p[0] != '/')
+        {
+            p = "/" + p;
+        }
+        return Root + p;
+    }
+    // creates the folders of the path, as SPIFFS has none to create
+    static void MakeParents(const std::string &hostPath)
+    {
+        for (size_t pos = hostPath.find('/', 1); pos != std::string::npos; pos = hostPath.find('/', pos + 1))
+        {
+            ::mkdir(hostPath.substr(0, pos).c_str(), 0755);
+        }
+    }
+    File FS::open(const char *path, const char *mode)
+    {
+        if (!Mounted)
+        {
+            return File();
+        }
+        FileImplPtr impl = std::make_shared<FileImpl>();
+        impl->Owner = this;
+        impl->Path = path;
+        impl->HostPath = HostPath(path);
+        struct stat st;
+        bool exists = stat(impl->HostPath.c_str(), &st) == 0;
+        if (exists && S_ISDIR(st.st_mode))
+        {
+            DIR *dir = opendir(impl->HostPath.c_str());
+            if (!dir)
+            {
+                return File();
+            }
+            std::string prefix = impl->Path == "/" ? "" : impl->Path;
+            for (struct dirent *entry = readdir(dir); entry; entry = readdir(dir))
+            {
+                if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+                {
+                    impl->Entries.push_back(prefix + "/" + entry->d_name);
+                }
+            }
+            closedir(dir);
+            std::sort(impl->Entries.begin(), impl->Entries.end());
+            impl->Directory = true;
+            impl->Open = true;
+            return File(impl);
+        }
+        impl->Writing = mode && (mode[0] == 'w' || mode[0] == 'a');
+        if (!impl->Writing && !exists)
+        {
+            return File();
+        }
+        if (impl->Writing)
+        {
+            MakeParents(impl->HostPath);
+            FilesWritten++;
+        }
+        impl->Handle = fopen(impl->HostPath.c_str(), impl->Writing ? (mode[0] == 'a' ? "ab" : "wb") : "rb");
+        impl->Open = impl->Handle != NULL;
+        return impl->Open ? File(impl) : File();
+    }
+    bool FS::exists(const char *path)
+    {
+        struct stat st;
+        return Mounted && stat(HostPath(path).c_str(), &st) == 0;
+    }
+    bool FS::remove(const char *path)
+    {
+        return Mounted && unlink(HostPath(path).c_str()) == 0;
+    }
+    bool FS::rename(const char *pathFrom, const char *pathTo)
+    {
+        if (!Mounted || exists(pathTo))
+        {
+            return false;
+        }
+        std::string to = HostPath(pathTo);
+        MakeParents(to);
+        return ::rename(HostPath(pathFrom).c_str(), to.c_str()) == 0;
+    }
+    bool FS::mkdir(const char *path)
+    {
+        return Mounted && (::mkdir(HostPath(path).c_str(), 0755) == 0 || errno == EEXIST);
+    }
+    bool FS::rmdir(const char *path)
+    {
+        return Mounted && ::rmdir(HostPath(path).c_str()) == 0;
+    }
+
+    bool SPIFFSFS::begin(bool formatOnFail, const char *basePath, uint8_t maxOpenFiles, const char *partitionLabel)
+    {
+        struct stat st;
+        Mounted = !Root.empty() && stat(Root.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+        return Mounted;
+    }
+    bool SPIFFSFS::format()
+    {
+        return false;
+    }
+    size_t SPIFFSFS::totalBytes()
+    {
+        return 1024 * 1024;
+    }
+    size_t SPIFFSFS::usedBytes()
+    {
+        return 0;
+    }
+    void SPIFFSFS::end()
+    {
+        Mounted = false;
+    }
+}
+
+static bool CopyTree(const std::string &source, const std::string &target)
+{
+    DIR *dir = opendir(source.c_str());
+    if (!dir || (::mkdir(target.c_str(), 0755) != 0 && errno != EEXIST))
+    {
+        if (dir)
+        {
+            closedir(dir);
+        }
+        return false;
+    }
+    bool result = true;
+    for (struct dirent *entry = readdir(dir); entry && result; entry = readdir(dir))
+    {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+        {
+            continue;
+        }
+        std::string from = source + "/" + entry->d_name;
+        std::string to = target + "/" + entry->d_name;
+        struct stat st;
+        if (stat(from.c_str(), &st) != 0)
+        {
+            result = false;
+        }
+        else if (S_ISDIR(st.st_mode))
+        {
+            result = CopyTree(from, to);
+        }
+        else
+        {
+            FILE *in = fopen(from.c_str(), "rb");
+            FILE *out = fopen(to.c_str(), "wb");
+            char buffer[4096];
+            size_t len = 0;
+            while (in && out && (len = fread(buffer, 1, sizeof(buffer), in)) > 0)
+            {
+                fwrite(buffer, 1, len, out);
+            }
+            result = in && out;
+            if (in)
+            {
+                fclose(in);
+            }
+            if (out)
+            {
+                fclose(out);
+            }
+        }
+    }
+    closedir(dir);
+    return result;
+}
+static void RemoveTree(const std::string &path)
+{
+    DIR *dir = opendir(path.c_str());
+    if (!dir)
+    {
+        unlink(path.c_str());
+        return;
+    }
+    for (struct dirent *entry = readdir(dir); entry; entry = readdir(dir))
+    {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+        {
+            RemoveTree(path + "/" + entry->d_name);
+        }
+    }
+    closedir(dir);
+    ::rmdir(path.c_str());
+}
+bool HostMountCopy(const std::string &source, const std::string &target)
+{
+    RemoveTree(target);
+    if (!CopyTree(source, target))
+    {
+        fprintf(stderr, "Unable to copy %s to %s\n", source.c_str(), target.c_str());
+        return false;
+    }
+    SPIFFS.Root = target;
+    return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+// Host stand-in for the Arduino file system API. Files are kept in a host
+// directory, with the flat namespace of SPIFFS: folders are created when a
+// file is written to them, and a rename never replaces an existing file.
+#include <memory>
+#include <string>
+#include <ctime>
+#include "Print.h"
+#include "WString.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs
+{
+    enum SeekMode
+    {
+        SeekSet = 0,
+        SeekCur = 1,
+        SeekEnd = 2
+    };
+    class FileImpl;
+    typedef std::shared_ptr<FileImpl> FileImplPtr;
+    class File : public Print
+    {
+    public:
+        File(FileImplPtr p = FileImplPtr()) : _p(p) {}
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t *buf, size_t size) override;
+        using Print::write;
+        int available();
+        int read();
+        int peek();
+        void flush();
+        size_t read(uint8_t *buf, size_t size);
+        size_t readBytes(char *buffer, size_t length) { return read((uint8_t *)buffer, length); }
+        bool seek(uint32_t pos, SeekMode mode);
+        bool seek(uint32_t pos) { return seek(pos, SeekSet); }
+        size_t position() const;
+        size_t size() const;
+        void close();
+        operator bool() const;
+        time_t getLastWrite();
+        // full path, as SPIFFS reports it
+        const char *name() const;
+        const char *path() const;
+        bool isDirectory();
+        File openNextFile(const char *mode = FILE_READ);
+        void rewindDirectory();
+
+    protected:
+        FileImplPtr _p;
+    };
+    class FS
+    {
+    public:
+        File open(const char *path, const char *mode = FILE_READ);
+        File open(const String &path, const char *mode = FILE_READ) { return open(path.c_str(), mode); }
+        bool exists(const char *path);
+        bool exists(const String &path) { return exists(path.c_str()); }
+        bool remove(const char *path);
+        bool remove(const String &path) { return remove(path.c_str()); }
+        bool rename(const char *pathFrom, const char *pathTo);
+        bool rename(const String &pathFrom, const String &pathTo) { return rename(pathFrom.c_str(), pathTo.c_str()); }
+        bool mkdir(const char *path);
+        bool mkdir(const String &path) { return mkdir(path.c_str()); }
+        bool rmdir(const char *path);
+        bool rmdir(const String &path) { return rmdir(path.c_str()); }
+        // host directory holding the files, empty until set
+        std::string Root;
+        bool Mounted = false;
+        // number of bytes written to files, and of files opened for writing
+        uint64_t BytesWritten = 0;
+        uint32_t FilesWritten = 0;
+
+    protected:
+        std::string HostPath(const char *path) const;
+    };
+}
+using fs::File;
+using fs::FS;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekMode;
+using fs::SeekSet;
@@ -0,0 +1,343 @@
+#include <Arduino.h>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+static std::recursive_mutex &CriticalLock()
+{
+    // constructed on first use, semaphores are created by static initializers
+    static std::recursive_mutex *lock = new std::recursive_mutex();
+    return *lock;
+}
+void HostEnterCritical(portMUX_TYPE *mux)
+{
+    CriticalLock().lock();
+    mux->count++;
+}
+void HostExitCritical(portMUX_TYPE *mux)
+{
+    mux->count--;
+    CriticalLock().unlock();
+}
+void HostYield()
+{
+    std::this_thread::yield();
+}
+
+// Waits on the condition until the predicate is true or the ticks elapsed
+template <typename Predicate>
+static bool WaitFor(std::condition_variable &condition, std::unique_lock<std::mutex> &lock, TickType_t xTicksToWait, Predicate predicate)
+{
+    if (xTicksToWait == portMAX_DELAY)
+    {
+        condition.wait(lock, predicate);
+        return true;
+    }
+    return condition.wait_for(lock, std::chrono::milliseconds(xTicksToWait), predicate);
+}
+
+struct HostSemaphore
+{
+    std::mutex Lock;
+    std::condition_variable Available;
+    UBaseType_t Count;
+    UBaseType_t MaxCount;
+    bool Recursive = false;
+    std::thread::id Owner;
+    UBaseType_t Depth = 0;
+};
+static SemaphoreHandle_t CreateSemaphore(UBaseType_t maxCount, UBaseType_t initialCount)
+{
+    SemaphoreHandle_t semaphore = new HostSemaphore();
+    semaphore->MaxCount = maxCount;
+    semaphore->Count = initialCount;
+    return semaphore;
+}
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return CreateSemaphore(1, 1);
+}
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex()
+{
+    SemaphoreHandle_t semaphore = CreateSemaphore(1, 1);
+    semaphore->Recursive = true;
+    return semaphore;
+}
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    return CreateSemaphore(1, 0);
+}
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount)
+{
+    return CreateSemaphore(maxCount, initialCount);
+}
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t xTicksToWait)
+{
+    std::unique_lock<std::mutex> lock(semaphore->Lock);
+    if (!WaitFor(semaphore->Available, lock, xTicksToWait, [semaphore]()
+                 { return semaphore->Count > 0; }))
+    {
+        return pdFALSE;
+    }
+    semaphore->Count--;
+    semaphore->Owner = std::this_thread::get_id();
+    return pdTRUE;
+}
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    std::lock_guard<std::mutex> lock(semaphore->Lock);
+    if (semaphore->Count >= semaphore->MaxCount)
+    {
+        return pdFALSE;
+    }
+    semaphore->Count++;
+    semaphore->Owner = std::thread::id();
+    semaphore->Available.notify_one();
+    return pdTRUE;
+}
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t xTicksToWait)
+{
+    {
+        std::lock_guard<std::mutex> lock(semaphore->Lock);
+        if (semaphore->Depth > 0 && semaphore->Owner == std::this_thread::get_id())
+        {
+            semaphore->Depth++;
+            return pdTRUE;
+        }
+    }
+    if (xSemaphoreTake(semaphore, xTicksToWait) != pdTRUE)
+    {
+        return pdFALSE;
+    }
+    std::lock_guard<std::mutex> lock(semaphore->Lock);
+    semaphore->Depth = 1;
+    return pdTRUE;
+}
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore)
+{
+    {
+        std::lock_guard<std::mutex> lock(semaphore->Lock);
+        if (semaphore->Depth == 0 || semaphore->Owner != std::this_thread::get_id())
+        {
+            return pdFALSE;
+        }
+        if (--semaphore->Depth > 0)
+        {
+            return pdTRUE;
+        }
+    }
+    return xSemaphoreGive(semaphore);
+}
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    return xSemaphoreGive(semaphore);
+}
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    delete semaphore;
+}
+
+struct HostTask
+{
+    std::string Name;
+    std::mutex Lock;
+    std::condition_variable Notified;
+    uint32_t Notifications = 0;
+};
+static thread_local HostTask *CurrentTask = NULL;
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask)
+{
+    HostTask *task = new HostTask();
+    task->Name = pcName ? pcName : "";
+    if (pxCreatedTask)
+    {
+        *pxCreatedTask = task;
+    }
+    // tasks run until the process exits
+    std::thread([task, pvTaskCode, pvParameters]()
+                {
+                    CurrentTask = task;
+                    pvTaskCode(pvParameters);
+                })
+        .detach();
+    return pdPASS;
+}
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask, BaseType_t xCoreID)
+{
+    return xTaskCreate(pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask);
+}
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    if (!CurrentTask)
+    {
+        // threads not started by xTaskCreate, e.g. the main thread, become tasks when they first ask
+        CurrentTask = new HostTask();
+        CurrentTask->Name = "main";
+    }
+    return CurrentTask;
+}
+char *pcTaskGetTaskName(TaskHandle_t xTaskToQuery)
+{
+    TaskHandle_t task = xTaskToQuery ? xTaskToQuery : xTaskGetCurrentTaskHandle();
+    return (char *)task->Name.c_str();
+}
+TickType_t xTaskGetTickCount()
+{
+    return (TickType_t)millis();
+}
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+    delay(xTicksToDelay);
+}
+void vTaskDelayUntil(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement)
+{
+    *pxPreviousWakeTime += xTimeIncrement;
+    int32_t remaining = (int32_t)(*pxPreviousWakeTime - xTaskGetTickCount());
+    if (remaining > 0)
+    {
+        delay(remaining);
+    }
+}
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    HostTask *task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->Lock);
+    WaitFor(task->Notified, lock, xTicksToWait, [task]()
+            { return task->Notifications > 0; });
+    uint32_t value = task->Notifications;
+    if (value > 0)
+    {
+        task->Notifications = xClearCountOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+    std::lock_guard<std::mutex> lock(xTaskToNotify->Lock);
+    xTaskToNotify->Notifications++;
+    xTaskToNotify->Notified.notify_all();
+    return pdPASS;
+}
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    xTaskNotifyGive(xTaskToNotify);
+}
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask)
+{
+    return 1024;
+}
+
+struct HostTimer
+{
+    esp_timer_create_args_t Args;
+    // esp_timer_get_time of the next expiry, 0 when stopped
+    int64_t Deadline = 0;
+    uint64_t Period = 0;
+};
+// All the timers are run by a single dispatcher thread, as by the esp_timer task
+static std::mutex TimersLock;
+static std::condition_variable TimersChanged;
+static std::multimap<int64_t, HostTimer *> Armed;
+static void Disarm(HostTimer *timer)
+{
+    for (auto it = Armed.begin(); it != Armed.end(); ++it)
+    {
+        if (it->second == timer)
+        {
+            Armed.erase(it);
+            break;
+        }
+    }
+    timer->Deadline = 0;
+}
+static void TimersTask()
+{
+    std::unique_lock<std::mutex> lock(TimersLock);
+    for (;;)
+    {
+        if (Armed.empty())
+        {
+            TimersChanged.wait(lock);
+            continue;
+        }
+        int64_t now = esp_timer_get_time();
+        auto next = Armed.begin();
+        if (next->first > now)
+        {
+            TimersChanged.wait_for(lock, std::chrono::microseconds(next->first - now));
+            continue;
+        }
+        HostTimer *timer = next->second;
+        Armed.erase(next);
+        timer->Deadline = 0;
+        if (timer->Period > 0)
+        {
+            timer->Deadline = now + timer->Period;
+            Armed.insert(std::make_pair(timer->Deadline, timer));
+        }
+        // callbacks may start or stop timers
+        lock.unlock();
+        timer->Args.callback(timer->Args.arg);
+        lock.lock();
+    }
+}
+static esp_err_t Arm(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period)
+{
+    static std::once_flag started;
+    std::call_once(started, []()
+                   { std::thread(TimersTask).detach(); });
+    std::lock_guard<std::mutex> lock(TimersLock);
+    if (timer->Deadline != 0)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->Deadline = esp_timer_get_time() + timeout_us;
+    timer->Period = period;
+    Armed.insert(std::make_pair(timer->Deadline, timer));
+    TimersChanged.notify_all();
+    return ESP_OK;
+}
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    if (!create_args || !create_args->callback || !out_handle)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    HostTimer *timer = new HostTimer();
+    timer->Args = *create_args;
+    *out_handle = timer;
+    return ESP_OK;
+}
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return Arm(timer, timeout_us, 0);
+}
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    return Arm(timer, period, period);
+}
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    std::lock_guard<std::mutex> lock(TimersLock);
+    if (timer->Deadline == 0)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    Disarm(timer);
+    return ESP_OK;
+}
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    {
+        std::lock_guard<std::mutex> lock(TimersLock);
+        if (timer->Deadline != 0)
+        {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    delete timer;
+    return ESP_OK;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "Print.h"
+// Serial output goes to stdout, nothing is ever received
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long baud) {}
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() {}
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *buffer, size_t size);
+    using Print::write;
+};
+extern HardwareSerial Serial;
@@ -0,0 +1,11 @@
+#pragma once
+// Controls of the host stand-ins, for the tests and benchmarks
+#include <cstddef>
+#include <string>
+
+// Prints log lines of the sketch, which are hidden otherwise
+void HostSetVerbose(bool verbose);
+// Memory reported free by heap_caps_get_free_size, PSRAM is absent when 0
+void HostSetFreeHeap(size_t internal, size_t psram);
+// Mounts a copy of the source folder, e.g. the sketch's data folder, as SPIFFS
+bool HostMountCopy(const std::string &source, const std::string &target);
@@ -0,0 +1,25 @@
+#pragma once
+#include "FS.h"
+typedef enum
+{
+    CARD_NONE,
+    CARD_MMC,
+    CARD_SD,
+    CARD_SDHC,
+    CARD_UNKNOWN
+} sdcard_type_t;
+namespace fs
+{
+    // No card is ever inserted
+    class SDFS : public FS
+    {
+    public:
+        bool begin(uint8_t ssPin = 5) { return false; }
+        void end() {}
+        sdcard_type_t cardType() { return CARD_NONE; }
+        uint64_t cardSize() { return 0; }
+        uint64_t totalBytes() { return 0; }
+        uint64_t usedBytes() { return 0; }
+    };
+}
+extern fs::SDFS SD;
@@ -0,0 +1,17 @@
+// Stands in for the units the host build leaves out: the sketch itself,
+// and the WiFi configuration, which needs a network stack
+#include "globals.hpp"
+#include "ConfigHelper.h"
+static const char *module = "Sketch";
+#include "UserActions.h"
+
+const char *versionnumber = "host";
+
+namespace FreeTouchDeck
+{
+    Wificonfig wificonfig = {.ssid = NULL, .password = NULL, .wifimode = NULL, .hostname = NULL};
+    bool ConfigMode()
+    {
+        return false;
+    }
+}
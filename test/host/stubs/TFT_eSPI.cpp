@@ -0,0 +1,219 @@
+#include <TFT_eSPI.h>
+
+const GFXfont FreeSans9pt7b = {NULL, NULL, 0x20, 0x7E, 22};
+const GFXfont FreeSans12pt7b = {NULL, NULL, 0x20, 0x7E, 29};
+const GFXfont FreeSansBold9pt7b = {NULL, NULL, 0x20, 0x7E, 22};
+const GFXfont FreeSansBold12pt7b = {NULL, NULL, 0x20, 0x7E, 29};
+const GFXfont TomThumb = {NULL, NULL, 0x20, 0x7E, 6};
+
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h) : _width(w), _height(h), _initWidth(w), _initHeight(h)
+{
+    Stats = {0, 0, 0};
+}
+void TFT_eSPI::init(uint8_t tc)
+{
+    setRotation(0);
+}
+void TFT_eSPI::setRotation(uint8_t r)
+{
+    _rotation = r % 4;
+    _width = _rotation & 1 ? _initHeight : _initWidth;
+    _height = _rotation & 1 ? _initWidth : _initHeight;
+}
+void TFT_eSPI::CountPixels(int32_t x, int32_t y, int32_t w, int32_t h)
+{
+    int32_t x1 = max<int32_t>(x, 0);
+    int32_t y1 = max<int32_t>(y, 0);
+    int32_t x2 = min<int32_t>(x + w, _width);
+    int32_t y2 = min<int32_t>(y + h, _height);
+    if (x2 > x1 && y2 > y1)
+    {
+        Stats.Pixels += (uint64_t)(x2 - x1) * (y2 - y1);
+    }
+}
+void TFT_eSPI::fillScreen(uint32_t color)
+{
+    fillRect(0, 0, _width, _height, color);
+}
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+    CountPixels(x, y, w, h);
+}
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+    fillRect(x, y, w, 1, color);
+    fillRect(x, y + h - 1, w, 1, color);
+    fillRect(x, y + 1, 1, h - 2, color);
+    fillRect(x + w - 1, y + 1, 1, h - 2, color);
+}
+// Corners are drawn square, which changes the pixel count by a few pixels per corner
+void TFT_eSPI::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color)
+{
+    drawRect(x, y, w, h, color);
+}
+void TFT_eSPI::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color)
+{
+    fillRect(x, y, w, h, color);
+}
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data)
+{
+    Stats.PushCalls++;
+    Stats.PushBytes += (uint64_t)w * h * sizeof(uint16_t);
+    CountPixels(x, y, w, h);
+}
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, uint16_t transparent)
+{
+    pushImage(x, y, w, h, data);
+}
+void TFT_eSPI::setTextColor(uint16_t color, uint16_t background)
+{
+    _textColor = color;
+    _textBackground = background;
+}
+void TFT_eSPI::setTextFont(uint8_t font)
+{
+    _textFont = font;
+    _font = NULL;
+}
+int16_t TFT_eSPI::fontHeight()
+{
+    return (_font ? _font->yAdvance : 8) * _textSize;
+}
+// Characters are taken as half as wide as the line is high
+int16_t TFT_eSPI::textWidth(const char *string, uint8_t font)
+{
+    return string ? strlen(string) * fontHeight() / 2 : 0;
+}
+int16_t TFT_eSPI::drawString(const char *string, int32_t x, int32_t y)
+{
+    int16_t w = textWidth(string);
+    CountPixels(x, y, max<int16_t>(w, _textPadding), fontHeight());
+    return w;
+}
+void TFT_eSPI::setCursor(int16_t x, int16_t y)
+{
+    _cursorX = x;
+    _cursorY = y;
+}
+size_t TFT_eSPI::write(uint8_t c)
+{
+    if (c == '\n')
+    {
+        _cursorX = 0;
+        _cursorY += fontHeight();
+    }
+    else if (c != '\r')
+    {
+        CountPixels(_cursorX, _cursorY, fontHeight() / 2, fontHeight());
+        _cursorX += fontHeight() / 2;
+    }
+    return 1;
+}
+uint16_t TFT_eSPI::color24to16(uint32_t color888)
+{
+    return color565(color888 >> 16, color888 >> 8, color888);
+}
+uint32_t TFT_eSPI::color16to24(uint16_t color565)
+{
+    uint8_t r = (color565 >> 8) & 0xF8;
+    uint8_t g = (color565 >> 3) & 0xFC;
+    uint8_t b = (color565 << 3) & 0xF8;
+    return ((uint32_t)(r | r >> 5) << 16) | ((uint32_t)(g | g >> 6) << 8) | (b | b >> 5);
+}
+
+TFT_eSprite::TFT_eSprite(TFT_eSPI *tft) : TFT_eSPI(0, 0), _tft(tft)
+{
+}
+TFT_eSprite::~TFT_eSprite()
+{
+    deleteSprite();
+}
+void *TFT_eSprite::createSprite(int16_t w, int16_t h, uint8_t frames)
+{
+    deleteSprite();
+    _buffer = (uint16_t *)calloc((size_t)w * h, sizeof(uint16_t));
+    if (_buffer)
+    {
+        _width = _initWidth = w;
+        _height = _initHeight = h;
+    }
+    return _buffer;
+}
+void TFT_eSprite::deleteSprite()
+{
+    free(_buffer);
+    _buffer = NULL;
+    _width = _height = 0;
+}
+void *TFT_eSprite::setColorDepth(int8_t bits)
+{
+    return _buffer;
+}
+void TFT_eSprite::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+    int32_t x1 = max<int32_t>(x, 0);
+    int32_t y1 = max<int32_t>(y, 0);
+    int32_t x2 = min<int32_t>(x + w, _width);
+    int32_t y2 = min<int32_t>(y + h, _height);
+    if (!_buffer || x2 <= x1 || y2 <= y1)
+    {
+        return;
+    }
+    uint16_t pixel = _swapBytes ? color : (uint16_t)((color >> 8) | (color << 8));
+    for (int32_t row = y1; row < y2; row++)
+    {
+        std::fill(_buffer + row * _width + x1, _buffer + row * _width + x2, pixel);
+    }
+    CountPixels(x, y, w, h);
+}
+void TFT_eSprite::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+    TFT_eSPI::drawRect(x, y, w, h, color);
+}
+void TFT_eSprite::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data)
+{
+    if (!_buffer || !data)
+    {
+        return;
+    }
+    for (int32_t row = max<int32_t>(0, -y); row < h && y + row < _height; row++)
+    {
+        int32_t first = max<int32_t>(0, -x);
+        int32_t last = min<int32_t>(w, _width - x);
+        if (last > first)
+        {
+            memcpy(_buffer + (y + row) * _width + x + first, data + row * w + first, (last - first) * sizeof(uint16_t));
+        }
+    }
+    CountPixels(x, y, w, h);
+}
+void TFT_eSprite::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, uint16_t transparent)
+{
+    if (!_buffer || !data)
+    {
+        return;
+    }
+    for (int32_t row = max<int32_t>(0, -y); row < h && y + row < _height; row++)
+    {
+        for (int32_t col = max<int32_t>(0, -x); col < w && x + col < _width; col++)
+        {
+            uint16_t pixel = data[row * w + col];
+            if (pixel != transparent)
+            {
+                _buffer[(y + row) * _width + x + col] = pixel;
+            }
+        }
+    }
+    CountPixels(x, y, w, h);
+}
+void TFT_eSprite::pushSprite(int32_t x, int32_t y)
+{
+    if (_buffer && _tft)
+    {
+        _tft->pushImage(x, y, _width, _height, _buffer);
+    }
+}
+uint16_t TFT_eSprite::readPixel(int32_t x, int32_t y) const
+{
+    return _buffer && x >= 0 && y >= 0 && x < _width && y < _height ? _buffer[y * _width + x] : 0;
+}
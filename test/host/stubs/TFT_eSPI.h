@@ -0,0 +1,166 @@
+#pragma once
+// Host stand-in for TFT_eSPI. Nothing is displayed: the screen counts the
+// transfers and pixels it receives, and sprites draw to their buffer so
+// composing a button costs what it does on the device.
+#include <Arduino.h>
+
+#define TFT_ESPI_VERSION "host"
+#ifndef TFT_WIDTH
+#define TFT_WIDTH 320
+#endif
+#ifndef TFT_HEIGHT
+#define TFT_HEIGHT 480
+#endif
+
+#define TFT_BLACK 0x0000
+#define TFT_NAVY 0x000F
+#define TFT_DARKGREEN 0x03E0
+#define TFT_DARKCYAN 0x03EF
+#define TFT_MAROON 0x7800
+#define TFT_PURPLE 0x780F
+#define TFT_OLIVE 0x7BE0
+#define TFT_LIGHTGREY 0xD69A
+#define TFT_DARKGREY 0x7BEF
+#define TFT_BLUE 0x001F
+#define TFT_GREEN 0x07E0
+#define TFT_CYAN 0x07FF
+#define TFT_RED 0xF800
+#define TFT_MAGENTA 0xF81F
+#define TFT_YELLOW 0xFFE0
+#define TFT_WHITE 0xFFFF
+#define TFT_ORANGE 0xFDA0
+#define TFT_GREENYELLOW 0xB7E0
+#define TFT_PINK 0xFE19
+#define TFT_TRANSPARENT 0x0120
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+typedef struct
+{
+    uint16_t bitmapOffset;
+    uint8_t width;
+    uint8_t height;
+    uint8_t xAdvance;
+    int8_t xOffset;
+    int8_t yOffset;
+} GFXglyph;
+typedef struct
+{
+    uint8_t *bitmap;
+    GFXglyph *glyph;
+    uint16_t first;
+    uint16_t last;
+    uint8_t yAdvance;
+} GFXfont;
+// Only the line height of the free fonts is known, glyphs are not drawn
+extern const GFXfont FreeSans9pt7b;
+extern const GFXfont FreeSans12pt7b;
+extern const GFXfont FreeSansBold9pt7b;
+extern const GFXfont FreeSansBold12pt7b;
+extern const GFXfont TomThumb;
+
+typedef struct
+{
+    // pushImage and pushSprite calls, and the bytes they sent
+    uint32_t PushCalls;
+    uint64_t PushBytes;
+    // pixels changed by any drawing call
+    uint64_t Pixels;
+} TFT_HostStats_t;
+
+class TFT_eSPI : public Print
+{
+public:
+    TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
+    void init(uint8_t tc = 0);
+    void setRotation(uint8_t r);
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+    void setSwapBytes(bool swap) { _swapBytes = swap; }
+    bool getSwapBytes() const { return _swapBytes; }
+    virtual void fillScreen(uint32_t color);
+    virtual void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    virtual void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color);
+    void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color);
+    virtual void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data);
+    virtual void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, uint16_t transparent);
+    void setTextColor(uint16_t color) { setTextColor(color, color); }
+    void setTextColor(uint16_t color, uint16_t background);
+    void setTextSize(uint8_t size) { _textSize = size > 0 ? size : 1; }
+    void setTextFont(uint8_t font);
+    void setFreeFont(const GFXfont *font) { _font = font; }
+    void setTextDatum(uint8_t datum) { _textDatum = datum; }
+    uint8_t getTextDatum() const { return _textDatum; }
+    void setTextPadding(uint16_t padding) { _textPadding = padding; }
+    uint16_t getTextPadding() const { return _textPadding; }
+    int16_t textWidth(const char *string, uint8_t font = 1);
+    int16_t textWidth(const String &string, uint8_t font = 1) { return textWidth(string.c_str(), font); }
+    int16_t fontHeight();
+    int16_t drawString(const char *string, int32_t x, int32_t y);
+    int16_t drawString(const String &string, int32_t x, int32_t y) { return drawString(string.c_str(), x, y); }
+    void setCursor(int16_t x, int16_t y);
+    int16_t getCursorX() const { return _cursorX; }
+    int16_t getCursorY() const { return _cursorY; }
+    size_t write(uint8_t c) override;
+    using Print::write;
+    // The host screen is never touched
+    bool getTouch(uint16_t *x, uint16_t *y, uint16_t threshold = 600) { return false; }
+    void setTouch(uint16_t *data) {}
+    void calibrateTouch(uint16_t *data, uint32_t color_fg, uint32_t color_bg, uint8_t size) {}
+    uint16_t color565(uint8_t r, uint8_t g, uint8_t b) { return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3); }
+    uint16_t color24to16(uint32_t color888);
+    uint32_t color16to24(uint16_t color565);
+    TFT_HostStats_t Stats;
+
+protected:
+    // counts the pixels of the rectangle that fall on the screen
+    void CountPixels(int32_t x, int32_t y, int32_t w, int32_t h);
+    int16_t _width;
+    int16_t _height;
+    int16_t _initWidth;
+    int16_t _initHeight;
+    uint8_t _rotation = 0;
+    bool _swapBytes = false;
+    uint8_t _textSize = 1;
+    uint8_t _textFont = 1;
+    uint8_t _textDatum = TL_DATUM;
+    uint16_t _textPadding = 0;
+    uint16_t _textColor = TFT_WHITE;
+    uint16_t _textBackground = TFT_BLACK;
+    int16_t _cursorX = 0;
+    int16_t _cursorY = 0;
+    const GFXfont *_font = NULL;
+};
+
+class TFT_eSprite : public TFT_eSPI
+{
+public:
+    explicit TFT_eSprite(TFT_eSPI *tft);
+    ~TFT_eSprite();
+    void *createSprite(int16_t w, int16_t h, uint8_t frames = 1);
+    void deleteSprite();
+    bool created() const { return _buffer != NULL; }
+    void *setColorDepth(int8_t bits);
+    void fillSprite(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+    void fillScreen(uint32_t color) override { fillSprite(color); }
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override;
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override;
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) override;
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, uint16_t transparent) override;
+    // sends the buffer to the screen the sprite was created for
+    void pushSprite(int32_t x, int32_t y);
+    uint16_t readPixel(int32_t x, int32_t y) const;
+
+private:
+    TFT_eSPI *_tft;
+    uint16_t *_buffer = NULL;
+};
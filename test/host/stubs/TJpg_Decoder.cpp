@@ -0,0 +1,130 @@
+#include <Arduino.h>
+#include "TJpg_Decoder.h"
+#include <vector>
+#ifdef HOST_HAVE_JPEG
+#include <cstdio>
+#include <csetjmp>
+// the Arduino core already defines boolean
+#define boolean jpeg_boolean
+#include <jpeglib.h>
+#undef boolean
+#endif
+
+TJpg_Decoder TJpgDec;
+
+void TJpg_Decoder::setJpgScale(uint8_t scale)
+{
+    _scale = scale == 2 || scale == 4 || scale == 8 ? scale : 1;
+}
+JRESULT TJpg_Decoder::drawFsJpg(int32_t x, int32_t y, fs::File inFile)
+{
+    uint16_t w = 0;
+    uint16_t h = 0;
+    return Decode(inFile, true, x, y, &w, &h);
+}
+JRESULT TJpg_Decoder::getFsJpgSize(uint16_t *w, uint16_t *h, fs::File inFile)
+{
+    return Decode(inFile, false, 0, 0, w, h);
+}
+#ifdef HOST_HAVE_JPEG
+struct ErrorManager
+{
+    jpeg_error_mgr Manager;
+    jmp_buf Jump;
+};
+static void ErrorExit(j_common_ptr info)
+{
+    longjmp(((ErrorManager *)info->err)->Jump, 1);
+}
+JRESULT TJpg_Decoder::Decode(fs::File &inFile, bool draw, int32_t x, int32_t y, uint16_t *w, uint16_t *h)
+{
+    if (!inFile)
+    {
+        return JDR_INP;
+    }
+    std::vector<uint8_t> data(inFile.size());
+    size_t read = inFile.read(data.data(), data.size());
+    inFile.close();
+    if (read != data.size() || data.empty())
+    {
+        return JDR_INP;
+    }
+    jpeg_decompress_struct info;
+    ErrorManager error;
+    info.err = jpeg_std_error(&error.Manager);
+    error.Manager.error_exit = ErrorExit;
+    // decoded after the jump target, so nothing with a destructor is created below
+    std::vector<uint8_t> rows;
+    std::vector<uint16_t> block;
+    if (setjmp(error.Jump))
+    {
+        jpeg_destroy_decompress(&info);
+        return JDR_FMT1;
+    }
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, data.data(), data.size());
+    if (jpeg_read_header(&info, TRUE) != JPEG_HEADER_OK)
+    {
+        jpeg_destroy_decompress(&info);
+        return JDR_FMT1;
+    }
+    *w = info.image_width;
+    *h = info.image_height;
+    if (!draw)
+    {
+        jpeg_destroy_decompress(&info);
+        return JDR_OK;
+    }
+    info.out_color_space = JCS_RGB;
+    info.scale_num = 1;
+    info.scale_denom = _scale;
+    jpeg_start_decompress(&info);
+    // MCUs are 8 or 16 pixels wide and high, depending on the chroma sampling
+    uint16_t mcuWidth = max(8 * info.max_h_samp_factor / _scale, 1);
+    uint16_t mcuHeight = max(8 * info.max_v_samp_factor / _scale, 1);
+    uint32_t width = info.output_width;
+    rows.resize((size_t)width * 3 * mcuHeight);
+    block.resize((size_t)mcuWidth * mcuHeight);
+    JRESULT result = JDR_OK;
+    while (info.output_scanline < info.output_height && result == JDR_OK)
+    {
+        uint32_t top = info.output_scanline;
+        uint16_t count = 0;
+        while (count < mcuHeight && info.output_scanline < info.output_height)
+        {
+            JSAMPROW row = rows.data() + (size_t)count * width * 3;
+            count += jpeg_read_scanlines(&info, &row, 1);
+        }
+        for (uint32_t left = 0; left < width && result == JDR_OK; left += mcuWidth)
+        {
+            uint16_t bw = min<uint32_t>(mcuWidth, width - left);
+            for (uint16_t r = 0; r < count; r++)
+            {
+                const uint8_t *rgb = rows.data() + ((size_t)r * width + left) * 3;
+                for (uint16_t c = 0; c < bw; c++, rgb += 3)
+                {
+                    uint16_t pixel = ((rgb[0] & 0xF8) << 8) | ((rgb[1] & 0xFC) << 3) | (rgb[2] >> 3);
+                    block[r * bw + c] = _swap ? (uint16_t)((pixel >> 8) | (pixel << 8)) : pixel;
+                }
+            }
+            if (tft_output && !tft_output(x + left, y + top, bw, count, block.data()))
+            {
+                result = JDR_INTR;
+            }
+        }
+    }
+    if (result == JDR_OK)
+    {
+        jpeg_finish_decompress(&info);
+    }
+    jpeg_destroy_decompress(&info);
+    return result;
+}
+#else
+// Without libjpeg, jpg files are reported as unsupported
+JRESULT TJpg_Decoder::Decode(fs::File &inFile, bool draw, int32_t x, int32_t y, uint16_t *w, uint16_t *h)
+{
+    inFile.close();
+    return JDR_FMT3;
+}
+#endif
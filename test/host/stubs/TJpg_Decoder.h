@@ -0,0 +1,37 @@
+#pragma once
+// Host stand-in for the TJpg_Decoder library. Images are decoded with
+// libjpeg when it was found, and handed to the callback in 16x16 blocks
+// as TJpgDec does.
+#include "FS.h"
+
+typedef enum
+{
+    JDR_OK = 0,
+    JDR_INTR,
+    JDR_INP,
+    JDR_MEM1,
+    JDR_MEM2,
+    JDR_PAR,
+    JDR_FMT1,
+    JDR_FMT2,
+    JDR_FMT3
+} JRESULT;
+typedef bool (*SketchCallback)(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t *data);
+
+class TJpg_Decoder
+{
+public:
+    void setJpgScale(uint8_t scale);
+    void setCallback(SketchCallback sketchCallback) { tft_output = sketchCallback; }
+    void setSwapBytes(bool swap) { _swap = swap; }
+    JRESULT drawFsJpg(int32_t x, int32_t y, fs::File inFile);
+    JRESULT getFsJpgSize(uint16_t *w, uint16_t *h, fs::File inFile);
+
+private:
+    // decodes the file, calling the callback with the blocks when draw is true
+    JRESULT Decode(fs::File &inFile, bool draw, int32_t x, int32_t y, uint16_t *w, uint16_t *h);
+    SketchCallback tft_output = NULL;
+    uint8_t _scale = 1;
+    bool _swap = false;
+};
+extern TJpg_Decoder TJpgDec;
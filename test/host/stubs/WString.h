@@ -0,0 +1,87 @@
+#pragma once
+// Host stand-in for the Arduino String class, over std::string
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+class String
+{
+public:
+    String() {}
+    String(const char *value) : s(value ? value : "") {}
+    String(const std::string &value) : s(value) {}
+    String(char value) : s(1, value) {}
+    String(int value) : s(std::to_string(value)) {}
+    String(unsigned int value) : s(std::to_string(value)) {}
+    String(long value) : s(std::to_string(value)) {}
+    String(unsigned long value) : s(std::to_string(value)) {}
+    const char *c_str() const { return s.c_str(); }
+    unsigned int length() const { return s.length(); }
+    bool isEmpty() const { return s.empty(); }
+    char operator[](unsigned int index) const { return index < s.length() ? s[index] : 0; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+    bool operator==(const String &other) const { return s == other.s; }
+    bool operator==(const char *other) const { return s == (other ? other : ""); }
+    bool operator!=(const String &other) const { return s != other.s; }
+    bool operator!=(const char *other) const { return !(*this == other); }
+    bool operator<(const String &other) const { return s < other.s; }
+    bool equals(const String &other) const { return s == other.s; }
+    bool equalsIgnoreCase(const String &other) const { return strcasecmp(s.c_str(), other.s.c_str()) == 0; }
+    String &operator+=(const String &other)
+    {
+        s += other.s;
+        return *this;
+    }
+    String &operator+=(const char *other)
+    {
+        s += other ? other : "";
+        return *this;
+    }
+    String &operator+=(char other)
+    {
+        s += other;
+        return *this;
+    }
+    bool concat(const String &other)
+    {
+        s += other.s;
+        return true;
+    }
+    friend String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+    friend String operator+(const String &a, const char *b) { return String(a.s + (b ? b : "")); }
+    friend String operator+(const char *a, const String &b) { return String((a ? a : "") + b.s); }
+    int indexOf(char c, unsigned int from = 0) const { return Position(s.find(c, from)); }
+    int indexOf(const String &value, unsigned int from = 0) const { return Position(s.find(value.s, from)); }
+    int lastIndexOf(char c) const { return Position(s.rfind(c)); }
+    int lastIndexOf(const String &value) const { return Position(s.rfind(value.s)); }
+    String substring(unsigned int from) const { return from < s.length() ? String(s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const { return from < to && from < s.length() ? String(s.substr(from, to - from)) : String(); }
+    bool startsWith(const String &prefix) const { return s.compare(0, prefix.s.length(), prefix.s) == 0; }
+    bool endsWith(const String &suffix) const { return s.length() >= suffix.s.length() && s.compare(s.length() - suffix.s.length(), suffix.s.length(), suffix.s) == 0; }
+    void trim()
+    {
+        size_t start = s.find_first_not_of(" \t\r\n");
+        size_t end = s.find_last_not_of(" \t\r\n");
+        s = start == std::string::npos ? std::string() : s.substr(start, end - start + 1);
+    }
+    void toLowerCase()
+    {
+        for (auto &c : s)
+        {
+            c = tolower(c);
+        }
+    }
+    void toUpperCase()
+    {
+        for (auto &c : s)
+        {
+            c = toupper(c);
+        }
+    }
+    long toInt() const { return atol(s.c_str()); }
+    float toFloat() const { return atof(s.c_str()); }
+
+private:
+    static int Position(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+    std::string s;
+};
@@ -0,0 +1,14 @@
+#pragma once
+#include <Arduino.h>
+class TwoWire
+{
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) { return true; }
+    void beginTransmission(uint8_t address) {}
+    uint8_t endTransmission(bool sendStop = true) { return 0; }
+    uint8_t requestFrom(uint8_t address, uint8_t size) { return 0; }
+    size_t write(uint8_t data) { return 1; }
+    int available() { return 0; }
+    int read() { return -1; }
+};
+extern TwoWire Wire;
@@ -0,0 +1,780 @@
+#include "cJSON.h"
+#include <ctype.h>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void *(*cjson_malloc)(size_t sz) = malloc;
+static void (*cjson_free)(void *ptr) = free;
+static const char *error_ptr = NULL;
+
+void cJSON_InitHooks(cJSON_Hooks *hooks)
+{
+    cjson_malloc = hooks && hooks->malloc_fn ? hooks->malloc_fn : malloc;
+    cjson_free = hooks && hooks->free_fn ? hooks->free_fn : free;
+}
+static cJSON *new_item(int type)
+{
+    cJSON *item = (cJSON *)cjson_malloc(sizeof(cJSON));
+    if (item)
+    {
+        memset(item, 0, sizeof(cJSON));
+        item->type = type;
+    }
+    return item;
+}
+static char *duplicate(const char *string, size_t length)
+{
+    char *copy = (char *)cjson_malloc(length + 1);
+    if (copy)
+    {
+        memcpy(copy, string, length);
+        copy[length] = 0;
+    }
+    return copy;
+}
+void cJSON_free(void *object)
+{
+    cjson_free(object);
+}
+void cJSON_Delete(cJSON *item)
+{
+    while (item)
+    {
+        cJSON *next = item->next;
+        if (!(item->type & cJSON_IsReference) && item->child)
+        {
+            cJSON_Delete(item->child);
+        }
+        if (!(item->type & cJSON_IsReference) && item->valuestring)
+        {
+            cjson_free(item->valuestring);
+        }
+        if (!(item->type & cJSON_StringIsConst) && item->string)
+        {
+            cjson_free(item->string);
+        }
+        cjson_free(item);
+        item = next;
+    }
+}
+
+/* Parsing */
+typedef struct
+{
+    const char *content;
+    size_t length;
+    size_t offset;
+} parse_buffer;
+#define CAN_READ(b, n) ((b)->offset + (n) <= (b)->length)
+#define CURRENT(b) ((b)->content + (b)->offset)
+static int parse_value(cJSON *item, parse_buffer *buffer);
+static void skip_whitespace(parse_buffer *buffer)
+{
+    while (CAN_READ(buffer, 1) && (unsigned char)*CURRENT(buffer) <= 32)
+    {
+        buffer->offset++;
+    }
+}
+static int parse_hex4(const char *input, unsigned *value)
+{
+    *value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        char c = input[i];
+        *value <<= 4;
+        if (c >= '0' && c <= '9')
+            *value |= c - '0';
+        else if (c >= 'a' && c <= 'f')
+            *value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            *value |= c - 'A' + 10;
+        else
+            return 0;
+    }
+    return 1;
+}
+static char *parse_string_value(parse_buffer *buffer)
+{
+    size_t start = buffer->offset + 1;
+    size_t end = start;
+    while (end < buffer->length && buffer->content[end] != '"')
+    {
+        end += buffer->content[end] == '\\' ? 2 : 1;
+    }
+    if (end >= buffer->length)
+    {
+        return NULL;
+    }
+    char *output = (char *)cjson_malloc(end - start + 1);
+    char *out = output;
+    if (!output)
+    {
+        return NULL;
+    }
+    for (size_t i = start; i < end; i++)
+    {
+        char c = buffer->content[i];
+        if (c != '\\')
+        {
+            *out++ = c;
+            continue;
+        }
+        c = buffer->content[++i];
+        switch (c)
+        {
+        case 'b':
+            *out++ = '\b';
+            break;
+        case 'f':
+            *out++ = '\f';
+            break;
+        case 'n':
+            *out++ = '\n';
+            break;
+        case 'r':
+            *out++ = '\r';
+            break;
+        case 't':
+            *out++ = '\t';
+            break;
+        case 'u':
+        {
+            unsigned code = 0;
+            if (i + 4 >= end + 1 || !parse_hex4(buffer->content + i + 1, &code))
+            {
+                cjson_free(output);
+                return NULL;
+            }
+            i += 4;
+            /* code points are written as UTF-8, surrogate pairs are not combined */
+            if (code < 0x80)
+            {
+                *out++ = (char)code;
+            }
+            else if (code < 0x800)
+            {
+                *out++ = (char)(0xC0 | (code >> 6));
+                *out++ = (char)(0x80 | (code & 0x3F));
+            }
+            else
+            {
+                *out++ = (char)(0xE0 | (code >> 12));
+                *out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+                *out++ = (char)(0x80 | (code & 0x3F));
+            }
+            break;
+        }
+        default:
+            *out++ = c;
+            break;
+        }
+    }
+    *out = 0;
+    buffer->offset = end + 1;
+    return output;
+}
+static int parse_number(cJSON *item, parse_buffer *buffer)
+{
+    char *end = NULL;
+    double number = strtod(CURRENT(buffer), &end);
+    if (end == CURRENT(buffer))
+    {
+        return 0;
+    }
+    item->valuedouble = number;
+    item->valueint = number >= INT_MAX ? INT_MAX : number <= (double)INT_MIN ? INT_MIN : (int)number;
+    item->type = cJSON_Number;
+    buffer->offset += end - CURRENT(buffer);
+    return 1;
+}
+static int parse_array(cJSON *item, parse_buffer *buffer)
+{
+    cJSON *tail = NULL;
+    item->type = cJSON_Array;
+    buffer->offset++;
+    skip_whitespace(buffer);
+    if (CAN_READ(buffer, 1) && *CURRENT(buffer) == ']')
+    {
+        buffer->offset++;
+        return 1;
+    }
+    for (;;)
+    {
+        cJSON *child = new_item(cJSON_Invalid);
+        if (!child)
+        {
+            return 0;
+        }
+        if (tail)
+        {
+            tail->next = child;
+            child->prev = tail;
+        }
+        else
+        {
+            item->child = child;
+        }
+        tail = child;
+        item->child->prev = tail;
+        skip_whitespace(buffer);
+        if (!parse_value(child, buffer))
+        {
+            return 0;
+        }
+        skip_whitespace(buffer);
+        if (!CAN_READ(buffer, 1))
+        {
+            return 0;
+        }
+        if (*CURRENT(buffer) == ']')
+        {
+            buffer->offset++;
+            return 1;
+        }
+        if (*CURRENT(buffer) != ',')
+        {
+            return 0;
+        }
+        buffer->offset++;
+    }
+}
+static int parse_object(cJSON *item, parse_buffer *buffer)
+{
+    cJSON *tail = NULL;
+    item->type = cJSON_Object;
+    buffer->offset++;
+    skip_whitespace(buffer);
+    if (CAN_READ(buffer, 1) && *CURRENT(buffer) == '}')
+    {
+        buffer->offset++;
+        return 1;
+    }
+    for (;;)
+    {
+        cJSON *child = new_item(cJSON_Invalid);
+        if (!child)
+        {
+            return 0;
+        }
+        if (tail)
+        {
+            tail->next = child;
+            child->prev = tail;
+        }
+        else
+        {
+            item->child = child;
+        }
+        tail = child;
+        item->child->prev = tail;
+        skip_whitespace(buffer);
+        if (!CAN_READ(buffer, 1) || *CURRENT(buffer) != '"' || !(child->string = parse_string_value(buffer)))
+        {
+            return 0;
+        }
+        skip_whitespace(buffer);
+        if (!CAN_READ(buffer, 1) || *CURRENT(buffer) != ':')
+        {
+            return 0;
+        }
+        buffer->offset++;
+        skip_whitespace(buffer);
+        if (!parse_value(child, buffer))
+        {
+            return 0;
+        }
+        skip_whitespace(buffer);
+        if (!CAN_READ(buffer, 1))
+        {
+            return 0;
+        }
+        if (*CURRENT(buffer) == '}')
+        {
+            buffer->offset++;
+            return 1;
+        }
+        if (*CURRENT(buffer) != ',')
+        {
+            return 0;
+        }
+        buffer->offset++;
+    }
+}
+static int parse_value(cJSON *item, parse_buffer *buffer)
+{
+    if (!CAN_READ(buffer, 1))
+    {
+        return 0;
+    }
+    if (CAN_READ(buffer, 4) && strncmp(CURRENT(buffer), "null", 4) == 0)
+    {
+        item->type = cJSON_NULL;
+        buffer->offset += 4;
+        return 1;
+    }
+    if (CAN_READ(buffer, 5) && strncmp(CURRENT(buffer), "false", 5) == 0)
+    {
+        item->type = cJSON_False;
+        buffer->offset += 5;
+        return 1;
+    }
+    if (CAN_READ(buffer, 4) && strncmp(CURRENT(buffer), "true", 4) == 0)
+    {
+        item->type = cJSON_True;
+        item->valueint = 1;
+        buffer->offset += 4;
+        return 1;
+    }
+    switch (*CURRENT(buffer))
+    {
+    case '"':
+        item->type = cJSON_String;
+        return (item->valuestring = parse_string_value(buffer)) != NULL;
+    case '[':
+        return parse_array(item, buffer);
+    case '{':
+        return parse_object(item, buffer);
+    default:
+        if (*CURRENT(buffer) == '-' || isdigit((unsigned char)*CURRENT(buffer)))
+        {
+            return parse_number(item, buffer);
+        }
+        return 0;
+    }
+}
+cJSON *cJSON_ParseWithLength(const char *value, size_t buffer_length)
+{
+    parse_buffer buffer = {value, buffer_length, 0};
+    cJSON *item = NULL;
+    error_ptr = NULL;
+    if (!value)
+    {
+        return NULL;
+    }
+    item = new_item(cJSON_Invalid);
+    if (!item)
+    {
+        return NULL;
+    }
+    skip_whitespace(&buffer);
+    if (!parse_value(item, &buffer))
+    {
+        error_ptr = value + (buffer.offset < buffer_length ? buffer.offset : buffer_length);
+        cJSON_Delete(item);
+        return NULL;
+    }
+    return item;
+}
+cJSON *cJSON_Parse(const char *value)
+{
+    return value ? cJSON_ParseWithLength(value, strlen(value)) : NULL;
+}
+const char *cJSON_GetErrorPtr(void)
+{
+    return error_ptr;
+}
+
+/* Printing */
+typedef struct
+{
+    char *buffer;
+    size_t length;
+    size_t offset;
+    int failed;
+} print_buffer;
+static void append(print_buffer *p, const char *data, size_t length)
+{
+    if (p->failed)
+    {
+        return;
+    }
+    if (p->offset + length + 1 > p->length)
+    {
+        size_t newLength = (p->offset + length + 1) * 2;
+        char *newBuffer = (char *)cjson_malloc(newLength);
+        if (!newBuffer)
+        {
+            p->failed = 1;
+            return;
+        }
+        if (p->buffer)
+        {
+            memcpy(newBuffer, p->buffer, p->offset);
+            cjson_free(p->buffer);
+        }
+        p->buffer = newBuffer;
+        p->length = newLength;
+    }
+    memcpy(p->buffer + p->offset, data, length);
+    p->offset += length;
+    p->buffer[p->offset] = 0;
+}
+static void append_string(print_buffer *p, const char *s)
+{
+    append(p, "\"", 1);
+    for (; s && *s; s++)
+    {
+        char escaped[8];
+        switch (*s)
+        {
+        case '"':
+            append(p, "\\\"", 2);
+            break;
+        case '\\':
+            append(p, "\\\\", 2);
+            break;
+        case '\b':
+            append(p, "\\b", 2);
+            break;
+        case '\f':
+            append(p, "\\f", 2);
+            break;
+        case '\n':
+            append(p, "\\n", 2);
+            break;
+        case '\r':
+            append(p, "\\r", 2);
+            break;
+        case '\t':
+            append(p, "\\t", 2);
+            break;
+        default:
+            if ((unsigned char)*s < 32)
+            {
+                snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)*s);
+                append(p, escaped, 6);
+            }
+            else
+            {
+                append(p, s, 1);
+            }
+            break;
+        }
+    }
+    append(p, "\"", 1);
+}
+static void append_indent(print_buffer *p, int depth)
+{
+    for (int i = 0; i < depth; i++)
+    {
+        append(p, "\t", 1);
+    }
+}
+static void print_value(const cJSON *item, print_buffer *p, int depth, int format)
+{
+    char number[32];
+    const cJSON *child = NULL;
+    switch (item->type & 0xFF)
+    {
+    case cJSON_NULL:
+        append(p, "null", 4);
+        break;
+    case cJSON_False:
+        append(p, "false", 5);
+        break;
+    case cJSON_True:
+        append(p, "true", 4);
+        break;
+    case cJSON_Number:
+        if (isnan(item->valuedouble) || isinf(item->valuedouble))
+        {
+            snprintf(number, sizeof(number), "null");
+        }
+        else if (item->valuedouble == (double)item->valueint)
+        {
+            snprintf(number, sizeof(number), "%d", item->valueint);
+        }
+        else
+        {
+            double test = 0;
+            snprintf(number, sizeof(number), "%1.15g", item->valuedouble);
+            if (sscanf(number, "%lg", &test) != 1 || test != item->valuedouble)
+            {
+                snprintf(number, sizeof(number), "%1.17g", item->valuedouble);
+            }
+        }
+        append(p, number, strlen(number));
+        break;
+    case cJSON_String:
+        append_string(p, item->valuestring);
+        break;
+    case cJSON_Raw:
+        append(p, item->valuestring, item->valuestring ? strlen(item->valuestring) : 0);
+        break;
+    case cJSON_Array:
+        append(p, "[", 1);
+        for (child = item->child; child; child = child->next)
+        {
+            print_value(child, p, depth + 1, format);
+            if (child->next)
+            {
+                append(p, format ? ", " : ",", format ? 2 : 1);
+            }
+        }
+        append(p, "]", 1);
+        break;
+    case cJSON_Object:
+        append(p, format ? "{\n" : "{", format ? 2 : 1);
+        for (child = item->child; child; child = child->next)
+        {
+            if (format)
+            {
+                append_indent(p, depth + 1);
+            }
+            append_string(p, child->string);
+            append(p, format ? ":\t" : ":", format ? 2 : 1);
+            print_value(child, p, depth + 1, format);
+            if (child->next)
+            {
+                append(p, ",", 1);
+            }
+            if (format)
+            {
+                append(p, "\n", 1);
+            }
+        }
+        if (format)
+        {
+            append_indent(p, depth);
+        }
+        append(p, "}", 1);
+        break;
+    default:
+        p->failed = 1;
+        break;
+    }
+}
+static char *print(const cJSON *item, int format)
+{
+    print_buffer p = {NULL, 0, 0, 0};
+    if (!item)
+    {
+        return NULL;
+    }
+    print_value(item, &p, 0, format);
+    if (p.failed)
+    {
+        if (p.buffer)
+        {
+            cjson_free(p.buffer);
+        }
+        return NULL;
+    }
+    return p.buffer;
+}
+char *cJSON_Print(const cJSON *item)
+{
+    return print(item, 1);
+}
+char *cJSON_PrintUnformatted(const cJSON *item)
+{
+    return print(item, 0);
+}
+
+/* Access */
+int cJSON_GetArraySize(const cJSON *array)
+{
+    int size = 0;
+    for (const cJSON *child = array ? array->child : NULL; child; child = child->next)
+    {
+        size++;
+    }
+    return size;
+}
+cJSON *cJSON_GetArrayItem(const cJSON *array, int index)
+{
+    cJSON *child = array ? array->child : NULL;
+    while (child && index-- > 0)
+    {
+        child = child->next;
+    }
+    return child;
+}
+cJSON *cJSON_GetObjectItem(const cJSON *object, const char *string)
+{
+    for (cJSON *child = object && string ? object->child : NULL; child; child = child->next)
+    {
+        if (child->string && strcasecmp(child->string, string) == 0)
+        {
+            return child;
+        }
+    }
+    return NULL;
+}
+cJSON *cJSON_GetObjectItemCaseSensitive(const cJSON *object, const char *string)
+{
+    for (cJSON *child = object && string ? object->child : NULL; child; child = child->next)
+    {
+        if (child->string && strcmp(child->string, string) == 0)
+        {
+            return child;
+        }
+    }
+    return NULL;
+}
+char *cJSON_GetStringValue(const cJSON *item)
+{
+    return cJSON_IsString(item) ? item->valuestring : NULL;
+}
+double cJSON_GetNumberValue(const cJSON *item)
+{
+    return cJSON_IsNumber(item) ? item->valuedouble : NAN;
+}
+cJSON_bool cJSON_IsInvalid(const cJSON *item) { return item && (item->type & 0xFF) == cJSON_Invalid; }
+cJSON_bool cJSON_IsFalse(const cJSON *item) { return item && (item->type & 0xFF) == cJSON_False; }
+cJSON_bool cJSON_IsTrue(const cJSON *item) { return item && (item->type & 0xFF) == cJSON_True; }
+cJSON_bool cJSON_IsBool(const cJSON *item) { return item && (item->type & (cJSON_True | cJSON_False)) != 0; }
+cJSON_bool cJSON_IsNull(const cJSON *item) { return item && (item->type & 0xFF) == cJSON_NULL; }
+cJSON_bool cJSON_IsNumber(const cJSON *item) { return item && (item->type & 0xFF) == cJSON_Number; }
+cJSON_bool cJSON_IsString(const cJSON *item) { return item && (item->type & 0xFF) == cJSON_String; }
+cJSON_bool cJSON_IsArray(const cJSON *item) { return item && (item->type & 0xFF) == cJSON_Array; }
+cJSON_bool cJSON_IsObject(const cJSON *item) { return item && (item->type & 0xFF) == cJSON_Object; }
+
+/* Creation */
+cJSON *cJSON_CreateNull(void) { return new_item(cJSON_NULL); }
+cJSON *cJSON_CreateTrue(void) { return new_item(cJSON_True); }
+cJSON *cJSON_CreateFalse(void) { return new_item(cJSON_False); }
+cJSON *cJSON_CreateBool(cJSON_bool boolean) { return new_item(boolean ? cJSON_True : cJSON_False); }
+cJSON *cJSON_CreateNumber(double num)
+{
+    cJSON *item = new_item(cJSON_Number);
+    if (item)
+    {
+        item->valuedouble = num;
+        item->valueint = num >= INT_MAX ? INT_MAX : num <= (double)INT_MIN ? INT_MIN : (int)num;
+    }
+    return item;
+}
+cJSON *cJSON_CreateString(const char *string)
+{
+    cJSON *item = new_item(cJSON_String);
+    if (item && !(item->valuestring = duplicate(string ? string : "", string ? strlen(string) : 0)))
+    {
+        cJSON_Delete(item);
+        return NULL;
+    }
+    return item;
+}
+cJSON *cJSON_CreateArray(void) { return new_item(cJSON_Array); }
+cJSON *cJSON_CreateObject(void) { return new_item(cJSON_Object); }
+cJSON_bool cJSON_AddItemToArray(cJSON *array, cJSON *item)
+{
+    if (!array || !item || array == item)
+    {
+        return 0;
+    }
+    if (!array->child)
+    {
+        array->child = item;
+        item->prev = item;
+        item->next = NULL;
+    }
+    else
+    {
+        cJSON *tail = array->child->prev;
+        tail->next = item;
+        item->prev = tail;
+        array->child->prev = item;
+    }
+    return 1;
+}
+cJSON_bool cJSON_AddItemToObject(cJSON *object, const char *string, cJSON *item)
+{
+    char *key = NULL;
+    if (!object || !string || !item || !(key = duplicate(string, strlen(string))))
+    {
+        return 0;
+    }
+    if (item->string && !(item->type & cJSON_StringIsConst))
+    {
+        cjson_free(item->string);
+    }
+    item->string = key;
+    item->type &= ~cJSON_StringIsConst;
+    return cJSON_AddItemToArray(object, item);
+}
+static cJSON *add_to_object(cJSON *object, const char *name, cJSON *item)
+{
+    if (cJSON_AddItemToObject(object, name, item))
+    {
+        return item;
+    }
+    cJSON_Delete(item);
+    return NULL;
+}
+cJSON *cJSON_AddNullToObject(cJSON *const object, const char *const name) { return add_to_object(object, name, cJSON_CreateNull()); }
+cJSON *cJSON_AddTrueToObject(cJSON *const object, const char *const name) { return add_to_object(object, name, cJSON_CreateTrue()); }
+cJSON *cJSON_AddFalseToObject(cJSON *const object, const char *const name) { return add_to_object(object, name, cJSON_CreateFalse()); }
+cJSON *cJSON_AddBoolToObject(cJSON *const object, const char *const name, const cJSON_bool boolean) { return add_to_object(object, name, cJSON_CreateBool(boolean)); }
+cJSON *cJSON_AddNumberToObject(cJSON *const object, const char *const name, const double number) { return add_to_object(object, name, cJSON_CreateNumber(number)); }
+cJSON *cJSON_AddStringToObject(cJSON *const object, const char *const name, const char *const string) { return add_to_object(object, name, cJSON_CreateString(string)); }
+cJSON *cJSON_AddObjectToObject(cJSON *const object, const char *const name) { return add_to_object(object, name, cJSON_CreateObject()); }
+cJSON *cJSON_AddArrayToObject(cJSON *const object, const char *const name) { return add_to_object(object, name, cJSON_CreateArray()); }
+cJSON *cJSON_DetachItemFromObject(cJSON *object, const char *string)
+{
+    cJSON *item = cJSON_GetObjectItem(object, string);
+    if (!item)
+    {
+        return NULL;
+    }
+    if (item == object->child)
+    {
+        object->child = item->next;
+        if (object->child)
+        {
+            object->child->prev = item->prev;
+        }
+    }
+    else
+    {
+        item->prev->next = item->next;
+        if (item->next)
+        {
+            item->next->prev = item->prev;
+        }
+        else
+        {
+            object->child->prev = item->prev;
+        }
+    }
+    item->next = NULL;
+    item->prev = NULL;
+    return item;
+}
+void cJSON_DeleteItemFromObject(cJSON *object, const char *string)
+{
+    cJSON_Delete(cJSON_DetachItemFromObject(object, string));
+}
+cJSON *cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
+{
+    cJSON *copy = NULL;
+    if (!item)
+    {
+        return NULL;
+    }
+    copy = new_item(item->type & ~cJSON_IsReference);
+    if (!copy)
+    {
+        return NULL;
+    }
+    copy->valueint = item->valueint;
+    copy->valuedouble = item->valuedouble;
+    if (item->valuestring)
+    {
+        copy->valuestring = duplicate(item->valuestring, strlen(item->valuestring));
+    }
+    if (item->string)
+    {
+        copy->string = duplicate(item->string, strlen(item->string));
+        copy->type &= ~cJSON_StringIsConst;
+    }
+    for (const cJSON *child = recurse ? item->child : NULL; child; child = child->next)
+    {
+        cJSON_AddItemToArray(copy, cJSON_Duplicate(child, 1));
+    }
+    return copy;
+}
@@ -0,0 +1,89 @@
+#pragma once
+// Host stand-in for the cJSON library of the ESP-IDF, with the subset of
+// its API used by the sketch. Documents are parsed and printed the same way.
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include <stddef.h>
+
+#define cJSON_Invalid (0)
+#define cJSON_False (1 << 0)
+#define cJSON_True (1 << 1)
+#define cJSON_NULL (1 << 2)
+#define cJSON_Number (1 << 3)
+#define cJSON_String (1 << 4)
+#define cJSON_Array (1 << 5)
+#define cJSON_Object (1 << 6)
+#define cJSON_Raw (1 << 7)
+#define cJSON_IsReference 256
+#define cJSON_StringIsConst 512
+
+    typedef struct cJSON
+    {
+        struct cJSON *next;
+        struct cJSON *prev;
+        struct cJSON *child;
+        int type;
+        char *valuestring;
+        int valueint;
+        double valuedouble;
+        char *string;
+    } cJSON;
+    typedef struct cJSON_Hooks
+    {
+        void *(*malloc_fn)(size_t sz);
+        void (*free_fn)(void *ptr);
+    } cJSON_Hooks;
+    typedef int cJSON_bool;
+
+    void cJSON_InitHooks(cJSON_Hooks *hooks);
+    cJSON *cJSON_Parse(const char *value);
+    cJSON *cJSON_ParseWithLength(const char *value, size_t buffer_length);
+    const char *cJSON_GetErrorPtr(void);
+    char *cJSON_Print(const cJSON *item);
+    char *cJSON_PrintUnformatted(const cJSON *item);
+    void cJSON_Delete(cJSON *item);
+    void cJSON_free(void *object);
+    int cJSON_GetArraySize(const cJSON *array);
+    cJSON *cJSON_GetArrayItem(const cJSON *array, int index);
+    cJSON *cJSON_GetObjectItem(const cJSON *object, const char *string);
+    cJSON *cJSON_GetObjectItemCaseSensitive(const cJSON *object, const char *string);
+    char *cJSON_GetStringValue(const cJSON *item);
+    double cJSON_GetNumberValue(const cJSON *item);
+    cJSON_bool cJSON_IsInvalid(const cJSON *item);
+    cJSON_bool cJSON_IsFalse(const cJSON *item);
+    cJSON_bool cJSON_IsTrue(const cJSON *item);
+    cJSON_bool cJSON_IsBool(const cJSON *item);
+    cJSON_bool cJSON_IsNull(const cJSON *item);
+    cJSON_bool cJSON_IsNumber(const cJSON *item);
+    cJSON_bool cJSON_IsString(const cJSON *item);
+    cJSON_bool cJSON_IsArray(const cJSON *item);
+    cJSON_bool cJSON_IsObject(const cJSON *item);
+    cJSON *cJSON_CreateNull(void);
+    cJSON *cJSON_CreateTrue(void);
+    cJSON *cJSON_CreateFalse(void);
+    cJSON *cJSON_CreateBool(cJSON_bool boolean);
+    cJSON *cJSON_CreateNumber(double num);
+    cJSON *cJSON_CreateString(const char *string);
+    cJSON *cJSON_CreateArray(void);
+    cJSON *cJSON_CreateObject(void);
+    cJSON_bool cJSON_AddItemToArray(cJSON *array, cJSON *item);
+    cJSON_bool cJSON_AddItemToObject(cJSON *object, const char *string, cJSON *item);
+    cJSON *cJSON_AddNullToObject(cJSON *const object, const char *const name);
+    cJSON *cJSON_AddTrueToObject(cJSON *const object, const char *const name);
+    cJSON *cJSON_AddFalseToObject(cJSON *const object, const char *const name);
+    cJSON *cJSON_AddBoolToObject(cJSON *const object, const char *const name, const cJSON_bool boolean);
+    cJSON *cJSON_AddNumberToObject(cJSON *const object, const char *const name, const double number);
+    cJSON *cJSON_AddStringToObject(cJSON *const object, const char *const name, const char *const string);
+    cJSON *cJSON_AddObjectToObject(cJSON *const object, const char *const name);
+    cJSON *cJSON_AddArrayToObject(cJSON *const object, const char *const name);
+    cJSON *cJSON_DetachItemFromObject(cJSON *object, const char *string);
+    void cJSON_DeleteItemFromObject(cJSON *object, const char *string);
+    cJSON *cJSON_Duplicate(const cJSON *item, cJSON_bool recurse);
+
+#define cJSON_ArrayForEach(element, array) for (element = (array != NULL) ? (array)->child : NULL; element != NULL; element = element->next)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,12 @@
+#pragma once
+#include "esp_err.h"
+typedef enum
+{
+    ESP_BT_MODE_IDLE = 0,
+    ESP_BT_MODE_BLE,
+    ESP_BT_MODE_CLASSIC_BT,
+    ESP_BT_MODE_BTDM,
+} esp_bt_mode_t;
+esp_err_t esp_bt_controller_disable();
+esp_err_t esp_bt_controller_deinit();
+esp_err_t esp_bt_controller_mem_release(esp_bt_mode_t mode);
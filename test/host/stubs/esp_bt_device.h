@@ -0,0 +1,3 @@
+#pragma once
+#include <cstdint>
+const uint8_t *esp_bt_dev_get_address();
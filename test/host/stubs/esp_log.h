@@ -0,0 +1,14 @@
+#pragma once
+// Log lines are printed when HostSetVerbose is on
+void HostLog(char level, const char *tag, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+// As in the Arduino core, the tag is replaced by the function name
+#define ESP_LOGE(tag, fmt, ...) HostLog('E', __FUNCTION__, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) HostLog('W', __FUNCTION__, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) HostLog('I', __FUNCTION__, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) HostLog('D', __FUNCTION__, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) HostLog('V', __FUNCTION__, fmt, ##__VA_ARGS__)
+#define log_e(fmt, ...) HostLog('E', __FUNCTION__, fmt, ##__VA_ARGS__)
+#define log_w(fmt, ...) HostLog('W', __FUNCTION__, fmt, ##__VA_ARGS__)
+#define log_i(fmt, ...) HostLog('I', __FUNCTION__, fmt, ##__VA_ARGS__)
+#define log_d(fmt, ...) HostLog('D', __FUNCTION__, fmt, ##__VA_ARGS__)
+#define log_v(fmt, ...) HostLog('V', __FUNCTION__, fmt, ##__VA_ARGS__)
@@ -0,0 +1,7 @@
+#pragma once
+#include "esp_err.h"
+typedef void (*shutdown_handler_t)(void);
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handle);
+void esp_restart();
+uint32_t esp_random();
+const char *esp_get_idf_version();
@@ -0,0 +1,35 @@
+#pragma once
+// Host stand-in for the FreeRTOS kernel of the ESP32 Arduino core. Tasks are
+// threads, semaphores are built on std::mutex and a tick is a millisecond.
+#include <cstdint>
+#include <cstddef>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+#define portBASE_TYPE int
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+#define portTICK_PERIOD_MS ((TickType_t)1)
+#define configTICK_RATE_HZ 1000
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define pdTRUE ((BaseType_t)1)
+#define pdFALSE ((BaseType_t)0)
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define tskIDLE_PRIORITY ((UBaseType_t)0)
+#define portYIELD_FROM_ISR()
+#define xPortGetCoreID() 1
+
+// Critical sections of all the muxes share one lock, as interrupts are masked on the device
+typedef struct
+{
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+void HostEnterCritical(portMUX_TYPE *mux);
+void HostExitCritical(portMUX_TYPE *mux);
+#define portENTER_CRITICAL(mux) HostEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) HostExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) HostEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) HostExitCritical(mux)
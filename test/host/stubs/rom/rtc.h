@@ -0,0 +1,10 @@
+#pragma once
+typedef enum
+{
+    NO_MEAN = 0,
+    POWERON_RESET = 1,
+    SW_RESET = 3,
+    DEEPSLEEP_RESET = 5,
+    SW_CPU_RESET = 12,
+} RESET_REASON;
+RESET_REASON rtc_get_reset_reason(int cpu_no);
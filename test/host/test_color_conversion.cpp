@@ -0,0 +1,107 @@
+// Checks the row conversion of 24 and 32 bits pixels to RGB565 against the
+// per pixel conversion, for every alignment and row length it handles
+// differently, then times both on a screen worth of pixels.
+#include "HostTest.h"
+#include "globals.hpp"
+#include <random>
+#include <vector>
+
+using namespace FreeTouchDeck;
+
+static uint16_t Reference(const uint8_t *pixel, uint8_t depth, bool swapBytes)
+{
+    uint16_t color = convertRGB888ToRGB565((uint8_t *)pixel, depth);
+    return swapBytes ? (color >> 8) | (color << 8) : color;
+}
+
+static void CheckEquivalence(const std::vector<uint8_t> &source)
+{
+    // the row is converted 4 pixels at a time, so lengths around multiples of 4 matter
+    std::vector<size_t> counts;
+    for (size_t count = 0; count <= 17; count++)
+    {
+        counts.push_back(count);
+    }
+    counts.push_back(480);
+    counts.push_back(481);
+    // uint32_t backing keeps the 0 offsets word aligned
+    std::vector<uint32_t> output(600);
+    for (uint8_t depth = 24; depth <= 32; depth += 8)
+    {
+        for (bool swapBytes : {false, true})
+        {
+            for (size_t srcOffset = 0; srcOffset < 4; srcOffset++)
+            {
+                for (size_t dstOffset = 0; dstOffset < 2; dstOffset++)
+                {
+                    for (size_t count : counts)
+                    {
+                        const uint8_t *src = source.data() + srcOffset;
+                        uint16_t *dst = (uint16_t *)output.data() + dstOffset;
+                        std::fill(output.begin(), output.end(), 0xA5A5A5A5);
+                        convertRGB888RowToRGB565(src, dst, count, depth, swapBytes);
+                        size_t mismatches = 0;
+                        for (size_t i = 0; i < count; i++)
+                        {
+                            mismatches += dst[i] != Reference(src + i * (depth / 8), depth, swapBytes);
+                        }
+                        // nothing is written past the row
+                        mismatches += dst[count] != 0xA5A5;
+                        if (mismatches > 0)
+                        {
+                            fprintf(stderr, "%ubpp swap %d src+%zu dst+%zu count %zu: %zu mismatches\n", depth, swapBytes, srcOffset, dstOffset, count, mismatches);
+                        }
+                        CHECK(mismatches == 0);
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void Benchmark(const std::vector<uint8_t> &source)
+{
+    const size_t count = 320 * 480;
+    const int rounds = 20;
+    std::vector<uint32_t> output(count / 2 + 1);
+    uint16_t *dst = (uint16_t *)output.data();
+    printf("\n%-22s %12s %12s %8s\n", "conversion (us)", "per pixel", "row", "speedup");
+    for (uint8_t depth = 24; depth <= 32; depth += 8)
+    {
+        for (size_t offset = 0; offset < 2; offset++)
+        {
+            const uint8_t *src = source.data() + offset;
+            double perPixel = HostTest::BestOf(rounds, [&]()
+                                               {
+                                                   for (size_t i = 0; i < count; i++)
+                                                   {
+                                                       dst[i] = Reference(src + i * (depth / 8), depth, true);
+                                                   }
+                                                   __asm__ __volatile__("" ::"r"(dst) : "memory");
+                                               });
+            double row = HostTest::BestOf(rounds, [&]()
+                                          {
+                                              convertRGB888RowToRGB565(src, dst, count, depth, true);
+                                              __asm__ __volatile__("" ::"r"(dst) : "memory");
+                                          });
+            char name[32];
+            snprintf(name, sizeof(name), "%ubpp %s", depth, offset ? "unaligned" : "aligned");
+            printf("%-22s %12.1f %12.1f %7.2fx\n", name, perPixel, row, perPixel / row);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    HostSetVerbose(argc > 1 && strcmp(argv[1], "-v") == 0);
+    std::mt19937 random(565);
+    // enough for a full screen of 32 bits pixels, plus room for the offsets
+    std::vector<uint8_t> source(320 * 480 * 4 + 4);
+    for (auto &b : source)
+    {
+        b = random();
+    }
+    CheckEquivalence(source);
+    Benchmark(source);
+    return HostTest::Result("test_color_conversion");
+}
@@ -0,0 +1,136 @@
+// Fuzzes FTAction::SplitParameters against the sscanf based splitter it
+// replaced, then times both on typical action tokens.
+#include "HostTest.h"
+#include "globals.hpp"
+#include "FTAction.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace FreeTouchDeck;
+
+// The former splitter, as it was before parameters were split in place
+static bool LegacySplitParameters(const char *parmString, ParametersList_t &parameters)
+{
+    const char *splitterFormat = "%[^.:,]%*s";
+    const char *separatorFormat = "%[ .:,]";
+    char *token = strdup(parmString);
+    char *separators = strdup(parmString);
+    const char *p = parmString;
+    int res = 0;
+    int resSeparators = 0;
+    do
+    {
+        res = sscanf(p, splitterFormat, token);
+        if (res > 0)
+        {
+            p += strlen(token);
+            resSeparators = sscanf(p, separatorFormat, separators);
+            if (resSeparators > 0)
+            {
+                p += strlen(separators);
+            }
+            else
+            {
+                strcpy(separators, "");
+            }
+            parameters.push_back(token);
+        }
+        else
+        {
+            break;
+        }
+    } while (p && *p);
+    free(token);
+    free(separators);
+    return true;
+}
+
+static std::string Describe(const ParametersList_t &parameters)
+{
+    std::string result = "[";
+    for (auto &p : parameters)
+    {
+        result += "\"" + p + "\" ";
+    }
+    return result + "]";
+}
+
+static void Compare(const std::string &input)
+{
+    ParametersList_t expected;
+    ParametersList_t actual;
+    LegacySplitParameters(input.c_str(), expected);
+    FTAction::SplitParameters(input.c_str(), actual);
+    if (expected != actual)
+    {
+        fprintf(stderr, "\"%s\": expected %s, got %s\n", input.c_str(), Describe(expected).c_str(), Describe(actual).c_str());
+    }
+    CHECK(expected == actual);
+}
+
+static const std::vector<std::string> Samples = {
+    "MENU:home",
+    "KEY:LEFT_CTRL,LEFT_ALT,DELETE",
+    "LETTERS:Hello world",
+    "MEDIAKEY:VOLUMEUP",
+    "DELAY:100",
+    "SETBRIGHTNESS:50",
+    "STANDARD:Some text, with: separators.",
+    "",
+    ":",
+    ",leading",
+    "trailing:",
+    "double::colon",
+    "spaces : around , separators",
+    "tab\tinside:value",
+};
+
+int main(int argc, char **argv)
+{
+    HostSetVerbose(argc > 1 && strcmp(argv[1], "-v") == 0);
+    for (auto &sample : Samples)
+    {
+        Compare(sample);
+    }
+    // the characters the splitters treat differently, and a few others
+    const char alphabet[] = "ab1 .:,\t{}_-";
+    std::mt19937 random(17);
+    for (int i = 0; i < 200000; i++)
+    {
+        std::string input(random() % 24, ' ');
+        for (auto &c : input)
+        {
+            c = alphabet[random() % (sizeof(alphabet) - 1)];
+        }
+        Compare(input);
+    }
+
+    const int rounds = 20;
+    printf("\n%-40s %10s %10s\n", "split 1000 times (us)", "sscanf", "in place");
+    for (auto &sample : Samples)
+    {
+        if (sample.empty())
+        {
+            continue;
+        }
+        double legacy = HostTest::BestOf(rounds, [&sample]()
+                                         {
+                                             for (int n = 0; n < 1000; n++)
+                                             {
+                                                 ParametersList_t parameters;
+                                                 LegacySplitParameters(sample.c_str(), parameters);
+                                             }
+                                         });
+        double current = HostTest::BestOf(rounds, [&sample]()
+                                          {
+                                              for (int n = 0; n < 1000; n++)
+                                              {
+                                                  ParametersList_t parameters;
+                                                  FTAction::SplitParameters(sample.c_str(), parameters);
+                                              }
+                                          });
+        printf("%-40s %10.1f %10.1f\n", sample.c_str(), legacy, current);
+    }
+    return HostTest::Result("test_split_parameters");
+}